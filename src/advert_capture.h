@@ -0,0 +1,104 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "hal.h"
+
+// Binary advert capture format.
+// A capture is a header followed by variable-length records, all
+// little-endian, so field advert streams can be replayed through the same
+// handler the BLE scan feeds (see native/replay.cpp).
+//
+// Header (8 bytes):
+//   char[4] magic          "FXAC"
+//   uint16  version        ADVERT_CAPTURE_VERSION
+//   uint16  headerSize     bytes before the first record
+// Record (ADVERT_RECORD_FIXED_SIZE + payloadLength bytes):
+//   uint64  timestamp      us since capture start
+//   uint8[6] address       packed address, first octet first
+//   int8    rssi
+//   uint8   addressType
+//   uint8   advType
+//   uint8   payloadLength  0..ADVERT_MAX_PAYLOAD
+//   uint8[payloadLength]   raw AD structures
+
+#define ADVERT_CAPTURE_VERSION 1
+#define ADVERT_CAPTURE_HEADER_SIZE 8
+#define ADVERT_RECORD_FIXED_SIZE 18
+#define ADVERT_MAX_PAYLOAD 31
+#define ADVERT_RECORD_MAX_SIZE (ADVERT_RECORD_FIXED_SIZE + ADVERT_MAX_PAYLOAD)
+
+struct CaptureRecord {
+    uint64_t timestamp;
+    HalAdvert advert;        // payload points into the capture buffer
+};
+
+// Write the capture header; returns ADVERT_CAPTURE_HEADER_SIZE
+static inline size_t encodeCaptureHeader(uint8_t* out) {
+    memcpy(out, "FXAC", 4);
+    out[4] = (uint8_t)ADVERT_CAPTURE_VERSION;
+    out[5] = 0;
+    out[6] = ADVERT_CAPTURE_HEADER_SIZE;
+    out[7] = 0;
+    return ADVERT_CAPTURE_HEADER_SIZE;
+}
+
+// Write one record (out needs ADVERT_RECORD_MAX_SIZE bytes); returns its size
+static inline size_t encodeCaptureRecord(uint64_t timestamp, const HalAdvert& advert, uint8_t* out) {
+    uint8_t length = advert.payloadLength > ADVERT_MAX_PAYLOAD ? ADVERT_MAX_PAYLOAD : advert.payloadLength;
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(timestamp >> (8 * i));
+    for (int i = 0; i < 6; i++) out[8 + i] = (uint8_t)(advert.address >> (40 - 8 * i));
+    out[14] = (uint8_t)advert.rssi;
+    out[15] = advert.addressType;
+    out[16] = advert.advType;
+    out[17] = length;
+    if (length) memcpy(out + ADVERT_RECORD_FIXED_SIZE, advert.payload, length);
+    return ADVERT_RECORD_FIXED_SIZE + length;
+}
+
+// Sequential reader over a capture held in memory
+class CaptureReader {
+public:
+    CaptureReader(const uint8_t* data, size_t length) : data(data), length(length) {
+        if (length >= ADVERT_CAPTURE_HEADER_SIZE && memcmp(data, "FXAC", 4) == 0 &&
+            (data[4] | (data[5] << 8)) == ADVERT_CAPTURE_VERSION) {
+            size_t headerSize = data[6] | (data[7] << 8);
+            if (headerSize >= ADVERT_CAPTURE_HEADER_SIZE && headerSize <= length) {
+                offset = headerSize;
+                ok = true;
+            }
+        }
+    }
+
+    bool valid() const { return ok; }
+
+    // Decode the next record; false at the end or on a truncated record
+    bool next(CaptureRecord& record) {
+        if (!ok || length - offset < ADVERT_RECORD_FIXED_SIZE) return false;
+        const uint8_t* p = data + offset;
+        uint8_t payloadLength = p[17];
+        if (payloadLength > ADVERT_MAX_PAYLOAD ||
+            length - offset < (size_t)ADVERT_RECORD_FIXED_SIZE + payloadLength) {
+            return false;
+        }
+
+        record.timestamp = 0;
+        for (int i = 7; i >= 0; i--) record.timestamp = (record.timestamp << 8) | p[i];
+        record.advert.address = 0;
+        for (int i = 0; i < 6; i++) record.advert.address = (record.advert.address << 8) | p[8 + i];
+        record.advert.rssi = (int8_t)p[14];
+        record.advert.addressType = p[15];
+        record.advert.advType = p[16];
+        record.advert.payloadLength = payloadLength;
+        record.advert.payload = p + ADVERT_RECORD_FIXED_SIZE;
+        offset += ADVERT_RECORD_FIXED_SIZE + payloadLength;
+        return true;
+    }
+
+private:
+    const uint8_t* data;
+    size_t length;
+    size_t offset = 0;
+    bool ok = false;
+};
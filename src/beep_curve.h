@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// RSSI -> beep interval curve.
+// The curve is a list of (RSSI, interval) breakpoints with linear
+// interpolation between them, expanded into a dense table indexed by RSSI
+// (-127..0 dBm) so a lookup is a single array read. The default curve is
+// expanded at compile time; a custom curve from NVS is expanded at runtime
+// with the same builder.
+
+#define BEEP_CURVE_MIN_RSSI -127
+#define BEEP_CURVE_MAX_RSSI 0
+#define BEEP_CURVE_SIZE (BEEP_CURVE_MAX_RSSI - BEEP_CURVE_MIN_RSSI + 1)
+#define BEEP_CURVE_MAX_POINTS 16
+
+struct CurvePoint {
+    int16_t rssi;        // dBm, strictly ascending within a curve
+    uint16_t intervalMs; // Beep interval at this RSSI
+};
+
+struct BeepTable {
+    uint16_t intervalMs[BEEP_CURVE_SIZE];
+
+    constexpr uint16_t lookup(int rssi) const {
+        if (rssi < BEEP_CURVE_MIN_RSSI) rssi = BEEP_CURVE_MIN_RSSI;
+        if (rssi > BEEP_CURVE_MAX_RSSI) rssi = BEEP_CURVE_MAX_RSSI;
+        return intervalMs[rssi - BEEP_CURVE_MIN_RSSI];
+    }
+};
+
+// Default foxhunting curve: 3s for very weak signals, 1000ms at -85 dBm down
+// to 10ms at -25 dBm (solid tone takes over above that)
+constexpr CurvePoint DEFAULT_BEEP_CURVE[] = {
+    { -86, 3000 }, // 3000ms max for very weak signals
+    { -85, 1000 }, // 1000ms to 500ms - VERY SLOW
+    { -75, 500 },  // 500ms to 200ms - SLOW
+    { -65, 200 },  // 200ms to 100ms - MEDIUM
+    { -55, 100 },  // 100ms to 50ms - FAST
+    { -45, 50 },   // 50ms to 25ms - VERY FAST
+    { -35, 25 },   // 25ms to 10ms - INSANE SPEED
+    { -25, 10 },
+};
+
+// Interval at one RSSI; flat beyond the first and last breakpoints.
+// Interpolation uses the same integer arithmetic as Arduino map().
+constexpr uint16_t curveInterval(const CurvePoint* points, size_t count, int rssi) {
+    if (rssi <= points[0].rssi) return points[0].intervalMs;
+    for (size_t i = 1; i < count; i++) {
+        if (rssi <= points[i].rssi) {
+            long run = points[i].rssi - points[i - 1].rssi;
+            long rise = (long)points[i].intervalMs - (long)points[i - 1].intervalMs;
+            return (uint16_t)((rssi - points[i - 1].rssi) * rise / run + points[i - 1].intervalMs);
+        }
+    }
+    return points[count - 1].intervalMs;
+}
+
+constexpr BeepTable buildBeepTable(const CurvePoint* points, size_t count) {
+    BeepTable table = {};
+    for (int rssi = BEEP_CURVE_MIN_RSSI; rssi <= BEEP_CURVE_MAX_RSSI; rssi++) {
+        table.intervalMs[rssi - BEEP_CURVE_MIN_RSSI] = curveInterval(points, count, rssi);
+    }
+    return table;
+}
+
+constexpr BeepTable DEFAULT_BEEP_TABLE =
+    buildBeepTable(DEFAULT_BEEP_CURVE, sizeof(DEFAULT_BEEP_CURVE) / sizeof(DEFAULT_BEEP_CURVE[0]));
+
+// The original branch-and-map() implementation, kept to check the table against
+constexpr long legacyMap(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+constexpr long legacyBeepInterval(int rssi) {
+    return rssi >= -35 ? legacyMap(rssi, -35, -25, 25, 10) :
+           rssi >= -45 ? legacyMap(rssi, -45, -35, 50, 25) :
+           rssi >= -55 ? legacyMap(rssi, -55, -45, 100, 50) :
+           rssi >= -65 ? legacyMap(rssi, -65, -55, 200, 100) :
+           rssi >= -75 ? legacyMap(rssi, -75, -65, 500, 200) :
+           rssi >= -85 ? legacyMap(rssi, -85, -75, 1000, 500) : 3000;
+}
+
+// Above -25 dBm the legacy map() extrapolated to meaningless (even negative)
+// intervals, but that range always plays a solid tone, so only -127..-25 is compared
+constexpr bool defaultTableMatchesLegacy() {
+    for (int rssi = BEEP_CURVE_MIN_RSSI; rssi <= -25; rssi++) {
+        if (DEFAULT_BEEP_TABLE.lookup(rssi) != legacyBeepInterval(rssi)) return false;
+    }
+    return true;
+}
+
+static_assert(defaultTableMatchesLegacy(), "Default beep table must match the legacy piecewise mapping");
+
+// Parse "rssi:ms,rssi:ms,..." into points. Requires 2..BEEP_CURVE_MAX_POINTS
+// points with strictly ascending RSSI in -127..0 and intervals of 1..60000 ms.
+// Returns the number of points, 0 if the text is invalid.
+static inline size_t parseBeepCurve(const char* text, CurvePoint* points) {
+    size_t count = 0;
+    const char* p = text;
+    while (*p) {
+        while (*p == ' ' || *p == ',' || *p == '\r' || *p == '\n') p++;
+        if (!*p) break;
+        if (count >= BEEP_CURVE_MAX_POINTS) return 0;
+
+        bool negative = false;
+        if (*p == '-') {
+            negative = true;
+            p++;
+        }
+        if (*p < '0' || *p > '9') return 0;
+        long rssi = 0;
+        while (*p >= '0' && *p <= '9' && rssi <= 1000) rssi = rssi * 10 + (*p++ - '0');
+        if (negative) rssi = -rssi;
+
+        if (*p++ != ':') return 0;
+        if (*p < '0' || *p > '9') return 0;
+        long interval = 0;
+        while (*p >= '0' && *p <= '9' && interval <= 60000) interval = interval * 10 + (*p++ - '0');
+
+        if (rssi < BEEP_CURVE_MIN_RSSI || rssi > BEEP_CURVE_MAX_RSSI) return 0;
+        if (interval < 1 || interval > 60000) return 0;
+        if (count > 0 && rssi <= points[count - 1].rssi) return 0;
+        points[count].rssi = (int16_t)rssi;
+        points[count].intervalMs = (uint16_t)interval;
+        count++;
+    }
+    return count >= 2 ? count : 0;
+}
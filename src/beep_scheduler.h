@@ -0,0 +1,112 @@
+#pragma once
+
+#include <stdint.h>
+
+// Proximity beep timing core.
+// Decides the on/off edges of the proximity beep for a given interval. It
+// holds no timer itself: the caller arms a one-shot timer for nextEdge() and
+// calls edge() when it fires, and calls retarget() whenever a new interval is
+// computed. Times are in microseconds on any monotonic clock, which lets the
+// same code run against esp_timer on the device or a simulated clock.
+// Not thread-safe; the caller serializes retarget() and edge().
+
+#define BEEP_SILENT 0u              // No beeping
+#define BEEP_SOLID 0xFFFFFFFFu      // Continuous tone
+#define BEEP_ON_TIME_US 50000u      // Beep length at slow cadences
+#define BEEP_JITTER_BUCKETS 8
+
+// Upper bounds (us) of the jitter histogram buckets; the last bucket is open-ended
+static const uint32_t BEEP_JITTER_LIMITS[BEEP_JITTER_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2000, 5000
+};
+
+class BeepScheduler {
+public:
+    // Set a new start-to-start interval. A shorter interval takes effect at once
+    // instead of waiting out the remainder of a long silent gap.
+    void retarget(uint32_t intervalUs, uint64_t now) {
+        if (intervalUs == interval) return;
+        interval = intervalUs;
+
+        if (interval == BEEP_SILENT) {
+            on = false;
+            next = 0;
+            return;
+        }
+        if (interval == BEEP_SOLID) {
+            on = true;
+            next = 0;
+            return;
+        }
+        if (next == 0) {
+            // Starting from silence or solid tone
+            startBeep(now);
+            return;
+        }
+        if (!on) {
+            uint64_t due = lastStart + interval;
+            if (due <= now) {
+                startBeep(now);
+            } else {
+                next = due;
+            }
+        }
+    }
+
+    // Advance past the edge the timer was armed for
+    void edge(uint64_t now) {
+        if (next == 0) return;
+        recordJitter(now >= next ? now - next : 0);
+
+        if (on) {
+            on = false;
+            next = lastStart + interval;
+            if (next <= now) {
+                // Interval shrank mid-beep - still leave a full off gap
+                next = now + (interval - onTime());
+            }
+        } else {
+            // Start from the scheduled time so timer latency does not accumulate
+            on = true;
+            lastStart = next;
+            next = lastStart + onTime();
+        }
+    }
+
+    bool outputOn() const { return on; }
+    uint64_t nextEdge() const { return next; }   // 0 when no timer is needed
+    uint32_t currentInterval() const { return interval; }
+    uint32_t jitterCount(int bucket) const { return histogram[bucket]; }
+    uint32_t maxJitter() const { return worstJitter; }
+
+    void resetJitter() {
+        for (int i = 0; i < BEEP_JITTER_BUCKETS; i++) histogram[i] = 0;
+        worstJitter = 0;
+    }
+
+private:
+    // Short intervals get a 50% duty beep so every interval stays audible
+    uint32_t onTime() const {
+        return interval / 2 < BEEP_ON_TIME_US ? interval / 2 : BEEP_ON_TIME_US;
+    }
+
+    void startBeep(uint64_t now) {
+        on = true;
+        lastStart = now;
+        next = now + onTime();
+    }
+
+    void recordJitter(uint64_t jitter) {
+        int bucket = 0;
+        while (bucket < BEEP_JITTER_BUCKETS - 1 && jitter >= BEEP_JITTER_LIMITS[bucket]) bucket++;
+        histogram[bucket]++;
+        if (jitter > worstJitter) worstJitter = (uint32_t)jitter;
+    }
+
+    uint32_t interval = BEEP_SILENT;
+    bool on = false;
+    uint64_t lastStart = 0;
+    uint64_t next = 0;
+    uint32_t histogram[BEEP_JITTER_BUCKETS] = {};
+    uint32_t worstJitter = 0;
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+// Debounced push button with short/long press detection.
+// Fed the raw pin level on every poll; reports a press once, on release for a
+// short press or as soon as the hold time is reached for a long press.
+
+#define BUTTON_DEBOUNCE_MS 30         // Level must hold this long to count
+#define BUTTON_LONG_PRESS_MS 1500     // Held at least this long: long press
+
+enum ButtonEvent {
+    BUTTON_NONE,
+    BUTTON_SHORT_PRESS,
+    BUTTON_LONG_PRESS
+};
+
+class ButtonTracker {
+public:
+    ButtonEvent poll(bool down, uint32_t now) {
+        if (down != rawLevel) {
+            rawLevel = down;
+            rawSince = now;
+        }
+        if (now - rawSince < BUTTON_DEBOUNCE_MS) return BUTTON_NONE;
+
+        if (rawLevel && !pressed) {
+            pressed = true;
+            longReported = false;
+            pressedSince = rawSince;
+        } else if (!rawLevel && pressed) {
+            pressed = false;
+            if (!longReported) return BUTTON_SHORT_PRESS;
+        } else if (pressed && !longReported && now - pressedSince >= BUTTON_LONG_PRESS_MS) {
+            longReported = true;
+            return BUTTON_LONG_PRESS;
+        }
+        return BUTTON_NONE;
+    }
+
+    bool held() const { return pressed; }
+
+private:
+    bool rawLevel = false;
+    uint32_t rawSince = 0;
+    bool pressed = false;
+    bool longReported = false;
+    uint32_t pressedSince = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Compact detection record passed from the NimBLE host task to the detection task
+struct DetectionRecord {
+    uint64_t address;    // Packed 48-bit advertiser address
+    uint32_t timestamp;  // millis() when the advert was received
+    uint32_t receivedUs; // Low 32 bits of micros() at reception, for latency tracking
+    uint16_t target;     // Index into the target table
+    int8_t rssi;         // RSSI in dBm
+    uint8_t channel;     // Advertising channel, DETECTION_CHANNEL_UNKNOWN if not reported
+};
+
+#define DETECTION_CHANNEL_UNKNOWN 0xFF
+
+// Lock-free single-producer/single-consumer ring buffer.
+// push() must only be called from one task and pop() from one other task.
+// Capacity must be a power of two; one slot is never left unused because
+// head and tail are free-running counters.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false and counts an overflow when full.
+    bool push(const T& item) {
+        uint32_t head = headIndex.load(std::memory_order_relaxed);
+        uint32_t tail = tailIndex.load(std::memory_order_acquire);
+        uint32_t used = head - tail;
+        if (used >= Capacity) {
+            overflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[head & (Capacity - 1)] = item;
+        headIndex.store(head + 1, std::memory_order_release);
+
+        if (used + 1 > highWaterMark.load(std::memory_order_relaxed)) {
+            highWaterMark.store(used + 1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool pop(T& item) {
+        uint32_t tail = tailIndex.load(std::memory_order_relaxed);
+        uint32_t head = headIndex.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        item = buffer[tail & (Capacity - 1)];
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return headIndex.load(std::memory_order_acquire) - tailIndex.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return Capacity; }
+    uint32_t overflows() const { return overflowCount.load(std::memory_order_relaxed); }
+    uint32_t highWater() const { return highWaterMark.load(std::memory_order_relaxed); }
+
+private:
+    T buffer[Capacity];
+    std::atomic<uint32_t> headIndex{0};
+    std::atomic<uint32_t> tailIndex{0};
+    std::atomic<uint32_t> overflowCount{0};
+    std::atomic<uint32_t> highWaterMark{0};
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// Hardware abstraction for the tracking core.
+// hal_esp32.cpp implements it on the device with Arduino/ledc/NimBLE/NVS;
+// native/hal_native.cpp implements it on the host with a simulated clock so
+// the detection, filtering and beep scheduling code runs unchanged on Linux.
+
+void halInit();
+
+// Clock
+uint32_t halMillis();
+uint64_t halMicros();
+void halDelay(uint32_t ms);
+
+// CPU cycle counter for instrumentation (wraps)
+uint32_t halCycles();
+uint32_t halCyclesPerUs();
+uint8_t halCoreId();
+
+// Buzzer PWM: frequency 0 keeps the current frequency, duty 0 is silent
+void halBuzzer(uint32_t frequency, uint32_t duty);
+
+// Status LED
+void halLed(bool on);
+
+// BOOT button, true while pressed (raw level, not debounced)
+bool halButtonDown();
+
+// One-shot timer for proximity beep edges; calls trackerBeepEdge() when it fires
+void halBeepTimerArm(uint64_t delayUs);
+void halBeepTimerStop();
+
+// Lock shared by loop() and the beep timer callback
+void halBeepLock();
+void halBeepUnlock();
+
+// AES-128 encryption of one block (hardware accelerated on the ESP32-S3)
+void halAes128(const uint8_t key[16], const uint8_t input[16], uint8_t output[16]);
+
+// Large allocations (target tables); placed in PSRAM when available
+void* halAllocLarge(size_t bytes);
+
+// Persistent key/value settings
+std::string halNvsGetString(const char* key, const char* defaultValue);
+void halNvsPutString(const char* key, const std::string& value);
+bool halNvsGetBool(const char* key, bool defaultValue);
+void halNvsPutBool(const char* key, bool value);
+uint8_t halNvsGetU8(const char* key, uint8_t defaultValue);
+void halNvsPutU8(const char* key, uint8_t value);
+void halNvsClear();
+
+// BLE advert source
+#define HAL_ADDR_PUBLIC 0            // Same values as NimBLE's BLE_ADDR_*
+#define HAL_ADDR_RANDOM 1
+
+struct HalAdvert {
+    uint64_t address;        // Packed 48-bit address (see target_match.h)
+    int8_t rssi;             // dBm
+    uint8_t addressType;     // HAL_ADDR_PUBLIC / HAL_ADDR_RANDOM
+    uint8_t advType;         // Advertising PDU type
+    uint8_t payloadLength;
+    const uint8_t* payload;  // Raw AD structures, valid only during the handler
+};
+
+struct HalScanParams {
+    uint16_t intervalMs;
+    uint16_t windowMs;
+    bool active;             // Send scan requests
+};
+
+// Called from the BLE host task for every advert
+typedef void (*HalAdvertHandler)(const HalAdvert& advert);
+
+void halScanStart(const HalScanParams& params, HalAdvertHandler handler);
+void halScanStop();
+
+// Controller filter accept list: with addresses set, the controller drops
+// every other advert before it reaches the host (and sends scan requests only
+// to listed devices). Takes effect at the next halScanStart(); count 0 turns
+// the filter off. Returns false, leaving the filter off, if the controller
+// cannot hold the whole list.
+bool halScanSetAcceptList(const uint64_t* addresses, size_t count);
+
+// Raw log output (Serial on the device). May block until the bytes are
+// queued, so only the log drain calls it; everything else uses log.h.
+void halLogWrite(const uint8_t* data, size_t length);
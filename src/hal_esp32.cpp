@@ -0,0 +1,259 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <NimBLEDevice.h>
+#include <NimBLEScan.h>
+#include <NimBLEAdvertisedDevice.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <mbedtls/aes.h>
+#include <freertos/semphr.h>
+#include "hal.h"
+#include "tracker.h"
+#include "target_match.h"
+#include "metrics.h"
+
+// ESP32-S3 (Xiao) implementation of hal.h
+
+// Hardware configuration
+#define BUZZER_PIN 3
+#define LED_PIN 21
+#define BUTTON_PIN 0                  // BOOT button, active low
+#define BUZZER_CHANNEL 0
+#define TARGET_PSRAM_THRESHOLD 4096   // Move large allocations to PSRAM above this size
+#define NVS_NAMESPACE "tracker"
+
+esp_timer_handle_t beepTimer = nullptr;
+SemaphoreHandle_t beepMutex = nullptr;  // Serializes retargets from loop() with timer edges
+Preferences preferences;
+NimBLEScan* pBLEScan = nullptr;
+HalAdvertHandler advertHandler = nullptr;
+bool acceptListActive = false;
+
+void beepTimerCallback(void* arg) {
+    trackerBeepEdge();
+}
+
+void halInit() {
+    // Setup buzzer - initialize to 1kHz for proximity beeps
+    ledcSetup(BUZZER_CHANNEL, 1000, 8);  // 1kHz default frequency
+    ledcAttachPin(BUZZER_PIN, BUZZER_CHANNEL);
+
+    // Setup LED (inverted logic - HIGH = OFF for Xiao ESP32-S3)
+    pinMode(LED_PIN, OUTPUT);
+    digitalWrite(LED_PIN, HIGH);
+
+    pinMode(BUTTON_PIN, INPUT_PULLUP);
+
+    beepMutex = xSemaphoreCreateMutex();
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = beepTimerCallback;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "beep";
+    esp_timer_create(&timerArgs, &beepTimer);
+}
+
+uint32_t halMillis() {
+    return millis();
+}
+
+uint64_t halMicros() {
+    return esp_timer_get_time();
+}
+
+void halDelay(uint32_t ms) {
+    METRIC_ADD(metricDelayUs, ms * 1000);
+    delay(ms);
+}
+
+uint32_t halCycles() {
+    return ESP.getCycleCount();
+}
+
+uint32_t halCyclesPerUs() {
+    return getCpuFrequencyMhz();
+}
+
+uint8_t halCoreId() {
+    return (uint8_t)xPortGetCoreID();
+}
+
+void halBuzzer(uint32_t frequency, uint32_t duty) {
+    if (frequency) {
+        ledcWriteTone(BUZZER_CHANNEL, frequency);
+    }
+    ledcWrite(BUZZER_CHANNEL, duty);
+}
+
+void halLed(bool on) {
+    digitalWrite(LED_PIN, on ? LOW : HIGH); // LOW = LED ON for Xiao ESP32-S3
+}
+
+bool halButtonDown() {
+    return digitalRead(BUTTON_PIN) == LOW;
+}
+
+void halBeepTimerArm(uint64_t delayUs) {
+    esp_timer_start_once(beepTimer, delayUs);
+}
+
+void halBeepTimerStop() {
+    esp_timer_stop(beepTimer);
+}
+
+void halBeepLock() {
+    xSemaphoreTake(beepMutex, portMAX_DELAY);
+}
+
+void halBeepUnlock() {
+    xSemaphoreGive(beepMutex);
+}
+
+// mbedtls runs on the AES peripheral in arduino-esp32 (MBEDTLS_HARDWARE_AES)
+void halAes128(const uint8_t key[16], const uint8_t input[16], uint8_t output[16]) {
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+    mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, input, output);
+    mbedtls_aes_free(&aes);
+}
+
+void* halAllocLarge(size_t bytes) {
+    void* storage = nullptr;
+    if (psramFound() && bytes > TARGET_PSRAM_THRESHOLD) {
+        storage = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    }
+    if (!storage) {
+        storage = malloc(bytes);
+    }
+    return storage;
+}
+
+std::string halNvsGetString(const char* key, const char* defaultValue) {
+    preferences.begin(NVS_NAMESPACE, true);
+    String value = preferences.getString(key, defaultValue);
+    preferences.end();
+    return std::string(value.c_str(), value.length());
+}
+
+void halNvsPutString(const char* key, const std::string& value) {
+    preferences.begin(NVS_NAMESPACE, false);
+    preferences.putString(key, value.c_str());
+    preferences.end();
+}
+
+bool halNvsGetBool(const char* key, bool defaultValue) {
+    preferences.begin(NVS_NAMESPACE, true);
+    bool value = preferences.getBool(key, defaultValue);
+    preferences.end();
+    return value;
+}
+
+void halNvsPutBool(const char* key, bool value) {
+    preferences.begin(NVS_NAMESPACE, false);
+    preferences.putBool(key, value);
+    preferences.end();
+}
+
+uint8_t halNvsGetU8(const char* key, uint8_t defaultValue) {
+    preferences.begin(NVS_NAMESPACE, true);
+    uint8_t value = preferences.getUChar(key, defaultValue);
+    preferences.end();
+    return value;
+}
+
+void halNvsPutU8(const char* key, uint8_t value) {
+    preferences.begin(NVS_NAMESPACE, false);
+    preferences.putUChar(key, value);
+    preferences.end();
+}
+
+void halNvsClear() {
+    preferences.begin(NVS_NAMESPACE, false);
+    preferences.clear();
+    preferences.end();
+}
+
+// BLE callback for device detection
+class MyAdvertisedDeviceCallbacks: public NimBLEAdvertisedDeviceCallbacks {
+    void onResult(NimBLEAdvertisedDevice* advertisedDevice) {
+        if (!advertHandler) return;
+
+        NimBLEAddress address = advertisedDevice->getAddress();
+        HalAdvert advert;
+        advert.address = addressKey(address.getNative());
+        advert.rssi = (int8_t)advertisedDevice->getRSSI();
+        advert.addressType = address.getType();
+        advert.advType = advertisedDevice->getAdvType();
+        advert.payloadLength = (uint8_t)advertisedDevice->getPayloadLength();
+        advert.payload = advertisedDevice->getPayload();
+        advertHandler(advert);
+    }
+};
+
+void initScan() {
+    if (pBLEScan) return;
+
+    // Initialize BLE
+    NimBLEDevice::init("");
+    NimBLEDevice::setPower(ESP_PWR_LVL_P9);
+
+    pBLEScan = NimBLEDevice::getScan();
+    pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks());
+    pBLEScan->setDuplicateFilter(false);
+    // The handler copies what it needs; don't keep a result object per device
+    pBLEScan->setMaxResults(0);
+}
+
+void clearAcceptList() {
+    while (NimBLEDevice::getWhiteListCount() > 0) {
+        NimBLEDevice::whiteListRemove(NimBLEDevice::getWhiteListAddress(0));
+    }
+    acceptListActive = false;
+}
+
+bool halScanSetAcceptList(const uint64_t* addresses, size_t count) {
+    initScan();
+    // The list cannot change while the controller is scanning
+    if (pBLEScan->isScanning()) {
+        pBLEScan->stop();
+    }
+    clearAcceptList();
+
+    // Targets are given without an address type, so list both
+    for (size_t i = 0; i < count; i++) {
+        if (!NimBLEDevice::whiteListAdd(NimBLEAddress(addresses[i], BLE_ADDR_PUBLIC)) ||
+            !NimBLEDevice::whiteListAdd(NimBLEAddress(addresses[i], BLE_ADDR_RANDOM))) {
+            clearAcceptList();
+            return false;
+        }
+    }
+    acceptListActive = count > 0;
+    return true;
+}
+
+void halScanStart(const HalScanParams& params, HalAdvertHandler handler) {
+    advertHandler = handler;
+
+    initScan();
+    if (pBLEScan->isScanning()) {
+        pBLEScan->stop();
+    }
+    pBLEScan->setInterval(params.intervalMs);
+    pBLEScan->setWindow(params.windowMs);
+    pBLEScan->setActiveScan(params.active);
+    pBLEScan->setFilterPolicy(acceptListActive ? BLE_HCI_SCAN_FILT_USE_WL : BLE_HCI_SCAN_FILT_NO_WL);
+
+    // Start continuous scanning
+    pBLEScan->start(0, nullptr, false);
+}
+
+void halScanStop() {
+    if (pBLEScan && pBLEScan->isScanning()) {
+        pBLEScan->stop();
+    }
+    advertHandler = nullptr;
+}
+
+void halLogWrite(const uint8_t* data, size_t length) {
+    Serial.write(data, length);
+}
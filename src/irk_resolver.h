@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include "hal.h"
+
+// Resolvable private address (RPA) matching by identity resolving key.
+// An RPA carries a 24-bit random part (prand) and a 24-bit hash; it belongs to
+// an IRK when ah(irk, prand) == hash, with ah() one AES-128 block (Core spec
+// Vol 3 Part H 2.2.2). Without a match every IRK has to be tried, so results,
+// misses included, are kept in a two-way address cache: a device keeps
+// one RPA for ~15 minutes and advertises many times a second with it.
+// resolve() is only called from the BLE host task.
+
+#define IRK_MAX 64                    // IRK targets
+#define RPA_CACHE_SIZE 1024           // Resolved addresses remembered (8 bytes each), power of two
+#define RPA_NO_TARGET 0xFFFF
+#define RPA_ADDRESS_MASK 0xFFFFFFFFFFFFULL
+
+// ah(): the 24-bit hash an IRK gives for a prand
+static inline uint32_t rpaHash(const uint8_t irk[16], uint32_t prand) {
+    uint8_t block[16] = {};
+    block[13] = (uint8_t)(prand >> 16);
+    block[14] = (uint8_t)(prand >> 8);
+    block[15] = (uint8_t)prand;
+    uint8_t out[16];
+    halAes128(irk, block, out);
+    return ((uint32_t)out[13] << 16) | ((uint32_t)out[14] << 8) | out[15];
+}
+
+class IrkResolver {
+public:
+    void clear() {
+        keyCount = 0;
+        invalidate();
+    }
+
+    // Register an IRK for the target table entry at index target
+    bool add(const uint8_t irk[16], uint16_t target) {
+        if (keyCount >= IRK_MAX) return false;
+        memcpy(keys[keyCount].irk, irk, 16);
+        keys[keyCount].target = target;
+        keyCount++;
+        invalidate();
+        return true;
+    }
+
+    // Target index for a resolvable private address, RPA_NO_TARGET if no IRK matches
+    uint16_t resolve(uint64_t address) {
+        uint64_t* set = nullptr;
+        if (cacheEnabled) {
+            set = &cache[((size_t)((address * 0x9E3779B97F4A7C15ULL) >> 32) & (RPA_CACHE_SIZE / 2 - 1)) * 2];
+            for (int way = 0; way < 2; way++) {
+                if ((set[way] & RPA_ADDRESS_MASK) == address) {
+                    hits.fetch_add(1, std::memory_order_relaxed);
+                    return (uint16_t)(set[way] >> 48);
+                }
+            }
+        }
+
+        uint32_t prand = (uint32_t)(address >> 24) & 0xFFFFFF;
+        uint32_t hash = (uint32_t)address & 0xFFFFFF;
+        uint16_t target = RPA_NO_TARGET;
+        for (size_t i = 0; i < keyCount; i++) {
+            aesRuns.fetch_add(1, std::memory_order_relaxed);
+            if (rpaHash(keys[i].irk, prand) == hash) {
+                target = keys[i].target;
+                break;
+            }
+        }
+        if (set) {
+            // Most recently resolved first; the older entry is evicted
+            set[1] = set[0];
+            set[0] = address | (uint64_t)target << 48;
+        }
+        return target;
+    }
+
+    // Benchmarking: resolve every advert from scratch
+    void setCacheEnabled(bool enabled) {
+        cacheEnabled = enabled;
+        invalidate();
+    }
+
+    size_t count() const { return keyCount; }
+    uint32_t aesCount() const { return aesRuns.load(std::memory_order_relaxed); }
+    uint32_t cacheHits() const { return hits.load(std::memory_order_relaxed); }
+
+private:
+    struct Key {
+        uint8_t irk[16];
+        uint16_t target;
+    };
+
+    void invalidate() {
+        for (size_t i = 0; i < RPA_CACHE_SIZE; i++) cache[i] = 0;
+    }
+
+    Key keys[IRK_MAX];
+    size_t keyCount = 0;
+    uint64_t cache[RPA_CACHE_SIZE] = {};   // Address | target << 48; 0 = empty, never a valid RPA
+    bool cacheEnabled = true;
+    std::atomic<uint32_t> aesRuns{0};
+    std::atomic<uint32_t> hits{0};
+};
@@ -0,0 +1,150 @@
+#include "log.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "hal.h"
+
+uint8_t logLevel = LOG_LEVEL_INFO;
+uint8_t logFormat = LOG_FORMAT_TEXT;
+bool logDeferred = false;
+
+LogRing<LOG_RING_SIZE> logRing;
+
+// One-second window for the INFO/DEBUG rate limit. Resets race benignly
+// between tasks; at worst a few extra lines get through.
+std::atomic<uint32_t> logWindowStart{0};
+std::atomic<uint32_t> logWindowLines{0};
+std::atomic<uint32_t> logRateDropped{0};
+
+uint16_t logSequence = 0;             // Drain only
+uint32_t reportedLogDrops = 0;        // Drain only
+
+static const char* const LOG_LEVEL_NAMES[LOG_LEVEL_COUNT] = { "Error", "Warning", "Info", "Debug" };
+static const char* const LOG_LEVEL_PREFIXES[LOG_LEVEL_COUNT] = { "ERROR: ", "WARNING: ", "", "DEBUG: " };
+static const char* const LOG_FORMAT_NAMES[LOG_FORMAT_COUNT] = { "Text", "Binary" };
+
+const char* logLevelName(uint8_t level) {
+    return level < LOG_LEVEL_COUNT ? LOG_LEVEL_NAMES[level] : "Unknown";
+}
+
+const char* logFormatName(uint8_t format) {
+    return format < LOG_FORMAT_COUNT ? LOG_FORMAT_NAMES[format] : "Unknown";
+}
+
+uint32_t logDropped() {
+    return logRing.overflows() + logRateDropped.load(std::memory_order_relaxed);
+}
+
+bool logRateAllowed(uint32_t now) {
+    uint32_t start = logWindowStart.load(std::memory_order_relaxed);
+    if (now - start >= 1000) {
+        logWindowStart.store(now, std::memory_order_relaxed);
+        logWindowLines.store(0, std::memory_order_relaxed);
+    }
+    if (logWindowLines.fetch_add(1, std::memory_order_relaxed) < LOG_RATE_LIMIT) return true;
+    logRateDropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void logWrite(uint8_t level, const char* format, ...) {
+    if (level > logLevel) return;
+    uint32_t now = halMillis();
+    if (level >= LOG_LEVEL_INFO && !logRateAllowed(now)) return;
+
+    uint32_t ticket;
+    LogEntry* entry = logRing.claim(ticket);
+    if (entry) {
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(entry->text, LOG_TEXT_MAX, format, args);
+        va_end(args);
+        entry->timestamp = now;
+        entry->level = level;
+        entry->length = (uint8_t)(length < 0 ? 0 : length < LOG_TEXT_MAX ? length : LOG_TEXT_MAX - 1);
+        logRing.publish(ticket);
+    }
+
+    if (!logDeferred) logDrain(LOG_RING_SIZE);
+}
+
+bool logWriteLine(uint8_t level, const char* text, size_t length) {
+    uint32_t ticket;
+    LogEntry* entry = logRing.claim(ticket, false);
+    if (!entry) return false;
+    if (length >= LOG_TEXT_MAX) length = LOG_TEXT_MAX - 1;
+    memcpy(entry->text, text, length);
+    entry->timestamp = halMillis();
+    entry->level = level;
+    entry->length = (uint8_t)length;
+    logRing.publish(ticket);
+
+    if (!logDeferred) logDrain(LOG_RING_SIZE);
+    return true;
+}
+
+uint8_t logCrc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (uint8_t)(crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1);
+    }
+    return crc;
+}
+
+size_t logEncode(const LogEntry& entry, uint16_t sequence, uint8_t format, uint8_t* out) {
+    uint8_t level = entry.level < LOG_LEVEL_COUNT ? entry.level : LOG_LEVEL_ERROR;
+    if (format == LOG_FORMAT_BINARY) {
+        out[0] = 0xA5;
+        out[1] = 0x5A;
+        out[2] = (uint8_t)(7 + entry.length);
+        out[3] = level;
+        out[4] = (uint8_t)sequence;
+        out[5] = (uint8_t)(sequence >> 8);
+        for (int i = 0; i < 4; i++) out[6 + i] = (uint8_t)(entry.timestamp >> (8 * i));
+        memcpy(out + 10, entry.text, entry.length);
+        out[10 + entry.length] = logCrc8(out + 2, 8 + entry.length);
+        return 11 + entry.length;
+    }
+
+    size_t prefix = strlen(LOG_LEVEL_PREFIXES[level]);
+    memcpy(out, LOG_LEVEL_PREFIXES[level], prefix);
+    memcpy(out + prefix, entry.text, entry.length);
+    out[prefix + entry.length] = '\n';
+    return prefix + entry.length + 1;
+}
+
+void logEmit(const LogEntry& entry) {
+    uint8_t frame[LOG_FRAME_MAX];
+    size_t length = logEncode(entry, logSequence++, logFormat, frame);
+    halLogWrite(frame, length);
+}
+
+size_t logDrain(size_t maxLines) {
+    size_t written = 0;
+    LogEntry entry;
+    while (written < maxLines && logRing.pop(entry)) {
+        logEmit(entry);
+        written++;
+    }
+
+    // Lines lost since the last report, as a line of their own
+    uint32_t dropped = logDropped();
+    if (dropped != reportedLogDrops) {
+        entry.timestamp = halMillis();
+        entry.level = LOG_LEVEL_WARN;
+        int length = snprintf(entry.text, LOG_TEXT_MAX, "Log: dropped %u lines", (unsigned)(dropped - reportedLogDrops));
+        entry.length = (uint8_t)(length < LOG_TEXT_MAX ? length : LOG_TEXT_MAX - 1);
+        reportedLogDrops = dropped;
+        logEmit(entry);
+        written++;
+    }
+    return written;
+}
+
+void logFlush(uint32_t timeoutMs) {
+    if (!logDeferred) return;
+    uint32_t start = halMillis();
+    while (!logRing.empty() && halMillis() - start < timeoutMs) {
+        halDelay(1);
+    }
+}
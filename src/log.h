@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Leveled logging through a lock-free ring.
+// Any task may log: the line is formatted into a ring slot by the caller and
+// written out later by logDrain() from a low-priority task, so nobody blocks
+// on the UART. Messages below FOXHUNT_LOG_LEVEL compile out; logLevel filters
+// the rest at runtime. INFO and DEBUG lines are also rate limited.
+//
+// Output is either plain text lines ("WARNING: ..." as before) or, with
+// logFormat = LOG_FORMAT_BINARY, one frame per line for machine consumption:
+//   A5 5A  sync
+//   u8     length of the body
+//   body   u8 level, u16 sequence (LE), u32 millis (LE), message text
+//   u8     CRC-8 (poly 0x07) over length and body
+// tools/decode_log.py turns a binary capture back into text.
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_WARN 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_DEBUG 3
+#define LOG_LEVEL_COUNT 4
+
+#ifndef FOXHUNT_LOG_LEVEL
+#define FOXHUNT_LOG_LEVEL LOG_LEVEL_DEBUG   // Highest level compiled in
+#endif
+
+#define LOG_TEXT_MAX 160              // Message bytes kept per line, longer ones are cut
+#define LOG_RING_SIZE 64              // Lines buffered for the drain, power of two
+#define LOG_RATE_LIMIT 50             // INFO/DEBUG lines per second, the rest are dropped
+#define LOG_FRAME_MAX (LOG_TEXT_MAX + 12)
+
+enum LogFormat {
+    LOG_FORMAT_TEXT,
+    LOG_FORMAT_BINARY,
+    LOG_FORMAT_COUNT
+};
+
+struct LogEntry {
+    uint32_t timestamp;      // millis() when logged
+    uint8_t level;
+    uint8_t length;
+    char text[LOG_TEXT_MAX];
+};
+
+// Bounded multi-producer/single-consumer ring (one sequence number per slot).
+// Producers claim a slot, fill it in place and publish it; the consumer stops
+// at the first slot not yet published. A full ring drops the new line.
+template <size_t Capacity>
+class LogRing {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    LogRing() {
+        for (size_t i = 0; i < Capacity; i++) slots[i].sequence.store((uint32_t)i, std::memory_order_relaxed);
+    }
+
+    // Producer: a slot to fill and pass to publish(), nullptr when full
+    // (counted as an overflow unless the caller will retry)
+    LogEntry* claim(uint32_t& ticket, bool countOverflow = true) {
+        uint32_t position = headIndex.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & (Capacity - 1)];
+            int32_t diff = (int32_t)(slot.sequence.load(std::memory_order_acquire) - position);
+            if (diff == 0) {
+                if (headIndex.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    ticket = position;
+                    return &slot.entry;
+                }
+            } else if (diff < 0) {
+                if (countOverflow) overflowCount.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            } else {
+                position = headIndex.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(uint32_t ticket) {
+        slots[ticket & (Capacity - 1)].sequence.store(ticket + 1, std::memory_order_release);
+    }
+
+    // Consumer side. Returns false when empty or the oldest line is still being written.
+    bool pop(LogEntry& entry) {
+        Slot& slot = slots[tailIndex & (Capacity - 1)];
+        if ((int32_t)(slot.sequence.load(std::memory_order_acquire) - (tailIndex + 1)) < 0) return false;
+        entry = slot.entry;
+        slot.sequence.store(tailIndex + Capacity, std::memory_order_release);
+        tailIndex++;
+        return true;
+    }
+
+    bool empty() const {
+        return headIndex.load(std::memory_order_acquire) == tailIndex;
+    }
+
+    uint32_t overflows() const { return overflowCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogEntry entry;
+    };
+
+    Slot slots[Capacity];
+    std::atomic<uint32_t> headIndex{0};
+    uint32_t tailIndex = 0;               // Consumer only
+    std::atomic<uint32_t> overflowCount{0};
+};
+
+// Runtime settings
+extern uint8_t logLevel;     // Lines above this level are dropped (LOG_LEVEL_*)
+extern uint8_t logFormat;    // LogFormat
+extern bool logDeferred;     // Set once a task runs logDrain(); until then logWrite() drains inline
+
+void logWrite(uint8_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+// Queue one preformatted line of a dump the operator asked for (the metrics
+// dump): no level filter or rate limit. Returns false when the ring is full,
+// without counting a drop, so the caller can retry on its next pass.
+bool logWriteLine(uint8_t level, const char* text, size_t length);
+
+// Write out up to maxLines queued lines (single consumer). Returns the number written.
+size_t logDrain(size_t maxLines);
+
+// Wait up to timeoutMs for the drain to empty the ring, e.g. before a restart
+void logFlush(uint32_t timeoutMs);
+
+// Encode one line as text or a binary frame; returns the byte count
+size_t logEncode(const LogEntry& entry, uint16_t sequence, uint8_t format, uint8_t* out);
+
+uint32_t logDropped();       // Lines lost to a full ring or the rate limit
+const char* logLevelName(uint8_t level);
+const char* logFormatName(uint8_t format);
+
+// Compiled-out lines still type-check their arguments but generate no code
+#define LOG_DISCARD(...) do { if (0) logWrite(__VA_ARGS__); } while (0)
+
+#if FOXHUNT_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISCARD(LOG_LEVEL_ERROR, __VA_ARGS__)
+#endif
+#if FOXHUNT_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_DISCARD(LOG_LEVEL_WARN, __VA_ARGS__)
+#endif
+#if FOXHUNT_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISCARD(LOG_LEVEL_INFO, __VA_ARGS__)
+#endif
+#if FOXHUNT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISCARD(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#endif
@@ -1,17 +1,52 @@
 #include <WiFi.h>
 #include <AsyncTCP.h>
 #include <ESPAsyncWebServer.h>
-#include <Preferences.h>
-#include <NimBLEDevice.h>
-#include <NimBLEScan.h>
-#include <NimBLEAdvertisedDevice.h>
 #include <esp_wifi.h>
+#include <LittleFS.h>
+#include "hal.h"
+#include "tracker.h"
+#include "target_match.h"
+#include "telemetry.h"
+#include "metrics.h"
+#include "log.h"
+#include "button.h"
+#include "recorder.h"
+#include "web_assets.h"   // Generated from web/ by tools/embed_web.py
 
-// Hardware configuration
-#define BUZZER_PIN 3
-#define BUZZER_FREQ 2000
-#define BUZZER_DUTY 127
-#define LED_PIN 21
+// Telemetry configuration
+#define TELEMETRY_DEFAULT_RATE 10     // Live telemetry frames per second
+#define TELEMETRY_MAX_RATE 50
+
+// Trend cue threshold limits, 0.1 dB/s
+#define TREND_THRESHOLD_MIN 5
+#define TREND_THRESHOLD_MAX 100
+
+// Survey results sent to the config page, per list
+#define SURVEY_REPORT_DEVICES 20
+#define SURVEY_REPORT_STRONGEST 10
+#define SURVEY_REPORT_VENDORS 10
+
+// Instrumentation
+#define METRICS_TEXT_SIZE 12288       // Buffer for the Prometheus text dump
+#define METRICS_DUMP_LINES 8          // Serial dump lines queued on the log per loop() pass
+
+// Task layout while tracking. Detection shares core 0 with the NimBLE host and
+// the beep timer; loop() (audio/LED patterns, telemetry, Serial) and the web
+// server (CONFIG_ASYNC_TCP_RUNNING_CORE in platformio.ini) run on core 1.
+#define DETECT_TASK_CORE 0
+#define DETECT_TASK_PRIORITY 5        // Above the idle/loop tasks, below the NimBLE host
+#define DETECT_TASK_STACK 6144        // Log lines are formatted on the caller's stack
+#define DETECT_TASK_PERIOD_MS 10      // Timeout/scan scheduling tick when no adverts match
+#define UX_TASK_PRIORITY 2            // loop(), raised from the Arduino default of 1
+#define UX_TASK_PERIOD_MS 2           // loop() sleep between pattern steps while tracking
+#define LOG_TASK_CORE 1
+#define LOG_TASK_PRIORITY 1           // Lowest above idle: Serial output never delays real work
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PERIOD_MS 20         // Drain interval; the ring holds LOG_RING_SIZE lines
+#define RECORDER_TASK_CORE 1
+#define RECORDER_TASK_PRIORITY 1      // Flash writes wait behind everything else
+#define RECORDER_TASK_STACK 4096
+#define RECORDER_TASK_PERIOD_MS 50    // Drain interval; the ring holds SESSION_RING_SIZE events
 
 // Network configuration
 const char* AP_SSID = "snoopuntothem";
@@ -27,717 +62,562 @@ enum OperatingMode {
 // Global variables
 OperatingMode currentMode = CONFIG_MODE;
 AsyncWebServer server(80);
-Preferences preferences;
-NimBLEScan* pBLEScan;
 
-String targetMAC = "";
+String targetMAC = "";           // Raw target list as entered, one MAC/OUI rule per line
 unsigned long configStartTime = 0;
 unsigned long lastConfigActivity = 0;
 unsigned long modeSwitchScheduled = 0;
 unsigned long deviceResetScheduled = 0;
 unsigned long lastBeepTime = 0;
-bool targetDetected = false;
-int currentRSSI = -100;
-unsigned long lastTargetSeen = 0;
-bool firstDetection = true;
-bool sessionFirstDetection = true; // Only beep once per hunting session
+bool portalStarted = false;      // AP and web server up (at most once per boot)
 
-// Persistent settings
-bool buzzerEnabled = true;
-bool ledEnabled = true;
+// Persistent settings (buzzer, LED and RSSI filter settings live in tracker.cpp)
+String beepCurve = "";           // Optional custom RSSI->interval curve, "rssi:ms,..."
+bool liveTelemetry = false;      // Keep the web server up and stream RSSI while tracking
+uint8_t telemetryRate = TELEMETRY_DEFAULT_RATE;
 
-// Simple beep state
-bool isBeeping = false;
-unsigned long lastBeepStart = 0;
-unsigned long beepDuration = 50;  // 50ms beep duration for fast response
+// Live RSSI telemetry over WebSocket
+AsyncWebSocket telemetrySocket("/ws");
+TelemetryBatcher telemetry;
+uint32_t reportedTelemetryDrops = 0;
+uint8_t bearingFrame[TELEMETRY_BEARING_SIZE];
+bool bearingPending = false;     // bearingFrame waits for the link, unlike RSSI frames it is never dropped
 
-// Serial output synchronization - avoid concurrent writes
-volatile bool newTargetDetected = false;
+// BOOT button: a short press while tracking starts or ends a sweep, and
+// restarts the survey in config mode
+ButtonTracker bootButton;
 
+// Survey sketches are filled by loop() and read by the web server task
+SemaphoreHandle_t surveyLock = nullptr;
 
-int calculateBeepInterval(int rssi) {
-    // REAL-TIME foxhunting intervals
-    // RSSI ranges: -95 (very weak) to -30 (very strong)
-    if (rssi >= -35) {
-        return map(rssi, -35, -25, 25, 10); // 25ms to 10ms - INSANE SPEED
-    } else if (rssi >= -45) {
-        return map(rssi, -45, -35, 50, 25); // 50ms to 25ms - VERY FAST
-    } else if (rssi >= -55) {
-        return map(rssi, -55, -45, 100, 50); // 100ms to 50ms - FAST
-    } else if (rssi >= -65) {
-        return map(rssi, -65, -55, 200, 100); // 200ms to 100ms - MEDIUM
-    } else if (rssi >= -75) {
-        return map(rssi, -75, -65, 500, 200); // 500ms to 200ms - SLOW
-    } else if (rssi >= -85) {
-        return map(rssi, -85, -75, 1000, 500); // 1000ms to 500ms - VERY SLOW
-    } else {
-        return 3000; // 3000ms max for very weak signals
-    }
+// Tracking tasks, see DETECT_TASK_CORE
+TaskHandle_t detectTask = nullptr;
+TaskHandle_t uxTask = nullptr;   // loop()
+
+// Parse targetMAC (one address or rule per line) into the tracking core's target table
+void updateTargets() {
+    trackerSetTargets(targetMAC.c_str(), targetMAC.length());
 }
 
-// LED control functions (inverted logic for Xiao ESP32-S3)
-void ledOn() {
-    if (ledEnabled) {
-        digitalWrite(LED_PIN, LOW);  // LOW = LED ON for Xiao ESP32-S3
-    }
+// Install beepCurve in the tracking core; returns true if the custom curve is in use
+bool applyBeepCurve() {
+    return trackerSetBeepCurve(beepCurve.c_str());
 }
 
-void ledOff() {
-    if (ledEnabled) {
-        digitalWrite(LED_PIN, HIGH); // HIGH = LED OFF for Xiao ESP32-S3
-    }
+// Empty (default curve) or a curve parseBeepCurve() accepts
+bool validBeepCurve(const String& curve) {
+    CurvePoint points[BEEP_CURVE_MAX_POINTS];
+    return curve.length() == 0 || parseBeepCurve(curve.c_str(), points) > 0;
 }
 
-// Buzzer functions
-void singleBeep() {
-    if (buzzerEnabled) {
-        ledcWrite(0, BUZZER_DUTY);
-    }
-    ledOn();
-    delay(100);
-    if (buzzerEnabled) {
-        ledcWrite(0, 0);
-    }
-    ledOff();
+const char* INVALID_CURVE_MESSAGE = "Invalid curve, expected rssi:ms,rssi:ms,... (2-16 points, RSSI ascending)";
+
+// Queue a live telemetry sample for every detection applied by the tracking core
+void onDetection(const DetectionRecord& record, int filteredRssi) {
+    if (!liveTelemetry || telemetrySocket.count() == 0) return;
+    
+    TelemetrySample sample;
+    sample.timestamp = record.timestamp;
+    sample.target = record.target;
+    sample.rssi = record.rssi;
+    sample.filtered = (int8_t)filteredRssi;
+    telemetry.add(sample);
 }
 
-void ascendingBeeps() {
-    // Ready signal - 2 fast ascending beeps with close melodic notes
-    if (buzzerEnabled) {
-        ledcWriteTone(0, 1900);
-        ledcWrite(0, BUZZER_DUTY);
-    }
-    ledOn();
-    delay(150);
-    if (buzzerEnabled) {
-        ledcWrite(0, 0);
-    }
-    ledOff();
-    delay(50);
+// Queue a finished sweep's bearing for /live; sent by serviceTelemetry() as a frame of its own
+void onSweep(uint16_t target, const SweepResult& result) {
+    if (!liveTelemetry || telemetrySocket.count() == 0) return;
     
-    if (buzzerEnabled) {
-        ledcWriteTone(0, 2200);
-        ledcWrite(0, BUZZER_DUTY);
+    TelemetryBatcher::packBearing(bearingFrame, target, result.bearing, result.lobeWidth,
+                                  result.contrast, result.samples, result.durationMs);
+    bearingPending = true;
+}
+
+// Detection task: drains the detection ring as soon as the BLE task queues a
+// hit, and at least every DETECT_TASK_PERIOD_MS for target timeouts
+void detectTaskMain(void* arg) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DETECT_TASK_PERIOD_MS));
+        trackerUpdate();
     }
-    ledOn();
-    delay(150);
-    if (buzzerEnabled) {
-        ledcWrite(0, 0);
+}
+
+void wakeDetectTask() {
+    xTaskNotifyGive(detectTask);
+}
+
+void wakeUxTask() {
+    xTaskNotifyGive(uxTask);
+}
+
+void startDetectTask() {
+    if (detectTask) return;
+    uxTask = xTaskGetCurrentTaskHandle();
+    vTaskPrioritySet(nullptr, UX_TASK_PRIORITY);
+    if (xTaskCreatePinnedToCore(detectTaskMain, "detect", DETECT_TASK_STACK, nullptr,
+                                DETECT_TASK_PRIORITY, &detectTask, DETECT_TASK_CORE) != pdPASS) {
+        // Fall back to running detection from loop()
+        detectTask = nullptr;
+        LOG_ERROR("Unable to start detection task");
+        return;
     }
-    ledOff();
-    
-    // Reset to proximity frequency and ENSURE buzzer is OFF
-    if (buzzerEnabled) {
-        ledcWriteTone(0, 1000);  // Set to 1kHz for consistency with proximity beeps
-        ledcWrite(0, 0);  // Make sure buzzer is completely off
+    detectionWake = wakeDetectTask;
+    uxWake = wakeUxTask;
+    LOG_INFO("Tasks: detect core %d prio %d, loop core %d prio %d", DETECT_TASK_CORE,
+             DETECT_TASK_PRIORITY, xPortGetCoreID(), UX_TASK_PRIORITY);
+}
+
+// Log drain: writes queued lines to Serial so no other task waits on the UART
+void logTaskMain(void* arg) {
+    for (;;) {
+        logDrain(LOG_RING_SIZE);
+        vTaskDelay(pdMS_TO_TICKS(LOG_TASK_PERIOD_MS));
     }
-    
-    // Add delay to prevent interference with proximity beeps
-    delay(500);
 }
 
-void handleProximityBeeping() {
-    unsigned long currentTime = millis();
-    int beepInterval = calculateBeepInterval(currentRSSI);
-    
-    // Ultra close - solid beep (continuous)
-    if (currentRSSI >= -25) {
-        if (buzzerEnabled) {
-            ledcWriteTone(0, 1000);
-            ledcWrite(0, BUZZER_DUTY);
-        }
-        ledOn();
-        isBeeping = true;
-        Serial.println("DEBUG: Solid beep mode");
-        return;
+void startLogTask() {
+    if (xTaskCreatePinnedToCore(logTaskMain, "log", LOG_TASK_STACK, nullptr,
+                                LOG_TASK_PRIORITY, nullptr, LOG_TASK_CORE) == pdPASS) {
+        logDeferred = true;
     }
-    
-    // Regular proximity beeping with aggressive timing
-    if (isBeeping) {
-        // Check if beep duration is over (50ms)
-        if (currentTime - lastBeepStart >= beepDuration) {
-            // Turn off beep
-            if (buzzerEnabled) {
-                ledcWrite(0, 0);
-            }
-            ledOff();
-            isBeeping = false;
-            Serial.println("DEBUG: Beep OFF");
-        }
-    } else {
-        // Check if it's time for next beep
-        if (currentTime - lastBeepStart >= beepInterval) {
-            // Start new beep
-            if (buzzerEnabled) {
-                ledcWriteTone(0, 1000);
-                ledcWrite(0, BUZZER_DUTY);
-            }
-            ledOn();
-            isBeeping = true;
-            lastBeepStart = currentTime;
-            Serial.print("DEBUG: Beep ON, RSSI: ");
-            Serial.print(currentRSSI);
-            Serial.print(", interval: ");
-            Serial.println(beepInterval);
-        }
+}
+
+// Session recorder: moves session events from the ring to flash
+void recorderTaskMain(void* arg) {
+    for (;;) {
+        recorderService();
+        vTaskDelay(pdMS_TO_TICKS(RECORDER_TASK_PERIOD_MS));
     }
 }
 
-void threeSameToneBeeps() {
-    // Three beeps at same tone for initial detection - using 1kHz for consistency
-    for (int i = 0; i < 3; i++) {
-        if (buzzerEnabled) {
-            ledcWriteTone(0, 1000); // Same 1kHz tone as proximity beeps
-            ledcWrite(0, BUZZER_DUTY);
-        }
-        ledOn();
-        delay(100);
-        if (buzzerEnabled) {
-            ledcWrite(0, 0);
-        }
-        ledOff();
-        delay(50);
+void startRecorder() {
+    static TaskHandle_t recorderTask = nullptr;
+    if (!recordSessions || !recorderBegin()) return;
+    if (!recorderTask && xTaskCreatePinnedToCore(recorderTaskMain, "recorder", RECORDER_TASK_STACK, nullptr,
+                                                 RECORDER_TASK_PRIORITY, &recorderTask,
+                                                 RECORDER_TASK_CORE) != pdPASS) {
+        recorderTask = nullptr;
+        LOG_ERROR("Unable to start recorder task");
+        return;
     }
-    
-    // Ensure buzzer is OFF (frequency already at 1kHz)
-    if (buzzerEnabled) {
-        ledcWrite(0, 0);
+    recorderStart();
+}
+
+#if FOXHUNT_METRICS
+// Prometheus text for /metrics and the Serial dump
+String metricsText() {
+    char* buffer = (char*)malloc(METRICS_TEXT_SIZE);
+    if (!buffer) return "";
+    size_t length = formatMetrics(buffer, METRICS_TEXT_SIZE);
+    snprintf(buffer + length, METRICS_TEXT_SIZE - length,
+             "# TYPE foxhunt_heap_free_bytes gauge\nfoxhunt_heap_free_bytes %u\n"
+             "# TYPE foxhunt_heap_min_free_bytes gauge\nfoxhunt_heap_min_free_bytes %u\n"
+             "# TYPE foxhunt_telemetry_frames_dropped gauge\nfoxhunt_telemetry_frames_dropped %u\n",
+             (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)telemetry.framesDropped());
+    String text(buffer);
+    free(buffer);
+    return text;
+}
+
+// Serial dump in progress: queued on the log a few lines per pass, so it goes
+// out in order with (and framed like) every other log line
+String metricsDump;
+size_t metricsDumpOffset = 0;
+
+void serviceMetricsDump() {
+    for (int i = 0; i < METRICS_DUMP_LINES && metricsDumpOffset < metricsDump.length(); i++) {
+        int end = metricsDump.indexOf('\n', metricsDumpOffset);
+        if (end < 0) end = metricsDump.length();
+        if (!logWriteLine(LOG_LEVEL_INFO, metricsDump.c_str() + metricsDumpOffset, end - metricsDumpOffset)) return;
+        metricsDumpOffset = end + 1;
     }
-    
-    // Add delay to prevent interference with proximity beeps
-    delay(500);
+    if (metricsDumpOffset >= metricsDump.length()) metricsDump = String();
 }
+#endif
 
 // Configuration storage
 void saveConfiguration() {
-    preferences.begin("tracker", false);
-    preferences.putString("targetMAC", targetMAC);
-    preferences.putBool("buzzerEnabled", buzzerEnabled);
-    preferences.putBool("ledEnabled", ledEnabled);
-    preferences.end();
-    Serial.println("Configuration saved to NVS");
+    halNvsPutString("targetMAC", targetMAC.c_str());
+    halNvsPutBool("buzzerEnabled", buzzerEnabled);
+    halNvsPutBool("ledEnabled", ledEnabled);
+    halNvsPutBool("proximityCue", proximityCue);
+    halNvsPutBool("trendCue", trendCue);
+    halNvsPutU8("trendThreshold", trendThreshold);
+    halNvsPutU8("rssiFilter", rssiFilterType);
+    halNvsPutU8("scanResponses", scanResponseMode);
+    halNvsPutString("beepCurve", beepCurve.c_str());
+    halNvsPutBool("liveTelemetry", liveTelemetry);
+    halNvsPutU8("telemetryRate", telemetryRate);
+    halNvsPutU8("logLevel", logLevel);
+    halNvsPutU8("logFormat", logFormat);
+    halNvsPutBool("recordSessions", recordSessions);
+    LOG_INFO("Configuration saved to NVS");
 }
 
 void loadConfiguration() {
-    preferences.begin("tracker", true);
-    targetMAC = preferences.getString("targetMAC", "");
-    buzzerEnabled = preferences.getBool("buzzerEnabled", true);
-    ledEnabled = preferences.getBool("ledEnabled", true);
-    preferences.end();
+    targetMAC = halNvsGetString("targetMAC", "").c_str();
+    buzzerEnabled = halNvsGetBool("buzzerEnabled", true);
+    ledEnabled = halNvsGetBool("ledEnabled", true);
+    proximityCue = halNvsGetBool("proximityCue", true);
+    trendCue = halNvsGetBool("trendCue", true);
+    trendThreshold = halNvsGetU8("trendThreshold", TREND_DEFAULT_THRESHOLD);
+    if (trendThreshold < TREND_THRESHOLD_MIN || trendThreshold > TREND_THRESHOLD_MAX) {
+        trendThreshold = TREND_DEFAULT_THRESHOLD;
+    }
+    rssiFilterType = halNvsGetU8("rssiFilter", RSSI_FILTER_EMA);
+    if (rssiFilterType >= RSSI_FILTER_COUNT) rssiFilterType = RSSI_FILTER_EMA;
+    scanResponseMode = halNvsGetU8("scanResponses", SCAN_RESPONSE_OFF);
+    if (scanResponseMode >= SCAN_RESPONSE_MODE_COUNT) scanResponseMode = SCAN_RESPONSE_OFF;
+    beepCurve = halNvsGetString("beepCurve", "").c_str();
+    liveTelemetry = halNvsGetBool("liveTelemetry", false);
+    telemetryRate = halNvsGetU8("telemetryRate", TELEMETRY_DEFAULT_RATE);
+    if (telemetryRate < 1 || telemetryRate > TELEMETRY_MAX_RATE) telemetryRate = TELEMETRY_DEFAULT_RATE;
+    logLevel = halNvsGetU8("logLevel", LOG_LEVEL_INFO);
+    if (logLevel >= LOG_LEVEL_COUNT) logLevel = LOG_LEVEL_INFO;
+    logFormat = halNvsGetU8("logFormat", LOG_FORMAT_TEXT);
+    if (logFormat >= LOG_FORMAT_COUNT) logFormat = LOG_FORMAT_TEXT;
+    recordSessions = halNvsGetBool("recordSessions", true);
+    updateTargets();
+    bool customCurve = applyBeepCurve();
     
     if (targetMAC.length() > 0) {
         targetMAC.toUpperCase(); // Ensure consistent case for comparison
-        Serial.println("Configuration loaded from NVS");
-        Serial.println("Target MAC: " + targetMAC);
+        LOG_INFO("Configuration loaded from NVS");
+        LOG_INFO("Targets loaded: %u", (unsigned)targets.count());
+    }
+    LOG_INFO("Buzzer enabled: %s", buzzerEnabled ? "Yes" : "No");
+    LOG_INFO("LED enabled: %s", ledEnabled ? "Yes" : "No");
+    LOG_INFO("Proximity cadence: %s, trend pitch: %s (%.1f dB/s)", proximityCue ? "On" : "Off",
+             trendCue ? "On" : "Off", trendThreshold / 10.0f);
+    if (liveTelemetry) {
+        LOG_INFO("Live telemetry: %u Hz", (unsigned)telemetryRate);
+    } else {
+        LOG_INFO("Live telemetry: Off");
     }
-    Serial.println("Buzzer enabled: " + String(buzzerEnabled ? "Yes" : "No"));
-    Serial.println("LED enabled: " + String(ledEnabled ? "Yes" : "No"));
+    LOG_INFO("RSSI filter: %s", rssiFilterName(rssiFilterType));
+    LOG_INFO("Scan responses: %s", scanResponseName(scanResponseMode));
+    LOG_INFO("Beep curve: %s", customCurve ? beepCurve.c_str() : "Default");
+    LOG_INFO("Log: %s, %s", logLevelName(logLevel), logFormatName(logFormat));
+    LOG_INFO("Session recording: %s", recordSessions ? "On" : "Off");
+}
+
+void startSurvey() {
+    if (!surveyLock) surveyLock = xSemaphoreCreateMutex();
+    xSemaphoreTake(surveyLock, portMAX_DELAY);
+    trackerSurveyStart();
+    xSemaphoreGive(surveyLock);
 }
 
-String getASCIIArt() {
-    return R"(
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                                                                                                                                                            
-                                                                                                                                                                                           @@@@@@@@                                                         @@@@@@@@                                        
-                                                                                                                                                                                       @@@ @@@@@@@@@@                                                    @@@@@@@@@@ @@@@                                    
-                                              @@@@@                                                           @@@@@                                                                               @@@@ @ @ @@@@@@@@@@@@@                                               @@@@@@@@@@@@ @@@@@@@@                                
-                                         @@@@ @@@@@@@@                                                     @@@@@@@@@@@@@                                                                     @@@@ @@@@@@@@@@@@@@@@@@@@@@@@                                          @@@@@@@@@@@@@@@@@@@ @@@@@@@@@                           
-                                     @@@@@@@@ @@@@@@@@@@                                                 @@@@@@@@@@@@ @@ @@@@                                                            @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@                                    @@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@                       
-                                @@@@@@@@@@@@@@@@@@@@@@@@@@@                                           @@@@@@@@@@@@@@@@@@@@@@@@@@@                                                        @@@@@@ @@@@@@@@@          @@@@@@@@@@@@                                @@@@@@@@@@@@@          @@@@@@@@@@@@@@@                       
-                           @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@                                      @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@                                                   @@@@@@@@@ @@@               @@@@@@@@@@@@@                          @@@@@@@@@@@@@               @@@@@@@@@@@@@                       
-                          @@@ @@@@@@@@@@@@@       @@@@@@@@@@@@@@                                 @@@@@@@@@@@@@@      @@@@@@@@@@@@@@@@@@                                                  @@ @@@@@@@@@                  @@@@@@@@@@@@@@                     @@@@@@@@ @@@@                   @@@@@  @@@@                       
-                          @@@@ @@@@@@@@@              @@@@@@@@@@@@                            @@@@@@@@@@@@@              @@@@@@@@@ @@ @                                                  @@@@   @@@@                   @@@@@@@@@@@ @@                     @ @@@@@@@@@@@                    @@@@  @ @@                       
-                          @@@@@@@ @@@                   @@@@@@@@@@@@@                       @@@@@@@@@@@@@                  @@@@ @@@@@@@                                                   @@@  @@@@                     @@ @@@@@@@@@@                     @@@@@@@@@ @@@                     @@@  @@ @                       
-                          @@@@@  @ @@                   @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@                   @@@@  @@@@                                                    @@@  @@@@                     @@@  @@ @                              @ @@@@@                      @@@@ @@@@                       
-                           @@@   @@@                     @@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@                    @@@@   @@@                                                    @@@@ @@@@                    @@@@  @@@@                              @@@@@@@@                    @@@@@@@@@@                       
-                           @@@@ @@@@                     @@ @@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@   @@@                     @@@  @@@@                                                    @@@@ @@@@@                   @@@   @ @                                 @ @@@@@                  @@@@@@@@@@                        
-                           @@@@ @@@@                     @@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@  @@@                     @@@@ @@@@                                                    @@@@@@@ @@@                @@@@@   @ @                                 @ @ @@@@                @@@@@@@@@ @                        
-                           @@@@ @@@@@                   @@@ @ @                                @@@@  @@@@                   @@@@@ @@@@                                                     @@@@@@@@@@@@             @@@@@    @@@@                               @@@@  @@@@@            @@@@@@@  @  @                        
-                           @@@@ @@ @@@                 @@@@ @ @                                 @ @   @@@@                 @@@ @@@@@@                                                      @@@ @@@ @@@@@@@@     @@@@@@@@     @@@@                               @@@@   @@@@@@@@    @@@@@@@@ @@ @@@@@                        
-                            @@@@@@@@@@@@             @@@@@  @@@                                @@@@   @@@@@              @@@@@@@@@@@@                                                      @@@@@@@   @@@@@@@@@@@@@@@@@        @@@                               @@@      @@@@@@@@@@@@@@@@@  @@ @@@@@                        
-                            @@@@ @@ @@@@@@         @@@@@@   @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@     @@@@@@        @@@@@@@ @@ @@ @                                                      @@@@@@@       @@@@@@@@@  @@@@@@@            @@@@@@@@          @@@     @@@@  @    @@@@@@@@@@      @@ @@@@@                        
-                            @@ @@@@@ @@@@@@@@@@@@@@@@@@     @@@@@                             @@@@       @@@@@@@@@@@@@@@@@@   @@@@ @@                                                      @@@@@@@       @@@  @@   @@ @@@@@           @@@@  @ @          @ @     @@@@@@ @     @ @           @@ @ @@                         
-                            @@ @ @@@  @@ @@@@@@@@@@@@@@@@@@   @@@@@@@ @@@@@@@@ @@@@@@@@@@@@@@@@@@@        @@ @@@@@@@@@@@@@@@ @@@@@@@@                                                      @@ @@@@      @@@@@@@@@@  @@@@@@ @@@        @@@@@@@@@          @@@@@   @@@@   @@@   @@@@@@@@      @@ @@@@                         
-                            @@@@ @@@  @@@@     @@@@  @@@@@@     @ @@@@@   @@@@@@@@@        @@@@@@@@@@@@   @ @ @@@@@@@@@  @@@@@@@@@@@@                                                       @@@@@@@  @@@ @@  @@@@@@@@@    @@@@         @@@@@@@   @@@@@   @@@@@@ @@@  @ @@@@@@@@@@@@@@@      @@@@@ @                         
-                            @@@@@@@@  @@@@  @@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@  @@@@@@@@@@ @@@@@@@@ @ @@@@@@@@@@@@@@@ @@@@                                                        @@@@@@@  @ @ @@  @@@@@@@@@@   @@@@          @@@@@@   @@@@@   @@@@@@ @ @   @@@@@@@@ @@  @@@      @@@@@@@                         
-                             @@@@ @@  @ @ @@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@ @@@@ @@@@@@@@@@@ @@@@@@@@@@@@   @  @@@@@@@ @@@@@@ @@@@                                                        @ @@ @@  @@@@ @  @@@@@@@@@@@@@@@            @@@@@@   @@@@@   @@@@@@ @@@@  @@@  @@@@@@@@@@@      @@@@@@@                         
-                             @  @ @@  @@@@@@@@@@@@@@@ @@@@@@@ @@@@@@@@@@@@ @@@  @@@@@@@@@@@@@@@@@ @  @@ @@@@  @  @@@@@ @@@   @@ @@ @                                                        @ @@@@@  @@@ @@  @@@@@ @@ @ @@ @@           @@@@@@   @@@@@   @@@@@@@@@@           @@@@@@       @@@@  @                          
-                             @@ @ @@  @@@@@@@@@@@@@@@ @@@@@@@@@@@   @@@@@@ @@@@ @@ @@@@@@@@@@@@@@ @@@@@@@@@@  @@@@@@@@@@     @@@@@ @                                                        @@ @@@@  @@@@    @@@@@@   @@@@@@@           @  @@@   @@@@@   @@@@@@@@@@           @@@@ @       @@@@@@@                          
-                             @@@@@@@  @@@@@@    @@@ @ @@ @@@@@@@@@   @@@@@@@@@@ @@@@@@@@@@@ @@@@@ @ @@ @@@@@  @@@@@ @@       @@@@@@                                                          @@@@@@  @@@@    @@@@@@       @@@           @@@@@@   @@@@@   @@@@@@@@@@           @@@@@@       @@@@@@@                          
-                             @@ @@@@  @@@@@@@@@@@@@@@ @@@@@@@    @@@@@@ @@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@    @@@@@@@@       @@@@@@                                                          @@@@@@  @@@      @ @ @@@@@@  @@@@ @        @@@@@@   @@@@@   @@@  @@@@@   @@@@@@  @@@@         @@@@@@                           
-                              @  @@@  @@@@@@@@ @@@@@@ @@@@@@@    @@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@ @ @@@@@@    @@@@@@@@@      @@@@@@                                                          @@@@@@   @@@    @@@@ @ @@@@@@@@@@ @        @@@@@@   @@ @@      @ @@@@@@@@@@@@@@  @@@@ @       @@@@@@                           
-                              @@ @@@   @@@@@@@@@@@@   @@@@@@@     @@@@@@ @@@@@@@@@@@@@@    @@@@@@@@@@@@@@@    @@@@@@@@@      @@@@@@                                                           @@@@@   @ @    @@@@ @@@@@@@@@@@ @@        @@@@@@   @@@@@      @@@@@@@ @ @@@@@@  @@@@         @@@  @                           
-                              @@@@@@      @@@@ @@@       @@@@             @@@ @@@@@      @@@@   @   @@@       @@@  @@@@      @@@@@                                                            @@@@@   @@@     @@@     @@@@@@@           @@@                      @@@@@@@@@    @@@@         @@@@@@                           
-                              @@@@@@@        @@       @@@@@   @@@@@@      @@@@@@@@@@@@@@@@   @    @@@@@@@@@@@@              @@ @@@                                                            @@@ @                                                                                        @@@@@@                           
-                              @@@@@@@      @@@@@      @ @@@@@ @@@@@@@@@   @@@@@ @@@@ @@@@ @@@@   @@@@@@@@  @@@              @@@@@@                                                            @@@@@@             @@@@@@@@@    @@@   @@@    @@@@@@@@@    @@@@@@@@     @@@@@@@@@             @@@@@                            
-                               @  @@@      @@@@       @@@@@ @ @@@@@@@ @   @@@@@@@@@@@@@@@        @@@@@@@@@@@@@              @@@@ @                                                            @@@@@@             @@    @@@    @ @   @ @@@  @@@    @@    @@ @@@@@     @@@    @@@            @ @@@                            
-                               @@@@@@      @@@@       @@@@@@@ @@@@@@@@ @@@@@@@@      @@@@      @@@@@@@     @@ @@@@@         @@@@@@                                                            @@@@@@             @@@@@@@@@@@@ @@@   @@@@@  @@@@@@@ @@@@  @@@@@@@@@@@  @@@@@@ @@@@          @ @@@                            
-                               @@@@@@     @@@@@      @@@@@@@@ @@@@@@  @@ @@@@@@      @@@@      @@@@@@@@      @@@@@@         @@@@@                                                              @@@@@           @@@@@   @@ @@@ @@@@  @@@@@@@@@@   @@@@@@@@@@   @@@@@@@@@@   @@@@@@         @@@@ @                            
-                                 @@@@     @@@@@      @@@@@@@@ @@@@@@  @@@@@@@@@      @@@@      @@@@@@@@@@@@@@@@@@@@         @@@@@                                                              @@@ @           @@ @@@  @@@@@@ @@@@@ @@@ @@@@@@   @@@@@@@@@@   @@ @@@@@@@   @@@@@@         @@@@@@                            
-                                @@@@@     @@@@@@@@@@@@@@@@@@@ @@@@@@     @@@@@@     @@@@@@@     @@@@@@@@@@@@@@ @@@@         @ @ @                                                              @@@@@           @@@@@@ @  @@@@ @@@@  @@@@@@@@@@   @@@@@@@@@@   @@@@@@@@@@   @@@@@@         @@@@@@                            
-                                @@@ @     @@ @  @      @@@   @@@  @@      @@@@@     @@   @@         @@@@@@@@@  @@           @@ @@                                                              @@@@@              @@@  @  @@@ @@@  @@@@@@@@@@@   @@@ @@@@@@   @@ @@@@@@@   @@ @@@         @@@ @                             
-                                @   @        @@@@@@@@@@@@@    @@@@@@    @ @@@@@@@@  @@@@@@@         @@@@@@@@@@@@            @@@@@                                                              @@@@                       @ @@@@@  @ @@ @ @@@@    @@ @@@@@@    @@@@@@@@@                    @@@                             
-                                @@@@@      @@@@@@@@@@@@@@@@@@@  @@@@   @@@   @@@@@@  @@@@   @@@@@       @@@@@               @@@@@                                                               @@@                       @@@@@@@  @@@@@@@@@@@     @@@@@@@@    @@@@ @@@@                    @ @                             
-                                @@@@@      @@ @@@  @@@ @  @@ @  @@@@   @ @@@@@ @@@@  @@@@   @ @@@@@@   @@@@@@                @@@                                                                @@@               @@@        @@@@   @@@  @@@@@   @@@  @@@@@        @@@@@                   @@@@                             
-                                 @@@       @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@ @@@@@@@   @ @@@@@@@@@@@@@ @@               @@@                                                                @ @              @@@@@@@@@@@ @@@@   @@@@ @@@@@@@@@@@@@ @@@@  @@@@  @@@@@                   @@@@                             
-                                 @@@              @@@@@     @@@@@@@@@@@@@@@@@  @@@@@@@@@@   @@@@@@@@@@@@@@@@@@@@             @ @                                                                @ @              @@@@@@@@@ @  @ @   @@@     @@@@@@@@ @  @ @     @    @ @                   @ @                              
-                                 @ @              @@@@@     @@@@@@@@@@@@@@@@@  @@@@@@@@@@   @ @@@@@@@@@@ @@@@@ @             @ @                                                                @@@              @@@@@@@@@@@  @@@   @@@@    @@@@@@@@@@  @@@  @@@@    @@@                   @ @                              
-                                 @@@@             @@@@@     @@@@  @@@@@@@ @@@@@@@ @@ @@@@   @ @@@@@@@@@@@@@ @  @@@          @@@@                                                                 @@@                                                                                       @@@                              
-                                 @@@@            @@@@@@@      @@@@@@    @@@ @@@@@ @@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@          @@@                                                                  @ @  @@@    @@@   @@@@   @@@   @@@@@@@@@@@@ @@@@@@@@@@         @@@   @@@@   @@@@@@@@@     @@@                              
-                                  @@@  @@@@@@    @@@@ @@      @@@@@@    @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@ @@@@@@@  @@@                                                                  @@@  @ @    @@@@  @@@@   @@@@  @@@@@@@@  @@ @@ @ @ @@@@        @ @   @@@@   @@  @ @@@@   @@@@                              
-                                  @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@    @@@@@@@@@@@ @ @@@@@@@ @@@@ @@@@@@ @@@@@@@@@@@@@@@@@@@@                                                                  @@@  @@@    @@@@  @@@@   @@@@  @@@@@@@@@@@@  @@@@@@@@@@        @@@   @@@@   @@@@@@@@@@   @@@@                              
-                                  @ @@@@@  @@@@@@ @@@@@        @@ @@@@@@ @@@@@     @ @@@@@@@@@@ @@  @@@       @@@@@@@@  @@@@@ @                                                                  @ @ @@@     @@@@@@@@@@@  @@@@     @@@ @@   @@@@    @@@@        @@@   @@@@@@ @@    @@@@@@ @@@                               
-                                  @@@@ @@@@@@ @@ @@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@   @@@ @                                                                  @@@@@@@@    @@@@@@@@@@@  @@@@@@   @@@@@@   @@@@@   @@@@@@    @@@@@   @@@@@@ @@@@ @@@ @ @ @@@                               
-                                  @@@@@@@@@@@@ @@ @          @@@@@@@@@@@                 @@@@@@@ @@@          @ @@@@@@@@@@@@@@                                                                    @@@@@@@@   @@@@@@@@@@@  @@@@ @   @@ @@@   @@@@@   @@@@@@    @@ @@   @@ @@@ @@@@ @ @  @@ @@@                               
-                                  @@@@@@@@@@@@@@@@@        @@@@@@@@@                          @@@@@@@@        @ @@@@ @@@@@@@@@                                                                    @@@@@@@    @@@@@@@@@    @@@@@@   @@@@@@   @@@@@   @@@@@@    @@@@@   @@@@@@ @@@@ @@@@   @@@                                
-                                   @@@@@@@@@@@@@ @@      @@@@@@@                                @@@@@@@@      @@@ @@@@@@@@@@@@                                                                    @@@@@@@     @ @ @@@@@   @@@ @@   @@@@@    @@@@@    @@@@@    @@@@@   @@@@@@       @@@@@@@@@                                
-                                   @@@@@@@@@@@@@@@@@   @@@  @@@@                                 @@@@@@@@@    @@@@@@@@@@@@@@@@                                                                    @ @@@@@     @ @ @@@@@   @ @@ @    @ @@    @@@@@   @@@@ @    @@@@@   @@@  @  @@@  @ @@ @@ @                                
-                                   @@@ @@@@@@@@@@@@@ @@@@@@@@@                                      @@@@@@@@ @@@@ @@@  @@@@@@                                                                      @ @@@@    @@@@ @@@@@   @ @@@@   @@@@     @@@@@   @ @@@@    @@@@@   @@@@@@  @ @  @ @@@ @@@                                
-                                   @@@@@@@@@@@@@ @@@@@@  @@                                         @@@@@ @@@@@@   @@@@@@@@@@                                                                      @@@@@  @@@@@@@ @@@@    @ @      @ @      @@@ @@@@@@@       @@@@@@@@@ @  @  @@@@@@ @  @@@@                                
-                                    @@@@@@@@@@@@ @@@@@@@@@@                                          @@ @@@ @@@@   @@@@@@@@@@                                                                      @@@    @@@ @ @ @@@@    @ @      @ @      @@@@@@@@@ @           @@@@@ @ @@  @@@@ @ @  @ @                                 
-                                    @@@  @@@@@   @@@@@ @@@                                            @@ @@@@@@@   @@ @@@ @@@                                                                      @@@@@@ @@@ @@@ @@@@    @@@      @@@       @@@@@@@@@@           @@@@@@@     @@@@ @@@@@@@@                                 
-                                    @@@@@@@ @@   @@@@ @@@@                                             @@@@ @@@@   @@@@@@@@@@                                                                       @@@@@   @@@                              @@@@                               @@@   @@@@@                                 
-                                    @@@  @@@@@@@@    @@@@    @@@@@@@                       @@@@@@@@@@@  @ @     @@@@@@@@ @@@                                                                        @ @@@  @@@@                              @@@@                               @@@  @@ @@@                                 
-                                      @@ @@@@@ @@    @@@@  @@@@@@@@@@                      @@@@@@@@@@@  @@@@    @@ @@@@@ @@@                                                                        @@ @@  @@@@        @@@@                  @@@@                   @@@@        @ @  @@@@@@                                 
-                                     @@@ @@@@@ @@    @ @   @@@@   @@@@                     @@       @@   @@@   @@@ @@@@@ @ @                                                                        @@@@@@ @@@         @@@@@@                @@@@@                @@@@@@        @ @  @@@ @                                  
-                                     @@@  @@@@ @@    @ @   @@      @@@                     @@       @@   @ @   @@@ @@@@  @ @                                                                        @@@@@@ @@@         @@@@@@@             @@@@@@@@             @@@@ @@@        @@@@ @@@ @                                  
-                                     @@@@ @@@@@@@    @ @   @@@@  @@@@@                     @@       @@   @@@   @@@@@@@@  @@@                                                                        @@@@@@ @@@          @@@@@@@@@@@@@@@@@ @@@@@ @@@@@@@@@@@@@@@@@@ @@@@         @@@@@@@@ @                                  
-                                     @@ @@@@@@@@     @@@@ @@@@@@@@@@@                      @@@@@@@@@@@@ @@@@     @@@@@@@@@@                                                                          @ @@@ @@@           @@@@@@@@@   @@@@@@@@@@@@@@@@@@@@@  @@@@@@@@@            @@@@@@@@@                                  
-                                      @@@ @@ @@@     @@@@@  @@@@@@@@                       @@@@@@@@@@@@@@ @      @@@@@   @@                                                                          @@@@@@@@@             @@@@@@@@@@@@ @@@ @@@@@@@@@@@ @@@@@@@@@@@              @@@@@@@@@                                  
-                                      @@@@@@@@@@      @@@@@@                                   @@@   @@@@@@      @@@@@@@@ @                                                                          @@@@@@@@@              @@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@              @ @@@@@@@                                  
-                                      @@@ @@@@@       @@@@@                                  @@@@@@@  @@@@@       @@@@ @@@@                                                                          @ @@@@@@@              @@ @@@@ @@@@@ @@@     @@ @@@@@@@@@@@@@               @ @@@@ @                                   
-                                      @ @@@@@@@@@@    @@@@@                                  @@@ @@@ @@@@@@    @@@@@@@@@@@@                                                                          @@@ @@@@               @@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@ @@@@               @ @@@@ @                                   
-                                      @@@@@@@@@ @@   @@@@@@                                  @@@@@@@ @@@@@@@   @@ @@@@@@@@@                                                                           @@@@@@@                @@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@               @@@@@@@@                                   
-                                      @@@@@@@@@@@@   @@@@@ @@@                                 @@@   @@@ @ @   @@@@@@@@@@@                                                                            @@@@@@@                @@@@@@@@@   @@@@@@@@@@@@@  @@@@@@@@@@               @@@@ @@@                                   
-                                       @ @@@@@@@@@   @@ @@@@@@                                        @ @@@ @@ @@@@@@@@@@@                                                                            @ @@@@@              @@@@@@@ @@       @@@@@@@@@@   @@@@@@ @@@              @@@@@@@@                                   
-                                       @@@@@@@@@@@ @@ @@@@@@@@@@@@                             @@@    @@@@@@ @@@@@@@@ @@@@                                                                            @ @@@@@            @@@@@@@@@@@@       @@@@@@@@@    @@@@@@@@@@@@@            @@@@ @                                    
-                                       @ @@@@@@@@@@@ @@ @ @@@ @@@@@@                        @@@@ @ @   @@@  @ @@@@@@@@@  @                                                                            @@@ @@@          @@@@ @@@@@@@@@       @@@@@@@@     @@@@@@@@@ @@@@@          @@@@@@                                    
-                                       @@@@ @@@@ @@@@@@@@   @@@@@@@@ @@@@               @@@@@ @@@@     @@@  @@@@ @@@@@@@@@                                                                             @@@     @@@@@@@@@@@@@ @@@@@@@@    @@@@@@@@@@@@    @@@@@@@@@@@@@@@@@@@@@@      @@@                                    
-                                       @@@@ @@@@ @ @ @@@@     @@@@@@@@@@@ @@@@@@@@@ @@@ @@@@@@@@       @@@@ @@@@ @@@  @@@                                                                              @ @     @@      @@@@@@@  @@@@@    @@  @@@@@@@@    @@@@@   @@@@@@@     @@      @ @                                    
-                                        @ @ @@@@ @ @ @ @        @@@ @ @@@ @@@@@@ @@ @ @ @@@@  @@       @@@@ @@@@ @@@@@@@@                                                                              @@@     @@@@@@@@@@@@@@@@@@@@@@    @@@@@@@@@@@@    @@@@@@@@@@@@@@@@@@@@@@     @@@                                     
-                                        @@@      @ @ @@@         @@@@@@@  @@@@@@@@@ @@@  @  @           @@@ @@@@     @@@@                                                                                               @@@@@ @@@@@@@        @@@@        @@@@@@@@ @@@@              @@@                                     
-                                        @@@      @ @ @@@            @@ @@@                @@            @@@ @@@@     @@@                                                                               @ @                @@@@@ @@@@@       @@@@@@@      @@@@@@@@@@@                @ @                                     
-                                        @@@      @ @ @ @             @@@ @                              @@@ @@@@     @@@                                                                               @ @                   @@@@@@@@       @@@@@@@      @@@@@@@@@                  @ @                                     
-                                        @ @   @@@@ @ @@@               @@@                              @@@ @@@@@@   @@@                                                                               @@@                     @@@@@@     @@@@@@@@@@@    @@@@@@@                    @@@                                     
-                                        @ @ @@@ @@ @                                                        @@@@ @@@@@@@                                                                               @@@                     @@@@@@     @@ @@@@  @@    @@@@@@@                    @@@@                                    
-                                        @@@@@ @@@@@@@   @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@   @ @@@@@ @@@@                                                                               @@@                   @@@@@@@@     @@@@@@@@@@@    @@@@@@@@@                   @@@                                    
-                                        @@@ @@    @ @@ @@@                                             @@  @@ @   @@@@@@                                                                              @@@@                @@@@@ @@@@@        @@@@        @@@@@@@@@@@                 @@@                                    
-                                        @@@@@      @ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @ @@      @@@@@                                                                             @ @               @@@@@ @@@@@@@      @@@@@@@@@     @@@@@@@@ @@@@@              @ @                                    
-                                        @@@@@@@@@@@@@@@  @                                            @ @@ @@@@@@@@@@@@@@                                                                             @@@      @@@@@@@@@@@@@@@@@@@@@@      @ @@@@@ @     @@@@@@@ @@@@@@@@@@@@@@      @@@@                                   
-                                       @@@@@@@@@@@@@@@   @                                            @ @@ @ @@@@@@@@ @@@                                                                             @@@      @@      @@@ @@@  @@@@@      @@@@@@@@@     @@@@@   @@@ @@@     @@      @@@@                                   
-                                       @@@@@@@@   @@@@   @                                            @ @@ @ @@   @@@ @@@@                                                                            @ @      @@@@@@@@@@@@@@@@@@@@@@        @@@@@       @@@@@@@@@@@@@@@@@@@@@@       @@@                                   
-                                       @@  @@@@@@@@@@@   @                                            @ @@ @ @@@@@@@@  @ @                                                                           @@@@              @@@@@@@@@@@@@@        @@@@        @@@@@@@@@@@@@@@              @@@                                   
-                                       @@@ @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@@  @@@                                                                           @@@                 @@@@@@@@@@@@        @@@@@@      @@@@@@@@@@@@                 @ @                                   
-                                       @ @ @   @@@   @   @                                            @ @@ @   @@@     @@@                                                                           @@@                  @@ @@@@@ @@        @@@@        @@@@@@@@@@@                  @ @                                   
-                                       @   @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@   @ @                                                                           @ @                  @@@@@@@@ @@@       @@@@       @@@@@@@@@@@@                  @@@@                                  
-                                      @@@@ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@  @@@@                                                                          @@@                  @@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@                 @@@@                                  
-                                      @@@@ @@@@   @@@@   @                                            @ @@ @@@@   @@@   @@@                                                                          @@@                  @@@@@@@@@@@ @@@@   @@@@   @@@@@@@@@ @@@@@@@                  @ @                                  
-                                      @@@@ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@   @@@                                                                         @@@@                  @@@@@ @@@@@@@ @@@@@@@@@@@@@@  @@@@@@@@@@@@@                  @@@                                  
-                                      @@@@ @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@@   @ @                                                                         @@@                  @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@  @@@                 @ @                                  
-                                      @ @@ @         @   @                                            @ @@ @            @@@                                                                         @@@                @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@                @@@@                                 
-                                     @@@@@ @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@@   @@@                                                                         @@@              @@@@ @@@@@@@@@@@   @@@@ @@@@@@@@@   @@@@@@@@@@@@@@@@              @@@@                                 
-                                     @@@@@ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@   @@@@                                                                        @ @              @@@@@@@              @@@@@@@@@@@             @@@@ @@               @ @                                 
-                                     @ @ @ @@@    @@@@   @                                            @ @@ @@@@   @@@    @@@                                                                        @@@              @@@@@                 @@@@@@@@                 @@@@@@              @@@                                 
-                                     @@@ @ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@    @@@                                                                       @@@               @@@@                    @@@@@                    @@@               @@@                                 
-                                     @@@ @ @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@@    @@@                                                                       @ @                                       @@@@                                       @ @                                 
-                                    @@@  @ @  @@@@   @   @                                            @ @@ @   @@@@      @ @                                                                       @@@                                       @@@@                                       @@@@                                
-                                    @@@  @ @@@@@@@@@ @   @                                            @ @@ @ @@@@@@@@    @@@                                                                       @ @                   @@@ @@@             @@@@@@           @@@ @@@@                  @@@@                                
-                                    @@@  @ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@     @@@                                                                     @ @                    @ @@@ @@@          @@@@@@@          @@ @@@@@@                @@@@ @                                
-                                    @@@  @ @@@@  @@@@@   @                                            @ @@ @@@@   @@@     @ @                                                                     @@@@@@@                @@@@@@@ @          @ @ @ @        @@@@@@@@@@@                @@@@@@                                
-                                   @@@@@@@ @@@@@@@@@@@   @                                            @ @@ @@@@@@@@@@     @@@                                                                     @@@@@@@                   @ @@@@@@@       @ @ @ @       @@ @@@@@@@ @                @@@@@@                                
-                                   @@@@@@@ @@@@@@@@@ @   @                                            @ @@@@@@@@@@@@   @@@@@@                                                                     @@    @                @  @@@ @ @ @@@     @ @ @ @     @@@@@ @@@@ @ @               @@@@@@@@                               
-                                   @@@@@@@ @  @@@@   @   @                                            @ @ @@@@@@@@@    @@@@@@                                                                    @@@@   @                @    @@@@@@@ @     @ @ @ @   @@@ @  @@@@  @ @               @@@@@@@@                               
-                                   @@@@@@  @@@@@@@@@ @   @                                            @ @  @@@@@@@@@@  @@@@@@@                                                                   @ @@   @                @ @    @@ @@@@@@@  @ @ @ @  @@ @@@@@@@    @ @               @@  @  @                               
-                                   @ @@@@  @@@@@@@@@@@   @                                            @ @   @@@@@@@@@  @@@@@@@                                                                   @@@@@  @                @ @     @@@ @ @ @@ @ @ @ @@@@@@ @ @@      @ @               @@  @@@@@                              
-                                  @@@@@@@  @@@@  @@@@@   @                                            @ @   @@@   @@@  @@@@@@@                                                                   @@@@@ @@@               @ @       @@@@@@@@@@ @ @ @@ @ @ @@@       @ @               @@  @@@@@                              
-                                  @ @@@@@  @@@@@@@@@@@   @                                            @ @   @@@@@@@@@  @@@@@@@                                                                   @ @@@ @@@               @ @         @@ @@@ @ @ @ @@@@@@@@         @ @               @@  @@@@@                              
-                                  @@@@@@@  @@@@@@@@@@ @@ @                                            @ @    @@@@@@@   @@@@@@ @                                                                 @@@@@@ @@@               @ @          @@@ @@@   @@@@@ @            @ @              @@@  @@@@@                              
-                                  @@@@@ @  @  @@@@@@ @@@ @                                            @ @     @@@@@    @@ @@                                                                    @@@@@@ @@@               @ @            @@@@@@  @@@ @@@            @ @              @@@   @  @                              
-                                  @ @@@ @  @@@@@@@@@@  @ @                                            @ @    @@@@@@@@  @@ @@@@@                                                                 @@ @@@ @@@@              @ @              @@ @  @@ @@              @ @              @@    @@@@                              
-                                  @ @@@ @  @@@@@@@@@@  @ @                                            @ @   @@@@ @@@@  @@ @@@ @                                                                 @ @@ @ @@@@              @ @               @@@@ @@@                @ @             @@@    @@@@@                             
-                                 @@@@@@ @  @@@@  @@@@  @ @                                            @ @   @@@@ @@@@  @@ @@ @@@                                                                @@@@ @ @ @@              @ @                @ @ @ @                @ @             @@@    @@@@@                             
-                                 @@@@@  @  @@@@@@@@@   @ @                                            @ @   @@@@@@@@@  @@ @@@@@@                                                                @@@@ @ @ @@              @ @                @ @ @ @                @ @             @@@     @  @                             
-                                 @@ @@  @  @ @@@@@@    @ @                                            @ @    @@@@@@@   @@  @@@@@                                                               @@@@  @ @ @@@                                @ @ @ @                @ @             @@      @@@@                             
-                                 @ @@@  @  @ @@@@@@    @ @                                            @ @     @@@@@    @@  @@@ @                                                               @@@@  @ @ @@@             @@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@             @@      @@@@                             
-                                 @ @@@  @  @@@@@@@@@   @ @                                            @ @    @@@@@@@@  @@  @@@@@                                                               @@@@  @ @  @@   @@@@@@@@@@@@                 @@@ @@@                @@@ @@@@@@@@@  @@@       @@@@                            
-                                @@@@@   @  @@@@@ @@@   @ @                                            @ @   @@@@ @@@@  @@  @@ @@                                                               @@@@  @ @  @@@@@@@@@ @@@  @@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@ @@  @@@ @   @@@       @@@@                            
-                                @@@@@   @  @@@@  @@@   @ @                                            @ @   @@@@ @@@@  @@   @@@@@                                                              @@@   @ @  @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@@ @@        @@@@                            
-                                @ @@@   @  @@@@@@@@@   @@@                                            @@@    @@@@@@@@  @@   @@@@@                                                              @@@   @ @  @@@ @@@@ @@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@        @@@@                            
-                                @@@@@   @@@@ @@@@@@     @                                             @@@    @@@@@@@@@@@@   @@@@@                                                             @@@@   @ @  @@@@@@@@@@@@@@@@@@@@@@ @@@@@ @@@@@ @@@@ @@@@@@@ @  @ @@@@@@@@@@@@@@@@@@ @@         @@@                            
-                                @@@@    @@@@@                                                                       @@@@@   @@@@@                                                             @@@@   @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@@@@@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@@     @@@                            
-                                 @@@    @@@ @@@                                                                   @@@@@@@   @@@ @                                                             @@@@   @@@ @@@@@@@@@@@@@@@@@@@@@@@ @@        @@@@ @@@@       @@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@   @@@@                           
-                               @@@@@    @@@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@@    @@@@                                                             @@@  @@@@@@@@@@@@@@@@@@@@@ @@@@    @@@@@@@@@@@@@@@@@@@@@@@@@@@@    @@@@  @@@@@@@@@@@@@@@@@@@@@ @@@@                           
-                               @@@@   @@@@@@@@@@@@@@        @@@                                   @@@        @@@@@@@@@@@@@@  @@@@@                                                            @@@@@@@@@@@         @@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@  @@@@@@        @@@@@ @@  @@                           
-                               @@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@  @@ @                                                           @@@@@@@@@              @@@@@@@@@@@@@@@@@@@@@@@@@@  @@@@@@@@@@@@@@@@@@@@@ @@@@              @@@@@@@@@                           
-                              @@@@@@@@@@@@@       @@@@@@@@@@@@@ @                               @ @ @@@@@@@@@@@      @@@@@@@@@@@@@                                                           @@@@@@@@                 @@@@@@@@                                   @@@@@@@                  @@@@@@@                           
-                              @ @@@@@@@@             @@@@ @@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@  @  @@@@             @@@@@@@@@                                                           @@@ @@@                   @@@@@ @                                   @ @@@@                    @@@@ @@                          
-                              @@@@@@@@                 @@@@@@@@@                                 @@  @ @@                  @@@@@@@                                                          @@@@@@@                     @@@@ @                                   @ @@@@                     @@ @@@                          
-                              @@@ @@@                    @@@@ @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@ @@@@                    @@@@@@@                                                         @ @ @@                      @@@@ @                                   @ @@@                      @@ @@@                          
-                              @ @@@@                     @@@@ @                                   @ @@@@                    @@@ @@@                                                         @@@ @@@                     @@ @ @                                   @ @@@@                    @@@ @@@                          
-                             @@@@@@@                     @@ @ @                                   @ @@@@                     @@ @@@                                                         @@@@@@@@                   @@@ @ @                                   @ @@@@@                   @@@@@@@@                         
-                             @@@@@@@                     @@ @ @                                   @ @@@@                     @@ @@@                                                         @ @@@@@@@                 @@@@@@ @                                   @ @@@@@@                @@@ @@@@ @                         
-                             @@@@@@@@                   @@@@@ @                                   @ @@@@@                   @@@@ @ @                                                        @@@@@@@@@@@             @@@@@@@@ @                                   @ @@@@@@@@            @@@@@@@@@@@@                         
-                             @@@@@@@@@                 @@@@@@ @                                   @ @@@@@@                 @@@@@  @                                                        @@@@@ @@@@@@@@@       @@@@@@@@@@@@@                                   @@@@ @@ @@@@@      @@@@@@@@@ @@@@@                         
-                             @ @@@@@@@@               @@@@@@@ @                                   @ @@@@@@               @@@@@@@ @@@                                                       @ @@@  @@@@@@@@@@@@@@@@@@@@ @@@@@@@                                   @@@@@ @@@@@@@@@@@@@@@@@@@@@  @@@ @                         
-                             @@@@@ @@@@@@@         @@@@@@@@@@ @                                   @ @@ @@@@@@@         @@@@ @@@@ @ @                                                       @ @@@     @@@@ @@@@@@@ @@@@@@@@@@@                                     @@@@@@@@@@@@@@@@@@@@@@@     @@@ @                         
-                            @@@@@@  @@@@@@@@@@@@@@@@@@@@@@@@@@@                                   @@@@@@@@@@@@@@@@@@@@@@@@@@@ @@ @@@                                                       @ @@@@@@@     @@@@@@@@@@@@@@@@@                                          @@@@@@@ @@@@@@@@@     @@@@@@@@@                         
-                            @@@@@@    @@@@@@@@@@@@@@@@@@@@@@@@@                                   @@@@@@@@@ @@@@@@@@@@@@@@@   @@  @@@                                                      @@@@@@@@@@@@@  @@@@@@ @@@@@@                                                @@@@@@@@@@@@@  @@@@@@@@@@@@@                         
-                            @@@@@@@@@      @@@@@@@@@@@@@@@@@                                         @@@@@@@@@@@@@@@@@     @@@@@@@@ @                                                          @@@@@@@@@@@@@@ @@@@@@                                                      @@@@@@ @@@@@@@@@@@@@@@                            
-                            @@@@@@@@@@@@@@   @@@@@ @@@@@@                                              @@@@@@@ @@@@@   @@@@@@@@@@@@@@                                                              @@@@@@@@@@@@@@                                                            @@@@@@@@@@@@@@@                                
-                               @@@ @@@@@@@@@@@@@@ @@@@                                                     @@@@  @@@@@@@@@@@@@@@@@                                                                      @@@@@@                                                                  @@@@@@@                                     
-                                   @@@ @@@@@@@@@@@@                                                           @@@@@@@@@@@@@@@@                                                                                                                                                                                              
-                                       @@@@  @@@                                                                @@@@ @@@@@                                                                                                                                                                                                  
-                                                                                                                    @                                                                                                                                                                                                       
-)";
+// Count the adverts the survey scan queued since the last call
+void serviceSurvey() {
+    if (!trackerSurveying()) return;
+    xSemaphoreTake(surveyLock, portMAX_DELAY);
+    trackerSurveyUpdate();
+    xSemaphoreGive(surveyLock);
+}
+
+// Append one list of survey entries as a JSON array. Vendors are OUI rules,
+// devices full addresses; either can go straight into the target list.
+void appendSurveyJSON(String& json, const SurveyEntry* entries, size_t count, bool vendors, uint32_t now) {
+    json += "[";
+    for (size_t i = 0; i < count; i++) {
+        const SurveyEntry& entry = entries[i];
+        char address[18];
+        if (vendors) {
+            formatMACKey(entry.key << 24, address, MAC_MASK_OUI);
+            address[8] = '\0';
+        } else {
+            formatMACKey(entry.key, address);
+        }
+        if (i > 0) json += ",";
+        json += "{\"address\":\"";
+        json += address;
+        json += "\",\"random\":";
+        json += entry.addressType == HAL_ADDR_RANDOM ? "true" : "false";
+        json += ",\"count\":";
+        json += String(entry.count);
+        json += ",\"error\":";
+        json += String(entry.error);
+        json += ",\"rssi\":";
+        json += String(entry.meanRssi());
+        json += ",\"peak\":";
+        json += String(entry.peakRssi);
+        json += ",\"age\":";
+        json += String((now - entry.lastSeen) / 1000);
+        json += "}";
+    }
+    json += "]";
+}
+
+String generateSurveyJSON() {
+    SurveyEntry devices[SURVEY_REPORT_DEVICES];
+    SurveyEntry strongest[SURVEY_REPORT_STRONGEST];
+    SurveyEntry vendors[SURVEY_REPORT_VENDORS];
+    size_t deviceCount = 0, strongestCount = 0, vendorCount = 0;
+    uint32_t adverts = 0, dropped = 0;
+    bool active = trackerSurveying();
+    if (surveyLock) {
+        xSemaphoreTake(surveyLock, portMAX_DELAY);
+        deviceCount = surveyDevices.sorted(devices, SURVEY_REPORT_DEVICES);
+        strongestCount = surveyStrongest.sorted(strongest, SURVEY_REPORT_STRONGEST);
+        vendorCount = surveyVendors.sorted(vendors, SURVEY_REPORT_VENDORS);
+        adverts = surveyDevices.adverts();
+        dropped = surveyRing.overflows();
+        xSemaphoreGive(surveyLock);
+    }
+    
+    uint32_t now = millis();
+    String json;
+    json.reserve(128 + (deviceCount + strongestCount + vendorCount) * 112);
+    json += "{\"active\":";
+    json += active ? "true" : "false";
+    json += ",\"adverts\":";
+    json += String(adverts);
+    json += ",\"dropped\":";
+    json += String(dropped);
+    json += ",\"devices\":";
+    appendSurveyJSON(json, devices, deviceCount, false, now);
+    json += ",\"strongest\":";
+    appendSurveyJSON(json, strongest, strongestCount, false, now);
+    json += ",\"vendors\":";
+    appendSurveyJSON(json, vendors, vendorCount, true, now);
+    json += "}";
+    return json;
 }
 
-String generateConfigHTML() {
+// Append str to out as a quoted JSON string
+void appendJSONString(String& out, const String& str) {
+    out += '"';
+    for (size_t i = 0; i < str.length(); i++) {
+        char c = str[i];
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if ((uint8_t)c >= 0x20) {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+// Dynamic values for the static config page
+String generateConfigJSON() {
     // Generate random MAC for placeholder
-    String randomMAC = "";
+    char randomMAC[18];
     randomSeed(analogRead(0) + micros());
+    uint64_t randomKey = 0;
     for (int i = 0; i < 6; i++) {
-        if (i > 0) randomMAC += ":";
-        byte randByte = random(0, 256);
-        if (randByte < 16) randomMAC += "0";
-        randomMAC += String(randByte, HEX);
+        randomKey = (randomKey << 8) | (uint64_t)random(0, 256);
+    }
+    formatMACKey(randomKey, randomMAC);
+    for (char* c = randomMAC; *c; c++) {
+        *c = tolower(*c);
     }
-    randomMAC.toLowerCase();
-
-    String html = R"html(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>OUI-SPY FOXHUNT Configuration</title>
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        * { box-sizing: border-box; }
-        body {
-            font-family: 'Segoe UI', Tahoma, Geneva, Verdana, sans-serif;
-            margin: 0; 
-            padding: 20px;
-            background: #0f0f23;
-            color: #ffffff;
-            position: relative;
-            overflow-x: hidden;
-        }
-        .ascii-background {
-            position: fixed;
-            top: 0;
-            left: 0;
-            width: 100%;
-            height: 100%;
-            z-index: -1;
-            opacity: 0.6;
-            color: #00ff00;
-            font-family: 'Courier New', monospace;
-            font-size: 8px;
-            line-height: 8px;
-            white-space: pre;
-            pointer-events: none;
-            overflow: hidden;
-        }
-        .container {
-            max-width: 700px; 
-            margin: 0 auto; 
-            background: rgba(255, 255, 255, 0.02);
-            padding: 40px; 
-            border-radius: 16px;
-            box-shadow: 0 8px 32px rgba(0, 0, 0, 0.2); 
-            backdrop-filter: blur(5px);
-            border: 1px solid rgba(255, 255, 255, 0.05);
-            position: relative;
-            z-index: 1;
-        }
-        h1 {
-            text-align: center;
-            margin-bottom: 20px;
-            margin-top: 0px;
-            font-size: 48px;
-            font-weight: 700;
-            color: #8a2be2;
-            background: -webkit-linear-gradient(45deg, #8a2be2, #4169e1);
-            background: -moz-linear-gradient(45deg, #8a2be2, #4169e1);
-            background: linear-gradient(45deg, #8a2be2, #4169e1);
-            -webkit-background-clip: text;
-            -moz-background-clip: text;
-            background-clip: text;
-            -webkit-text-fill-color: transparent;
-            -moz-text-fill-color: transparent;
-            letter-spacing: 3px;
-        }
-        @media (max-width: 768px) {
-            h1 {
-                font-size: clamp(32px, 8vw, 48px);
-                letter-spacing: 2px;
-                margin-bottom: 15px;
-                text-align: center;
-                display: block;
-                width: 100%;
-            }
-            .container {
-                padding: 20px;
-                margin: 10px;
-            }
-        }
-        .section { 
-            margin-bottom: 30px; 
-            padding: 25px; 
-            border: 1px solid rgba(255, 255, 255, 0.1); 
-            border-radius: 12px; 
-            background: rgba(255, 255, 255, 0.01); 
-            backdrop-filter: blur(3px);
-        }
-        .section h3 { 
-            margin-top: 0; 
-            color: #ffffff; 
-            font-size: 18px;
-            font-weight: 600;
-            margin-bottom: 15px;
-        }
-        textarea { 
-            width: 100%; 
-            min-height: 120px;
-            padding: 15px; 
-            border: 1px solid rgba(255, 255, 255, 0.2); 
-            border-radius: 8px; 
-            background: rgba(255, 255, 255, 0.02);
-            color: #ffffff;
-            font-family: 'Courier New', monospace;
-            font-size: 14px;
-            resize: vertical;
-        }
-        textarea:focus {
-            outline: none;
-            border-color: #4ecdc4;
-            box-shadow: 0 0 0 3px rgba(78, 205, 196, 0.2);
-        }
-        .toggle-container {
-            display: flex;
-            flex-direction: column;
-            gap: 15px;
-        }
-        .toggle-item {
-            display: flex;
-            align-items: center;
-            gap: 15px;
-            padding: 15px;
-            border: 1px solid rgba(255, 255, 255, 0.1);
-            border-radius: 8px;
-            background: rgba(255, 255, 255, 0.02);
-        }
-        .toggle-item input[type="checkbox"] {
-            width: 20px;
-            height: 20px;
-            accent-color: #4ecdc4;
-            cursor: pointer;
-        }
-        .toggle-label {
-            font-weight: 500;
-            color: #ffffff;
-            cursor: pointer;
-            user-select: none;
-        }
-        .help-text { 
-            font-size: 13px; 
-            color: #a0a0a0; 
-            margin-top: 8px; 
-            line-height: 1.4;
-        }
-        button { 
-            background: linear-gradient(135deg, #667eea 0%, #764ba2 100%); 
-            color: #ffffff; 
-            padding: 14px 28px; 
-            border: none; 
-            border-radius: 8px; 
-            cursor: pointer; 
-            font-size: 16px; 
-            font-weight: 500;
-            margin: 10px 5px; 
-            transition: all 0.3s;
-        }
-        button:hover { 
-            transform: translateY(-2px);
-            box-shadow: 0 8px 25px rgba(102, 126, 234, 0.4);
-        }
-        .button-container {
-            text-align: center;
-            margin-top: 40px;
-            padding-top: 30px;
-            border-top: 1px solid #404040;
-        }
-        .status { 
-            padding: 15px; 
-            border-radius: 8px; 
-            margin-bottom: 30px; 
-            margin-top: 10px;
-            border-left: 4px solid #ff1493;
-            background: rgba(255, 20, 147, 0.05);
-            color: #ffffff;
-            border: 1px solid rgba(255, 20, 147, 0.2);
-        }
-    </style>
-</head>
-<body>
-    <div class="ascii-background">)html" + getASCIIArt() + R"html(</div>
-    <div class="container">
-        <h1>OUI-SPY FOXHUNT</h1>
-        
-            <div class="status">
-            Enter the target MAC address for foxhunt tracking. Beep speed indicates proximity: LIGHTNING FAST when close, PAINFULLY SLOW when far.
-        </div>
-        
-        <form method="POST" action="/save">
-            <div class="section">
-                <h3>Target MAC Address</h3>
-                <textarea name="targetMAC" placeholder="Enter target MAC address:
-)html" + randomMAC + R"html(">)html" + targetMAC + R"html(</textarea>
-                <div class="help-text">
-                    Single MAC address for directional antenna tracking.<br>
-                    Format: XX:XX:XX:XX:XX:XX (17 characters with colons)<br>
-                    Beep intervals: 50ms (LIGHTNING) to 10s (PAINFULLY SLOW)
-                </div>
-            </div>
-            
-            <div class="section">
-                <h3>Audio & Visual Settings</h3>
-                <div class="toggle-container">
-                    <div class="toggle-item">
-                        <input type="checkbox" id="buzzerEnabled" name="buzzerEnabled" )html" + String(buzzerEnabled ? "checked" : "") + R"html(>
-                        <label class="toggle-label" for="buzzerEnabled">Enable Buzzer</label>
-                        <div class="help-text" style="margin-top: 0;">Audio feedback for target proximity</div>
-                    </div>
-                    <div class="toggle-item">
-                        <input type="checkbox" id="ledEnabled" name="ledEnabled" )html" + String(ledEnabled ? "checked" : "") + R"html(>
-                        <label class="toggle-label" for="ledEnabled">Enable LED Blinking</label>
-                        <div class="help-text" style="margin-top: 0;">Orange LED blinks with same cadence as buzzer</div>
-                    </div>
-                </div>
-            </div>
-            
-            <div class="button-container">
-                <button type="submit">Save Configuration & Start Scanning</button>
-                <button type="button" onclick="clearConfig()" style="background: #8b0000; margin-left: 20px;">Clear All Filters</button>
-                <button type="button" onclick="deviceReset()" style="background: #4a0000; margin-left: 20px; font-size: 12px;">Device Reset</button>
-            </div>
-            
-            <script>
-            function clearConfig() {
-                if (confirm('Are you sure you want to clear the target MAC? This action cannot be undone.')) {
-                    document.querySelector('textarea[name="targetMAC"]').value = '';
-                    fetch('/clear', { method: 'POST' })
-                        .then(response => response.text())
-                        .then(data => {
-                            alert('Target MAC cleared!');
-                            location.reload();
-                        })
-                        .catch(error => {
-                            console.error('Error:', error);
-                            alert('Error clearing target. Check console.');
-                        });
-                }
-            }
-            
-            function deviceReset() {
-                if (confirm('DEVICE RESET: This will completely wipe all saved data and restart the device. Are you absolutely sure?')) {
-                    if (confirm('This action cannot be undone. The device will restart and behave like first boot. Continue?')) {
-                        fetch('/device-reset', { method: 'POST' })
-                            .then(response => response.text())
-                            .then(data => {
-                                alert('Device reset initiated! Device restarting...');
-                                setTimeout(function() {
-                                    window.location.href = '/';
-                                }, 5000);
-                            })
-                            .catch(error => {
-                                console.error('Error:', error);
-                                alert('Error during device reset. Check console.');
-                            });
-                    }
-            }
-        }
-    </script>
-        </form>
-    </div>
-</body>
-</html>
-)html";
     
-    return html;
+    String json;
+    json.reserve(512 + targetMAC.length() + beepCurve.length());
+    json += "{\"targetMAC\":";
+    appendJSONString(json, targetMAC);
+    json += ",\"placeholder\":\"";
+    json += randomMAC;
+    json += "\",\"buzzerEnabled\":";
+    json += buzzerEnabled ? "true" : "false";
+    json += ",\"ledEnabled\":";
+    json += ledEnabled ? "true" : "false";
+    json += ",\"proximityCue\":";
+    json += proximityCue ? "true" : "false";
+    json += ",\"trendCue\":";
+    json += trendCue ? "true" : "false";
+    json += ",\"trendThreshold\":";
+    json += String(trendThreshold / 10.0f, 1);
+    json += ",\"recordSessions\":";
+    json += recordSessions ? "true" : "false";
+    json += ",\"liveTelemetry\":";
+    json += liveTelemetry ? "true" : "false";
+    json += ",\"telemetryRate\":";
+    json += String(telemetryRate);
+    json += ",\"rssiFilter\":";
+    json += String(rssiFilterType);
+    json += ",\"rssiFilters\":[";
+    for (uint8_t i = 0; i < RSSI_FILTER_COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "\"";
+        json += rssiFilterName(i);
+        json += "\"";
+    }
+    json += "],\"scanResponses\":";
+    json += String(scanResponseMode);
+    json += ",\"scanResponseModes\":[";
+    for (uint8_t i = 0; i < SCAN_RESPONSE_MODE_COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "\"";
+        json += scanResponseName(i);
+        json += "\"";
+    }
+    json += "],\"logLevel\":";
+    json += String(logLevel);
+    json += ",\"logLevels\":[";
+    for (uint8_t i = 0; i < LOG_LEVEL_COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "\"";
+        json += logLevelName(i);
+        json += "\"";
+    }
+    json += "],\"logFormat\":";
+    json += String(logFormat);
+    json += ",\"logFormats\":[";
+    for (uint8_t i = 0; i < LOG_FORMAT_COUNT; i++) {
+        if (i > 0) json += ",";
+        json += "\"";
+        json += logFormatName(i);
+        json += "\"";
+    }
+    json += "],\"beepCurve\":";
+    appendJSONString(json, beepCurve);
+    json += "}";
+    return json;
 }
 
-// Web server handlers
-void startConfigMode() {
-    currentMode = CONFIG_MODE;
-    Serial.println("\n=== STARTING FOXHUNT CONFIG MODE ===");
-    Serial.println("SSID: " + String(AP_SSID));
-    Serial.println("Password: " + String(AP_PASSWORD));
-    Serial.println("Initializing WiFi AP...");
+// Serve a gzipped page from flash, or 304 if the browser already has it
+void sendGzipAsset(AsyncWebServerRequest *request, const uint8_t* data, size_t length, const char* etag) {
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == etag) {
+        request->send(304);
+        return;
+    }
+    AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", data, length);
+    response->addHeader("Content-Encoding", "gzip");
+    response->addHeader("Cache-Control", "no-cache");
+    response->addHeader("ETag", etag);
+    request->send(response);
+}
+
+// Settings cannot change under the BLE task while tracking with the portal up
+bool rejectWhileTracking(AsyncWebServerRequest *request) {
+    if (currentMode != TRACKING_MODE) return false;
+    request->send(409, "text/plain", "Tracking in progress - reset the device to reconfigure");
+    return true;
+}
+
+// Bring up the AP and web server, once per boot. softAP() returns with the
+// AP running, so nothing waits on it; settings stay locked while tracking.
+void startPortal() {
+    if (portalStarted) return;
+    portalStarted = true;
+    LOG_INFO("SSID: %s", AP_SSID);
+    LOG_INFO("Password: %s", AP_PASSWORD);
+    LOG_INFO("Initializing WiFi AP...");
     
     WiFi.mode(WIFI_AP);
     WiFi.softAP(AP_SSID, AP_PASSWORD);
-    delay(2000); // Allow AP to fully initialize
     
-    // Set timing AFTER AP initialization
-    configStartTime = millis();
-    lastConfigActivity = millis();
-    
-    Serial.println("✓ Access Point created successfully!");
-    Serial.println("AP IP address: " + WiFi.softAPIP().toString());
-    Serial.println("Config portal: http://" + WiFi.softAPIP().toString());
-    Serial.println("==============================\n");
+    LOG_INFO("✓ Access Point created successfully!");
+    LOG_INFO("AP IP address: %s", WiFi.softAPIP().toString().c_str());
+    LOG_INFO("Config portal: http://%s", WiFi.softAPIP().toString().c_str());
+    LOG_INFO("==============================\n");
     
     // Web server routes
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request){
         lastConfigActivity = millis();
-        request->send(200, "text/html", generateConfigHTML());
+        sendGzipAsset(request, INDEX_HTML_GZ, INDEX_HTML_GZ_LEN, INDEX_HTML_ETAG);
+    });
+    
+    server.on("/config.json", HTTP_GET, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        request->send(200, "application/json", generateConfigJSON());
+    });
+    
+    // Busiest and strongest devices around, for picking a target
+    server.on("/survey.json", HTTP_GET, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        request->send(200, "application/json", generateSurveyJSON());
+    });
+    
+    server.on("/survey", HTTP_POST, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        if (rejectWhileTracking(request)) return;
+        startSurvey();
+        request->send(200, "text/plain", "Survey restarted");
     });
     
     server.on("/save", HTTP_POST, [](AsyncWebServerRequest *request){
         lastConfigActivity = millis();
+        if (rejectWhileTracking(request)) return;
+        
+        // Reject a bad curve before anything changes, as /curve does
+        String curve = beepCurve;
+        if (request->hasParam("beepCurve", true)) {
+            curve = request->getParam("beepCurve", true)->value();
+            curve.trim();
+            if (!validBeepCurve(curve)) {
+                request->send(400, "text/plain", INVALID_CURVE_MESSAGE);
+                return;
+            }
+        }
         
         if (request->hasParam("targetMAC", true)) {
             targetMAC = request->getParam("targetMAC", true)->value();
             targetMAC.trim();
             targetMAC.toUpperCase(); // Ensure consistent case for comparison
+            updateTargets();
             
             // Process buzzer and LED toggles
             buzzerEnabled = request->hasParam("buzzerEnabled", true);
             ledEnabled = request->hasParam("ledEnabled", true);
+            proximityCue = request->hasParam("proximityCue", true);
+            trendCue = request->hasParam("trendCue", true);
+            if (request->hasParam("trendThreshold", true)) {
+                long threshold = lroundf(request->getParam("trendThreshold", true)->value().toFloat() * 10);
+                if (threshold >= TREND_THRESHOLD_MIN && threshold <= TREND_THRESHOLD_MAX) {
+                    trendThreshold = (uint8_t)threshold;
+                }
+            }
+            recordSessions = request->hasParam("recordSessions", true);
+            liveTelemetry = request->hasParam("liveTelemetry", true);
+            if (request->hasParam("telemetryRate", true)) {
+                long rate = request->getParam("telemetryRate", true)->value().toInt();
+                if (rate >= 1 && rate <= TELEMETRY_MAX_RATE) {
+                    telemetryRate = (uint8_t)rate;
+                }
+            }
+            if (request->hasParam("rssiFilter", true)) {
+                long filter = request->getParam("rssiFilter", true)->value().toInt();
+                if (filter >= 0 && filter < RSSI_FILTER_COUNT) {
+                    rssiFilterType = (uint8_t)filter;
+                }
+            }
+            if (request->hasParam("scanResponses", true)) {
+                long mode = request->getParam("scanResponses", true)->value().toInt();
+                if (mode >= 0 && mode < SCAN_RESPONSE_MODE_COUNT) {
+                    scanResponseMode = (uint8_t)mode;
+                }
+            }
+            if (request->hasParam("logLevel", true)) {
+                long level = request->getParam("logLevel", true)->value().toInt();
+                if (level >= 0 && level < LOG_LEVEL_COUNT) {
+                    logLevel = (uint8_t)level;
+                }
+            }
+            if (request->hasParam("logFormat", true)) {
+                long format = request->getParam("logFormat", true)->value().toInt();
+                if (format >= 0 && format < LOG_FORMAT_COUNT) {
+                    logFormat = (uint8_t)format;
+                }
+            }
             
-            Serial.println("Received target MAC: " + targetMAC);
-            Serial.println("Buzzer enabled: " + String(buzzerEnabled ? "Yes" : "No"));
-            Serial.println("LED enabled: " + String(ledEnabled ? "Yes" : "No"));
+            LOG_INFO("Received targets: %u", (unsigned)targets.count());
+            LOG_INFO("Buzzer enabled: %s", buzzerEnabled ? "Yes" : "No");
+            LOG_INFO("LED enabled: %s", ledEnabled ? "Yes" : "No");
+            LOG_INFO("Proximity cadence: %s, trend pitch: %s (%.1f dB/s)", proximityCue ? "On" : "Off",
+                     trendCue ? "On" : "Off", trendThreshold / 10.0f);
+            beepCurve = curve;
+            applyBeepCurve();
+            
+            LOG_INFO("RSSI filter: %s", rssiFilterName(rssiFilterType));
+            LOG_INFO("Scan responses: %s", scanResponseName(scanResponseMode));
+            LOG_INFO("Log: %s, %s", logLevelName(logLevel), logFormatName(logFormat));
+            LOG_INFO("Session recording: %s", recordSessions ? "On" : "Off");
             saveConfiguration();
             
             String responseHTML = R"html(
@@ -806,19 +686,40 @@ void startConfigMode() {
             // Schedule mode switch for 5 seconds from now
             modeSwitchScheduled = millis() + 5000;
             
-            Serial.println("Mode switch scheduled for 5 seconds from now");
-            Serial.println("==============================\n");
+            LOG_INFO("Mode switch scheduled for 5 seconds from now");
+            LOG_INFO("==============================\n");
         } else {
             request->send(400, "text/plain", "Missing target MAC");
         }
     });
     
+    // Upload an antenna-specific beep curve without touching other settings
+    server.on("/curve", HTTP_POST, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        if (rejectWhileTracking(request)) return;
+        
+        String curve = request->hasParam("curve", true) ? request->getParam("curve", true)->value() : "";
+        curve.trim();
+        if (!validBeepCurve(curve)) {
+            request->send(400, "text/plain", INVALID_CURVE_MESSAGE);
+            return;
+        }
+        
+        beepCurve = curve;
+        applyBeepCurve();
+        saveConfiguration();
+        LOG_INFO("Beep curve updated: %s", curve.length() > 0 ? curve.c_str() : "Default");
+        request->send(200, "text/plain", curve.length() > 0 ? "Custom curve saved" : "Default curve restored");
+    });
+    
     server.on("/clear", HTTP_POST, [](AsyncWebServerRequest *request){
         lastConfigActivity = millis();
+        if (rejectWhileTracking(request)) return;
         
         targetMAC = "";
+        updateTargets();
         saveConfiguration();
-        Serial.println("Target MAC cleared");
+        LOG_INFO("Target MAC cleared");
         
         request->send(200, "text/plain", "Target cleared");
     });
@@ -831,103 +732,115 @@ void startConfigMode() {
         deviceResetScheduled = millis() + 1000; // 1 second delay
     });
     
+#if FOXHUNT_METRICS
+    server.on("/metrics", HTTP_GET, [](AsyncWebServerRequest *request){
+        request->send(200, "text/plain; version=0.0.4", metricsText());
+    });
+#endif
+    
+    // Recorded hunts, decoded on the host with tools/decode_session.py
+    server.on("/sessions.json", HTTP_GET, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        request->send(200, "application/json", recorderListJSON());
+    });
+    
+    server.on("/session", HTTP_GET, [](AsyncWebServerRequest *request){
+        lastConfigActivity = millis();
+        char path[32];
+        uint32_t session = request->hasParam("n") ? request->getParam("n")->value().toInt() : 0;
+        if (!recorderPath(session, path, sizeof(path))) {
+            request->send(404, "text/plain", "No such session");
+            return;
+        }
+        // Streamed from flash in TCP-window sized pieces, never loaded whole
+        request->send(LittleFS, String(path), String("application/octet-stream"), true);
+    });
+    
+    server.on("/live", HTTP_GET, [](AsyncWebServerRequest *request){
+        sendGzipAsset(request, LIVE_HTML_GZ, LIVE_HTML_GZ_LEN, LIVE_HTML_ETAG);
+    });
+    server.addHandler(&telemetrySocket);
+    
     server.begin();
-    Serial.println("Web server started!");
+    LOG_INFO("Web server started!");
 }
 
-// BLE callback for device detection
-class MyAdvertisedDeviceCallbacks: public NimBLEAdvertisedDeviceCallbacks {
-    void onResult(NimBLEAdvertisedDevice* advertisedDevice) {
-        if (currentMode != TRACKING_MODE) return;
-        
-        String deviceMAC = advertisedDevice->getAddress().toString().c_str();
-        deviceMAC.toUpperCase();
-        
-        // Check if this is our target
-        if (deviceMAC == targetMAC) {
-            currentRSSI = advertisedDevice->getRSSI();
-            lastTargetSeen = millis();
-            
-            // Set flags for main loop to handle
-            targetDetected = true;
-            newTargetDetected = true;
-            Serial.print("DEBUG: Target detected, RSSI: ");
-            Serial.println(currentRSSI);
-        }
-    }
-};
+void startConfigMode() {
+    currentMode = CONFIG_MODE;
+    LOG_INFO("\n=== STARTING FOXHUNT CONFIG MODE ===");
+    startPortal();
+    
+    // The config timeout counts from here
+    configStartTime = millis();
+    lastConfigActivity = millis();
+    
+    // Scan everything around while the portal is up
+    startSurvey();
+}
+
+// Long press of BOOT while tracking: restart into the config portal. The hunt
+// owns the scanner and its tasks, so a clean boot is the simplest way back.
+void requestConfigPortal() {
+    LOG_INFO("Config portal requested, restarting");
+    halNvsPutBool("configPortal", true);
+    recorderStop(1000);
+    logFlush(500);
+    ESP.restart();
+}
 
 void startTrackingMode() {
-    if (targetMAC.length() == 0) {
-        Serial.println("No target MAC configured, staying in config mode");
+    if (targets.count() == 0) {
+        LOG_WARN("No target MAC configured, staying in config mode");
         return;
     }
     
     currentMode = TRACKING_MODE;
     
-    // Reset session detection flag for new hunting session
-    sessionFirstDetection = true;
-    firstDetection = true;
-    
-    // Stop the web server
-    server.end();
-    
-    Serial.println("\n==============================");
-    Serial.println("=== STARTING FOXHUNT TRACKING MODE ===");
-    Serial.print("Target MAC: ");
-    Serial.println(targetMAC);
-    Serial.println("==============================\n");
-    
-    // Initialize BLE
-    NimBLEDevice::init("");
-    NimBLEDevice::setPower(ESP_PWR_LVL_P9);
-    
-    pBLEScan = NimBLEDevice::getScan();
-    pBLEScan->setAdvertisedDeviceCallbacks(new MyAdvertisedDeviceCallbacks());
-    pBLEScan->setInterval(16);    // 16ms intervals (maximum speed)
-    pBLEScan->setWindow(15);      // 15ms scan window (95% duty cycle)
-    pBLEScan->setActiveScan(true);
-    pBLEScan->setDuplicateFilter(false);
-    
-    // Start continuous scanning
-    pBLEScan->start(0, nullptr, false);
-    
-    Serial.println("FOXHUNT REALTIME tracking started!");
+    if (!liveTelemetry && portalStarted) {
+        // Stop the web server
+        server.end();
+    }
     
-    // Play startup ready signal
-    ascendingBeeps();
+    LOG_INFO("\n==============================");
+    LOG_INFO("=== STARTING FOXHUNT TRACKING MODE ===");
+    LOG_INFO("Targets: %u", (unsigned)targets.count());
+    LOG_INFO("%s", targetMAC.c_str());
+    LOG_INFO("==============================\n");
+    
+    // Start scanning and play the ready signal, then hand detection to its own task.
+    // Flash and WiFi come after, so neither holds back the first scan.
+    trackerStart();
+    startDetectTask();
+    LOG_INFO("Boot: first scan %u ms after power-on", (unsigned)bootFirstScanMs);
+    startRecorder();
+    
+    if (liveTelemetry) {
+        // Keep the portal up so a phone can follow the hunt on /live
+        startPortal();
+        LOG_INFO("Live telemetry: http://%s/live", WiFi.softAPIP().toString().c_str());
+    }
 }
 
 void setup() {
     Serial.begin(115200);
-    Serial.println("\n=== OUI-SPY FOXHUNT MODE for Xiao ESP32 S3 ===");
-    Serial.println("Hardware: Xiao ESP32 S3");
-    Serial.println("Buzzer: GPIO3");
-    Serial.println("Target: Single MAC address");
-    Serial.println("Mode: REALTIME RSSI-based proximity beeping");
-    Serial.println("Range: 5s (WEAK) to 100ms (STRONG)");
-    Serial.println("Initializing...\n");
-    
-    // Setup buzzer - initialize to 1kHz for proximity beeps
-    ledcSetup(0, 1000, 8);  // 1kHz default frequency
-    ledcAttachPin(BUZZER_PIN, 0);
-    
-    // Setup LED (inverted logic - HIGH = OFF for Xiao ESP32-S3)
-    pinMode(LED_PIN, OUTPUT);
-    digitalWrite(LED_PIN, HIGH);
-    
-    singleBeep(); // Startup test beep
+    startLogTask();
+    LOG_INFO("\n=== OUI-SPY FOXHUNT MODE for Xiao ESP32 S3 ===");
+    LOG_INFO("Hardware: Xiao ESP32 S3");
+    LOG_INFO("Buzzer: GPIO3");
+    LOG_INFO("Targets: Up to %u MAC addresses or OUI rules", (unsigned)MAX_TARGETS);
+    LOG_INFO("Mode: REALTIME RSSI-based proximity beeping");
+    LOG_INFO("Range: 5s (WEAK) to 100ms (STRONG)");
+    LOG_INFO("Initializing...\n");
+    
+    // Buzzer, LED and beep timer
+    halInit();
     
     // STEALTH MODE: Full MAC randomization
     uint8_t newMAC[6];
     WiFi.macAddress(newMAC);
     
-    Serial.print("Original MAC: ");
-    for (int i = 0; i < 6; i++) {
-        Serial.printf("%02x", newMAC[i]);
-        if (i < 5) Serial.print(":");
-    }
-    Serial.println();
+    LOG_INFO("Original MAC: %02x:%02x:%02x:%02x:%02x:%02x",
+             newMAC[0], newMAC[1], newMAC[2], newMAC[3], newMAC[4], newMAC[5]);
     
     // STEALTH MODE: Randomize ALL 6 bytes for maximum anonymity
     randomSeed(analogRead(0) + micros());
@@ -942,23 +855,66 @@ void setup() {
     esp_wifi_set_mac(WIFI_IF_STA, newMAC);
     esp_wifi_set_mac(WIFI_IF_AP, newMAC);
     
-    Serial.print("Randomized MAC: ");
-    for (int i = 0; i < 6; i++) {
-        Serial.printf("%02x", newMAC[i]);
-        if (i < 5) Serial.print(":");
-    }
-    Serial.println();
+    LOG_INFO("Randomized MAC: %02x:%02x:%02x:%02x:%02x:%02x",
+             newMAC[0], newMAC[1], newMAC[2], newMAC[3], newMAC[4], newMAC[5]);
     
     // Load configuration
+    trackerInit();
+    detectionHook = onDetection;
+    sweepHook = onSweep;
     loadConfiguration();
     
-    // Start in configuration mode
-    startConfigMode();
+    // Fast boot: with targets saved, hunt straight away and leave the portal
+    // for a long press of BOOT. Otherwise, or when that press asked for it,
+    // start in configuration mode.
+    bool portalRequested = halNvsGetBool("configPortal", false);
+    if (portalRequested) halNvsPutBool("configPortal", false);
+    if (targets.count() > 0 && !portalRequested) {
+        LOG_INFO("Fast boot: %u saved targets, hold BOOT for the config portal", (unsigned)targets.count());
+        startTrackingMode();
+    } else {
+        playPatternBlocking(STARTUP_PATTERN); // Startup test beep
+        startConfigMode();
+    }
 }
 
-void loop() {
+// Send a coalesced telemetry frame when due; never waits on the network
+void serviceTelemetry() {
+    if (!liveTelemetry) return;
+    unsigned long now = millis();
+    
+    static unsigned long lastCleanup = 0;
+    if (now - lastCleanup >= 1000) {
+        telemetrySocket.cleanupClients();
+        lastCleanup = now;
+    }
+    
+    if (bearingPending && telemetrySocket.availableForWriteAll()) {
+        telemetrySocket.binaryAll(bearingFrame, TELEMETRY_BEARING_SIZE);
+        bearingPending = false;
+    }
+    
+    if (!telemetry.due(now, 1000 / telemetryRate)) return;
+    if (telemetrySocket.availableForWriteAll()) {
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+        size_t length = telemetry.pack(frame, now);
+        telemetrySocket.binaryAll(frame, length);
+    } else {
+        // A client is still busy with the previous frame - drop rather than queue
+        telemetry.dropFrame(now);
+    }
+}
+
+void serviceLoop() {
     unsigned long currentTime = millis();
     
+    // Apply beep commands from the detection task and advance any audio/LED pattern
+    if (currentMode == TRACKING_MODE) {
+        trackerServiceUx();
+    } else {
+        serviceToneSequencer();
+    }
+    
     // Handle scheduled mode switch
     if (modeSwitchScheduled > 0 && currentTime >= modeSwitchScheduled) {
         modeSwitchScheduled = 0;
@@ -969,74 +925,87 @@ void loop() {
     // Handle scheduled device reset
     if (deviceResetScheduled > 0 && currentTime >= deviceResetScheduled) {
         deviceResetScheduled = 0;
-        Serial.println("Device reset triggered");
+        LOG_INFO("Device reset triggered");
         
         // Clear NVS and restart
-        preferences.begin("tracker", false);
-        preferences.clear();
-        preferences.end();
+        halNvsClear();
         
-        delay(1000);
+        halDelay(1000);
+        recorderStop(1000);
+        logFlush(500);
         ESP.restart();
         return;
     }
     
     if (currentMode == CONFIG_MODE) {
+        serviceSurvey();
+        
+        // BOOT button: start the survey over
+        if (bootButton.poll(halButtonDown(), currentTime) == BUTTON_SHORT_PRESS) {
+            startSurvey();
+        }
+        
         // Check for config timeout only if no recent activity AND no connected clients
         int connectedClients = WiFi.softAPgetStationNum();
         if (currentTime - lastConfigActivity > CONFIG_TIMEOUT && connectedClients == 0) {
-            Serial.println("Configuration timeout - switching to tracking mode with saved config");
+            LOG_INFO("Configuration timeout - switching to tracking mode with saved config");
             startTrackingMode();
         }
     } 
     else if (currentMode == TRACKING_MODE) {
-        unsigned long currentTime = millis();
+        // Detections and target timeouts run on the detection task
+        if (!detectTask) {
+            trackerUpdate();
+        }
         
-        // Handle target detection messages (safe serial output)
-        if (newTargetDetected) {
-            newTargetDetected = false;
-            
-            // Only play three same-tone beeps on FIRST detection of hunting session
-            if (sessionFirstDetection) {
-                threeSameToneBeeps();
-                sessionFirstDetection = false;
-                Serial.println("TARGET ACQUIRED!");
-            } else if (firstDetection) {
-                // Silent reacquisition after loss
-                firstDetection = false;
-                Serial.println("TARGET REACQUIRED!");
-            }
+        serviceTelemetry();
+        
+        // BOOT button: a short press starts a direction-finding sweep (press
+        // again after one full turn), a long press opens the config portal
+        ButtonEvent button = bootButton.poll(halButtonDown(), currentTime);
+        if (button == BUTTON_SHORT_PRESS) {
+            trackerSweepToggle();
+        } else if (button == BUTTON_LONG_PRESS) {
+            requestConfigPortal();
+            return;
         }
         
-        // Handle proximity beeping
-        if (targetDetected && (currentTime - lastTargetSeen < 5000)) { // Target seen within last 5 seconds
-            handleProximityBeeping();
-            
-            // Print RSSI for visual fox hunting feedback (reduced frequency for real-time performance)
-            static unsigned long lastRSSIPrint = 0;
-            int printInterval = 2000; // Fixed 2-second intervals - less serial spam
-            
-            if (currentTime - lastRSSIPrint >= printInterval) {
-                Serial.print("RSSI: ");
-                Serial.print(currentRSSI);
-                Serial.println(" dBm");
-                lastRSSIPrint = currentTime;
-            }
-        } else if (currentTime - lastTargetSeen >= 5000) {
-            // Target lost - INSTANT LED OFF for maximum reactivity
-            targetDetected = false;
-            firstDetection = true; // Reset for next detection
+#if FOXHUNT_METRICS
+        // Send 'm' over Serial for a metrics dump while the portal is down
+        if (Serial.available() && Serial.read() == 'm' && metricsDump.length() == 0) {
+            metricsDump = metricsText();
+            metricsDumpOffset = 0;
+        }
+        serviceMetricsDump();
+#endif
+        
+        // Periodic telemetry and task load report
+        static unsigned long lastTelemetryReport = 0;
+        if (currentTime - lastTelemetryReport >= 30000) {
+            lastTelemetryReport = currentTime;
+#if FOXHUNT_METRICS
+            printTaskReport();
+#endif
+            printRecorderReport();
             
-            // Turn off beep and LED immediately
-            if (buzzerEnabled) {
-                ledcWrite(0, 0);
+            if (telemetry.framesDropped() != reportedTelemetryDrops) {
+                reportedTelemetryDrops = telemetry.framesDropped();
+                LOG_WARN("Telemetry: dropped %u frames, %u samples", (unsigned)reportedTelemetryDrops,
+                         (unsigned)telemetry.samplesDropped());
             }
-            ledOff();
-            isBeeping = false;
-            
-            Serial.println("TARGET LOST - Searching...");
         }
         
         return;
     }
-} 
+}
+
+void loop() {
+    METRIC_TIMER(loopStart);
+    serviceLoop();
+    METRIC_OBSERVE(metricLoopUs, loopStart);
+    
+    // Sleep until the detection task queues a command or the next pattern step
+    if (detectTask) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(UX_TASK_PERIOD_MS));
+    }
+}
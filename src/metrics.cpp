@@ -0,0 +1,169 @@
+#include "metrics.h"
+
+#if FOXHUNT_METRICS
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "tracker.h"
+#include "log.h"
+
+MetricCounter metricAdverts;
+MetricCounter metricTargetHits;
+MetricCounter metricDelayUs;
+MetricHistogram metricAdvertUs;
+MetricHistogram metricLoopUs;
+MetricHistogram metricDetectToBeepUs;
+MetricCounter metricBleBusyUs;
+MetricCounter metricDetectBusyUs;
+MetricCounter metricUxBusyUs;
+MetricHistogram metricFlashWriteUs;
+
+// Bounded appender over the caller's buffer
+struct MetricWriter {
+    char* out;
+    size_t size;
+    size_t length;
+
+    void printf(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (length + 1 >= size) return;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(out + length, size - length, format, args);
+        va_end(args);
+        if (n > 0) length += (size_t)n < size - length ? (size_t)n : size - length - 1;
+    }
+};
+
+void writeCounter(MetricWriter& writer, const char* name, const char* help, const MetricCounter& counter) {
+    writer.printf("# HELP %s %s\n# TYPE %s counter\n", name, help, name);
+    for (int core = 0; core < METRIC_CORES; core++) {
+        writer.printf("%s{core=\"%d\"} %u\n", name, core,
+                      (unsigned)counter.perCore[core].value.load(std::memory_order_relaxed));
+    }
+}
+
+void writeHistogram(MetricWriter& writer, const char* name, const char* help, const MetricHistogram& histogram) {
+    writer.printf("# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    uint32_t cumulative = 0;
+    for (int i = 0; i < METRIC_BUCKETS - 1; i++) {
+        cumulative += histogram.buckets[i].load(std::memory_order_relaxed);
+        writer.printf("%s_bucket{le=\"%u\"} %u\n", name, 1u << i, (unsigned)cumulative);
+    }
+    cumulative += histogram.buckets[METRIC_BUCKETS - 1].load(std::memory_order_relaxed);
+    writer.printf("%s_bucket{le=\"+Inf\"} %u\n", name, (unsigned)cumulative);
+    writer.printf("%s_sum %u\n%s_count %u\n", name, (unsigned)histogram.sumUs.load(std::memory_order_relaxed),
+                  name, (unsigned)histogram.count.load(std::memory_order_relaxed));
+}
+
+// Counter kept outside the per-core metrics
+void writeTotal(MetricWriter& writer, const char* name, const char* help, uint32_t value) {
+    writer.printf("# HELP %s %s\n# TYPE %s counter\n%s %u\n", name, help, name, name, (unsigned)value);
+}
+
+void writeGauge(MetricWriter& writer, const char* name, const char* help, uint32_t value) {
+    writer.printf("# HELP %s %s\n# TYPE %s gauge\n%s %u\n", name, help, name, name, (unsigned)value);
+}
+
+size_t formatMetrics(char* out, size_t size) {
+    MetricWriter writer = { out, size, 0 };
+    if (size) out[0] = '\0';
+
+    writeCounter(writer, "foxhunt_adverts_total", "Adverts delivered by the BLE scan", metricAdverts);
+    writeCounter(writer, "foxhunt_target_hits_total", "Adverts matching a target", metricTargetHits);
+    writeCounter(writer, "foxhunt_delay_us_total", "Time blocked in delay()", metricDelayUs);
+    writeHistogram(writer, "foxhunt_advert_callback_us", "Scan handler time per advert", metricAdvertUs);
+    writeHistogram(writer, "foxhunt_loop_us", "loop() iteration time", metricLoopUs);
+    writeHistogram(writer, "foxhunt_detect_to_beep_us", "Advert reception to buzzer/LED retarget", metricDetectToBeepUs);
+    writeHistogram(writer, "foxhunt_flash_write_us", "Session recorder chunk write and flush", metricFlashWriteUs);
+    writer.printf("# HELP foxhunt_task_busy_us_total CPU time per task\n# TYPE foxhunt_task_busy_us_total counter\n"
+                  "foxhunt_task_busy_us_total{task=\"ble\"} %u\nfoxhunt_task_busy_us_total{task=\"detect\"} %u\n"
+                  "foxhunt_task_busy_us_total{task=\"ux\"} %u\nfoxhunt_task_busy_us_total{task=\"loop\"} %u\n",
+                  (unsigned)metricBleBusyUs.total(), (unsigned)metricDetectBusyUs.total(),
+                  (unsigned)metricUxBusyUs.total(), (unsigned)metricLoopUs.sumUs.load(std::memory_order_relaxed));
+
+    // Beep edge jitter from the scheduler's own histogram
+    halBeepLock();
+    uint32_t jitter[BEEP_JITTER_BUCKETS];
+    for (int i = 0; i < BEEP_JITTER_BUCKETS; i++) jitter[i] = beepScheduler.jitterCount(i);
+    halBeepUnlock();
+    writer.printf("# HELP foxhunt_beep_jitter_us Beep timer edge lateness\n# TYPE foxhunt_beep_jitter_us histogram\n");
+    uint32_t cumulative = 0;
+    for (int i = 0; i < BEEP_JITTER_BUCKETS - 1; i++) {
+        cumulative += jitter[i];
+        writer.printf("foxhunt_beep_jitter_us_bucket{le=\"%u\"} %u\n", (unsigned)BEEP_JITTER_LIMITS[i], (unsigned)cumulative);
+    }
+    cumulative += jitter[BEEP_JITTER_BUCKETS - 1];
+    writer.printf("foxhunt_beep_jitter_us_bucket{le=\"+Inf\"} %u\nfoxhunt_beep_jitter_us_count %u\n",
+                  (unsigned)cumulative, (unsigned)cumulative);
+
+    writeGauge(writer, "foxhunt_targets", "Configured targets and rules", (uint32_t)targets.count());
+    writeGauge(writer, "foxhunt_boot_first_scan_ms", "Boot to the first tracking scan, 0 before it", bootFirstScanMs);
+    writeGauge(writer, "foxhunt_boot_first_acquired_ms", "Boot to the first target acquired, 0 before it",
+               bootFirstAcquiredMs);
+    writeGauge(writer, "foxhunt_ring_overflows", "Detections dropped between the BLE task and loop()",
+               detectionRing.overflows());
+    writeGauge(writer, "foxhunt_ring_high_water", "Detection ring high water mark", (uint32_t)detectionRing.highWater());
+    writeTotal(writer, "foxhunt_log_dropped_total", "Log lines lost to a full ring or the rate limit", logDropped());
+    writeGauge(writer, "foxhunt_ux_ring_overflows", "Commands dropped between the detection and UX tasks",
+               uxRing.overflows());
+    writeTotal(writer, "foxhunt_session_dropped_total", "Session events lost to a full recorder ring",
+               sessionRing.overflows());
+    writeTotal(writer, "foxhunt_rpa_aes_total", "AES blocks run resolving private addresses", irkResolver.aesCount());
+    writeTotal(writer, "foxhunt_rpa_cache_hits_total", "Private addresses resolved from the cache",
+               irkResolver.cacheHits());
+    writeGauge(writer, "foxhunt_scan_accept_list", "Targets filtered by the controller, 0 when matching on host",
+               acceptListSize);
+    writeGauge(writer, "foxhunt_scan_level", "Scan scheduler level (0 idle .. 5 close-in)", scanScheduler.level());
+    writeGauge(writer, "foxhunt_scan_adverts_per_second", "Adverts per second at the current scan duty",
+               scanScheduler.advertsPerSecond());
+    writer.printf("# HELP foxhunt_scan_current_ma Estimated average current while tracking\n"
+                  "# TYPE foxhunt_scan_current_ma gauge\nfoxhunt_scan_current_ma %.1f\n",
+                  scanScheduler.averageCurrent());
+    return writer.length;
+}
+
+// Upper bound of the bucket holding the given fraction of a window's samples
+uint32_t bucketPercentileUs(const uint32_t* counts, uint32_t total, double fraction) {
+    uint32_t rank = (uint32_t)(fraction * (total - 1)) + 1;
+    uint32_t cumulative = 0;
+    for (int i = 0; i < METRIC_BUCKETS - 1; i++) {
+        cumulative += counts[i];
+        if (cumulative >= rank) return 1u << i;
+    }
+    return UINT32_MAX;
+}
+
+void printTaskReport() {
+    static uint64_t lastUs = 0;
+    static uint32_t lastBusy[4] = {};
+    static uint32_t lastBuckets[METRIC_BUCKETS] = {};
+
+    uint64_t now = halMicros();
+    uint32_t busy[4] = { metricBleBusyUs.total(), metricDetectBusyUs.total(), metricUxBusyUs.total(),
+                         metricLoopUs.sumUs.load(std::memory_order_relaxed) };
+    uint32_t buckets[METRIC_BUCKETS];
+    uint32_t samples = 0;
+    for (int i = 0; i < METRIC_BUCKETS; i++) {
+        buckets[i] = metricDetectToBeepUs.buckets[i].load(std::memory_order_relaxed);
+        uint32_t delta = buckets[i] - lastBuckets[i];
+        lastBuckets[i] = buckets[i];
+        buckets[i] = delta;
+        samples += delta;
+    }
+
+    if (lastUs != 0 && now > lastUs) {
+        double window = (double)(now - lastUs) / 100.0; // us per percent
+        LOG_INFO("CPU: ble %.1f%%, detect %.1f%%, ux %.1f%%, loop %.1f%%",
+               (busy[0] - lastBusy[0]) / window, (busy[1] - lastBusy[1]) / window,
+               (busy[2] - lastBusy[2]) / window, (busy[3] - lastBusy[3]) / window);
+        if (samples) {
+            LOG_INFO("Detection->beep: p50 <=%uus, p99 <=%uus (%u samples)",
+                   (unsigned)bucketPercentileUs(buckets, samples, 0.50),
+                   (unsigned)bucketPercentileUs(buckets, samples, 0.99), (unsigned)samples);
+        }
+    }
+    lastUs = now;
+    for (int i = 0; i < 4; i++) lastBusy[i] = busy[i];
+}
+
+#endif
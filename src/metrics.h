@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "hal.h"
+
+// Hot-path instrumentation.
+// Counters are split per core so the BLE host task and loop() never share a
+// cache line, and timings come from the CPU cycle counter into fixed
+// power-of-two microsecond buckets. Everything is exported as Prometheus text
+// by formatMetrics(). Build with FOXHUNT_METRICS=0 to compile it all out.
+
+#ifndef FOXHUNT_METRICS
+#define FOXHUNT_METRICS 0
+#endif
+
+#define METRIC_CORES 2
+#define METRIC_CACHE_LINE 64           // Per-core counter slots are padded to this
+#define METRIC_BUCKETS 20              // <=1us, <=2us, <=4us ... <=262144us, +Inf (flash erases)
+
+#if FOXHUNT_METRICS
+
+struct MetricCounter {
+    struct alignas(METRIC_CACHE_LINE) Slot {
+        std::atomic<uint32_t> value;
+    };
+    Slot perCore[METRIC_CORES];
+
+    void add(uint32_t n) {
+        perCore[halCoreId() % METRIC_CORES].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint32_t total() const {
+        uint32_t sum = 0;
+        for (int i = 0; i < METRIC_CORES; i++) sum += perCore[i].value.load(std::memory_order_relaxed);
+        return sum;
+    }
+};
+
+struct MetricHistogram {
+    std::atomic<uint32_t> buckets[METRIC_BUCKETS];
+    std::atomic<uint32_t> count;
+    std::atomic<uint32_t> sumUs;       // Wraps like any 32-bit counter
+
+    void observeCycles(uint32_t cycles) {
+        observeUs(cycles / halCyclesPerUs());
+    }
+
+    void observeUs(uint32_t us) {
+        int bucket = us <= 1 ? 0 : 32 - __builtin_clz(us - 1);
+        if (bucket >= METRIC_BUCKETS) bucket = METRIC_BUCKETS - 1;
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sumUs.fetch_add(us, std::memory_order_relaxed);
+    }
+};
+
+extern MetricCounter metricAdverts;         // Adverts delivered by the scan
+extern MetricCounter metricTargetHits;      // Adverts matching a target
+extern MetricCounter metricDelayUs;         // Time blocked in halDelay()
+extern MetricHistogram metricAdvertUs;      // Scan handler time per advert
+extern MetricHistogram metricLoopUs;        // loop() iteration time
+extern MetricHistogram metricDetectToBeepUs; // Advert reception to buzzer/LED retarget
+extern MetricCounter metricBleBusyUs;       // CPU time per task, for the utilisation report
+extern MetricCounter metricDetectBusyUs;
+extern MetricCounter metricUxBusyUs;
+extern MetricHistogram metricFlashWriteUs;  // Session recorder chunk write + flush
+
+// Log CPU share per task and detection->beep latency since the last call
+void printTaskReport();
+
+// Write all metrics as Prometheus text; returns the length (truncated to size - 1)
+size_t formatMetrics(char* out, size_t size);
+
+#define METRIC_COUNT(counter) (counter).add(1)
+#define METRIC_ADD(counter, n) (counter).add(n)
+#define METRIC_TIMER(name) uint32_t name = halCycles()
+#define METRIC_OBSERVE(histogram, name) (histogram).observeCycles(halCycles() - (name))
+#define METRIC_OBSERVE_US(histogram, us) (histogram).observeUs(us)
+// Rounded rather than truncated so short, frequent calls still add up
+#define METRIC_BUSY(counter, name) (counter).add((halCycles() - (name) + halCyclesPerUs() / 2) / halCyclesPerUs())
+
+#else
+
+#define METRIC_COUNT(counter) ((void)0)
+#define METRIC_ADD(counter, n) ((void)0)
+#define METRIC_TIMER(name) ((void)0)
+#define METRIC_OBSERVE(histogram, name) ((void)0)
+#define METRIC_OBSERVE_US(histogram, us) ((void)0)
+#define METRIC_BUSY(counter, name) ((void)0)
+
+#endif
@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <map>
+#include <set>
+#include <string>
+#include "hal_native.h"
+#include "soft_aes.h"
+#include "../tracker.h"
+#include "../metrics.h"
+
+// Simulated implementation of hal.h for the native (Linux) build
+
+#define SIM_SCAN_EXCHANGE_US 600        // SCAN_REQ + SCAN_RSP with inter-frame spaces
+#define SIM_ACCEPT_LIST_SIZE 12         // ESP32-S3 controller filter entries
+#define SIM_ADV_IND 0
+#define SIM_ADV_SCAN_IND 2
+
+uint64_t simNow = 0;                // Simulated time in us
+uint64_t simTimerDue = 0;           // Beep timer expiry, 0 when disarmed
+bool simScanning = false;
+HalAdvertHandler simHandler = nullptr;
+HalScanParams simScan = {};
+uint64_t simScanStart = 0;
+uint64_t simRadioBusyUntil = 0;     // End of the current scan request exchange
+uint8_t simResponseLoss = 10;
+uint32_t simLossSeed = 1;
+std::set<uint64_t> simAcceptList;
+bool simAcceptListActive = false;
+uint32_t simBuzzerDuty = 0;
+uint64_t simBuzzerSince = 0;
+bool simLed = false;
+bool simButton = false;
+bool simQuiet = false;
+HalSimStats simStats = {};
+std::map<std::string, std::string> simNvs;
+
+void halInit() {
+}
+
+uint32_t halMillis() {
+    return (uint32_t)(simNow / 1000);
+}
+
+uint64_t halMicros() {
+    return simNow;
+}
+
+void halDelay(uint32_t ms) {
+    METRIC_ADD(metricDelayUs, ms * 1000);
+    halSimAdvance((uint64_t)ms * 1000);
+}
+
+// Host nanoseconds stand in for cycles so timings are real, not simulated
+uint32_t halCycles() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t halCyclesPerUs() {
+    return 1000;
+}
+
+uint8_t halCoreId() {
+    return 0;
+}
+
+void halBuzzer(uint32_t frequency, uint32_t duty) {
+    if (duty && !simBuzzerDuty) {
+        simStats.buzzerEdges++;
+        simStats.lastBuzzerOnUs = simNow;
+        simBuzzerSince = simNow;
+    } else if (!duty && simBuzzerDuty) {
+        simStats.buzzerOnUs += simNow - simBuzzerSince;
+    }
+    simBuzzerDuty = duty;
+}
+
+void halLed(bool on) {
+    if (on && !simLed) simStats.ledEdges++;
+    simLed = on;
+}
+
+bool halButtonDown() {
+    return simButton;
+}
+
+void halBeepTimerArm(uint64_t delayUs) {
+    simTimerDue = simNow + delayUs;
+}
+
+void halBeepTimerStop() {
+    simTimerDue = 0;
+}
+
+// Single-threaded: the timer only fires from halSimAdvance()
+void halBeepLock() {
+}
+
+void halBeepUnlock() {
+}
+
+void halAes128(const uint8_t key[16], const uint8_t input[16], uint8_t output[16]) {
+    softAes128Encrypt(key, input, output);
+}
+
+void* halAllocLarge(size_t bytes) {
+    return malloc(bytes);
+}
+
+std::string halNvsGetString(const char* key, const char* defaultValue) {
+    auto it = simNvs.find(key);
+    return it != simNvs.end() ? it->second : std::string(defaultValue);
+}
+
+void halNvsPutString(const char* key, const std::string& value) {
+    simNvs[key] = value;
+}
+
+bool halNvsGetBool(const char* key, bool defaultValue) {
+    auto it = simNvs.find(key);
+    return it != simNvs.end() ? it->second == "1" : defaultValue;
+}
+
+void halNvsPutBool(const char* key, bool value) {
+    simNvs[key] = value ? "1" : "0";
+}
+
+uint8_t halNvsGetU8(const char* key, uint8_t defaultValue) {
+    auto it = simNvs.find(key);
+    return it != simNvs.end() ? (uint8_t)atoi(it->second.c_str()) : defaultValue;
+}
+
+void halNvsPutU8(const char* key, uint8_t value) {
+    simNvs[key] = std::to_string(value);
+}
+
+void halNvsClear() {
+    simNvs.clear();
+}
+
+void halScanStart(const HalScanParams& params, HalAdvertHandler handler) {
+    simHandler = handler;
+    simScan = params;
+    simScanStart = simNow;
+    simScanning = true;
+    simStats.scanRestarts++;
+}
+
+bool halScanSetAcceptList(const uint64_t* addresses, size_t count) {
+    simAcceptList.clear();
+    simAcceptListActive = false;
+    // Public and random entries per address, as on the device
+    if (count * 2 > SIM_ACCEPT_LIST_SIZE) return false;
+    simAcceptList.insert(addresses, addresses + count);
+    simAcceptListActive = count > 0;
+    return true;
+}
+
+void halScanStop() {
+    simHandler = nullptr;
+    simScanning = false;
+}
+
+void halLogWrite(const uint8_t* data, size_t length) {
+    simStats.logBytes += length;
+    simStats.logWrites++;
+    if (simQuiet) return;
+    printf("[%8.3f] ", simNow / 1e6);
+    fwrite(data, 1, length, stdout);
+}
+
+void halSimAdvance(uint64_t us) {
+    uint64_t end = simNow + us;
+    while (simTimerDue != 0 && simTimerDue <= end) {
+        simNow = simTimerDue;
+        simTimerDue = 0;
+        trackerBeepEdge();
+    }
+    simNow = end;
+}
+
+void halSimAdvert(const HalAdvert& advert) {
+    if (!simScanning || !simHandler) return;
+    simStats.advertsOffered++;
+
+    // The receiver listens for windowMs at the start of every intervalMs
+    uint64_t interval = (uint64_t)simScan.intervalMs * 1000;
+    uint64_t window = (uint64_t)simScan.windowMs * 1000;
+    if (interval && (simNow - simScanStart) % interval >= window) return;
+
+    if (simNow < simRadioBusyUntil) return;
+    if (simAcceptListActive && !simAcceptList.count(advert.address)) {
+        simStats.controllerFiltered++;
+        return;
+    }
+    simStats.hostReports++;
+
+    if (simScan.active && (advert.advType == SIM_ADV_IND || advert.advType == SIM_ADV_SCAN_IND)) {
+        simStats.scanRequests++;
+        simRadioBusyUntil = simNow + SIM_SCAN_EXCHANGE_US;
+        simLossSeed = simLossSeed * 1664525u + 1013904223u;
+        if ((simLossSeed >> 16) % 100 < simResponseLoss) {
+            // NimBLE holds the result until the response, which never comes
+            simStats.responsesLost++;
+            return;
+        }
+        simStats.hostReports++;
+    }
+
+    simStats.advertsDelivered++;
+    simHandler(advert);
+}
+
+void halSimScanResponseLoss(uint8_t percent) {
+    simResponseLoss = percent;
+}
+
+bool halSimScanning() {
+    return simScanning;
+}
+
+const HalSimStats& halSimStats() {
+    return simStats;
+}
+
+void halSimQuiet(bool quiet) {
+    simQuiet = quiet;
+}
+
+void halSimButton(bool down) {
+    simButton = down;
+}
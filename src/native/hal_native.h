@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include "../hal.h"
+
+// Host-side controls for the simulated HAL (native/hal_native.cpp).
+// Time only moves when the driver advances it; due beep timer edges fire
+// from inside halSimAdvance() exactly at their scheduled time.
+
+// Advance the simulated clock, firing beep timer edges on the way
+void halSimAdvance(uint64_t us);
+
+// Offer an advert on air; it reaches the scan handler only if the simulated
+// scan window is open at the current time. While scanning actively, a
+// scannable advert (ADV_IND, ADV_SCAN_IND) gets a scan request and, like
+// NimBLE, is reported only once its scan response arrives; the exchange keeps
+// the receiver busy for SIM_SCAN_EXCHANGE_US. With an accept list set, only
+// listed addresses get past the controller.
+void halSimAdvert(const HalAdvert& advert);
+
+// Percentage of scan responses lost to collisions (default 10)
+void halSimScanResponseLoss(uint8_t percent);
+
+// Hold (true) or release the simulated BOOT button
+void halSimButton(bool down);
+
+// True while halScanStart() is in effect
+bool halSimScanning();
+
+// Buzzer/LED edge counters since start
+struct HalSimStats {
+    uint32_t buzzerEdges;     // Silent -> sounding transitions
+    uint32_t ledEdges;        // Off -> on transitions
+    uint64_t buzzerOnUs;      // Total time sounding
+    uint64_t lastBuzzerOnUs;  // Time of the most recent silent -> sounding transition
+    uint32_t advertsOffered;  // Adverts on air while scanning
+    uint32_t advertsDelivered;// Adverts passed to the scan handler
+    uint32_t scanRequests;    // Scan requests sent to scannable adverts
+    uint32_t responsesLost;   // Scan requests whose response never arrived
+    uint32_t hostReports;     // Advertising reports from the controller, scan responses included
+    uint32_t controllerFiltered; // Adverts dropped by the controller accept list
+    uint32_t scanRestarts;    // halScanStart() calls
+    uint64_t logBytes;        // Bytes passed to halLogWrite(), quiet or not
+    uint32_t logWrites;       // halLogWrite() calls, one per line
+};
+const HalSimStats& halSimStats();
+
+// Suppress log output (benchmarks)
+void halSimQuiet(bool quiet);
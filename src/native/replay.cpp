@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "replay.h"
+#include "hal_native.h"
+#include "../advert_capture.h"
+#include "../target_match.h"
+#include "../tracker.h"
+#include "../log.h"
+
+#define REPLAY_TICK_US 1000
+#define SYNTH_TARGET_PERIOD_US 100000     // Target advertises at 10 Hz
+#define SYNTH_TARGET_CYCLE_US 8000000     // In range 2s of every 8s, longer than TARGET_TIMEOUT away
+#define SYNTH_TARGET_PRESENT_US 2000000
+#define SYNTH_DEVICES_PER_KHZ 50          // Background population scales with the advert rate
+
+// Advertising PDU types
+static const uint8_t SYNTH_ADV_TYPES[] = { 0, 2, 3 };   // ADV_IND, ADV_SCAN_IND, ADV_NONCONN_IND
+
+typedef std::chrono::steady_clock ReplayClock;
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0;
+    size_t index = (size_t)(fraction * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+bool anyTargetDetected() {
+    for (size_t i = 0; i < targets.count(); i++) {
+        if (targets[i].detected) return true;
+    }
+    return false;
+}
+
+bool replayCapture(const uint8_t* data, size_t length, bool realtime, ReplayStats& stats) {
+    CaptureReader reader(data, length);
+    if (!reader.valid()) return false;
+
+    stats = ReplayStats();
+    std::vector<double> callbackNs;
+    std::vector<double> beepLatencyMs;
+    std::vector<double> tickUs;
+    uint32_t startOverflows = detectionRing.overflows();
+    uint32_t startUxOverflows = uxRing.overflows();
+
+    trackerStart();
+    // Let the ready signal finish so it does not mask the first acquisition
+    while (toneSequencer.active()) {
+        halSimAdvance(REPLAY_TICK_US);
+        trackerServiceUx();
+    }
+
+    uint64_t base = halMicros();
+    uint64_t tickEnd = base + REPLAY_TICK_US;
+    uint64_t acquireTime = 0;   // Simulated time of a pending acquisition, 0 if none
+    uint64_t lastHit = 0;       // Simulated time of the last target advert on air
+    uint32_t buzzerEdges = halSimStats().buzzerEdges;
+    HalSimStats simStart = halSimStats();
+    ReplayClock::time_point wallStart = ReplayClock::now();
+
+    CaptureRecord record;
+    bool more = reader.next(record);
+    while (more) {
+        // Deliver this tick's adverts at their capture timestamps
+        while (more && base + record.timestamp < tickEnd) {
+            uint64_t at = base + record.timestamp;
+            if (at > halMicros()) halSimAdvance(at - halMicros());
+
+            bool hit = targets.match(record.advert.address) != nullptr;
+            if (hit) {
+                if (acquireTime != 0 && at - lastHit >= (uint64_t)TARGET_TIMEOUT * 1000) {
+                    // Target came and went without ever being detected
+                    stats.missed++;
+                    acquireTime = 0;
+                }
+                if (acquireTime == 0 && !anyTargetDetected()) {
+                    acquireTime = halMicros();
+                    buzzerEdges = halSimStats().buzzerEdges;
+                }
+                lastHit = at;
+            }
+
+            // Time only adverts that reach the handler; the rest never leave the controller
+            uint32_t delivered = halSimStats().advertsDelivered;
+            ReplayClock::time_point before = ReplayClock::now();
+            halSimAdvert(record.advert);
+            ReplayClock::time_point after = ReplayClock::now();
+            if (halSimStats().advertsDelivered != delivered) {
+                double ns = std::chrono::duration<double, std::nano>(after - before).count();
+                callbackNs.push_back(ns);
+                stats.callbackTotalMs += ns / 1e6;
+            }
+
+            stats.adverts++;
+            if (hit) stats.hits++;
+            stats.simSeconds = record.timestamp / 1e6;
+            more = reader.next(record);
+        }
+
+        // One detection task and one UX task pass per tick. Log lines written
+        // inline stall the pass as a blocking UART write would.
+        halSimAdvance(tickEnd - halMicros());
+        uint64_t logBytes = halSimStats().logBytes;
+        ReplayClock::time_point before = ReplayClock::now();
+        trackerUpdate();
+        ReplayClock::time_point middle = ReplayClock::now();
+        trackerServiceUx();
+        ReplayClock::time_point after = ReplayClock::now();
+        stats.updateTotalMs += std::chrono::duration<double, std::milli>(middle - before).count();
+        stats.uxTotalMs += std::chrono::duration<double, std::milli>(after - middle).count();
+        double uartUs = (halSimStats().logBytes - logBytes) * 10 * 1e6 / SYNTH_UART_BAUD;
+        tickUs.push_back(std::chrono::duration<double, std::micro>(after - before).count() + uartUs);
+
+        // The log task's turn, off the tracking path
+        if (logDeferred) logDrain(LOG_RING_SIZE);
+        tickEnd += REPLAY_TICK_US;
+
+        const HalSimStats& sim = halSimStats();
+        if (acquireTime != 0 && sim.buzzerEdges != buzzerEdges) {
+            beepLatencyMs.push_back((sim.lastBuzzerOnUs - acquireTime) / 1000.0);
+            acquireTime = 0;
+        }
+
+        if (realtime) {
+            std::this_thread::sleep_until(wallStart + std::chrono::microseconds(halMicros() - base));
+        }
+    }
+
+    stats.wallSeconds = std::chrono::duration<double>(ReplayClock::now() - wallStart).count();
+    stats.advertsPerSecond = stats.wallSeconds > 0 ? stats.adverts / stats.wallSeconds : 0;
+    stats.callbackP50Ns = percentile(callbackNs, 0.50);
+    stats.callbackP99Ns = percentile(callbackNs, 0.99);
+    stats.callbackMaxNs = callbackNs.empty() ? 0 : *std::max_element(callbackNs.begin(), callbackNs.end());
+    stats.acquisitions = (uint32_t)beepLatencyMs.size();
+    stats.beepLatencyP50Ms = percentile(beepLatencyMs, 0.50);
+    stats.beepLatencyP99Ms = percentile(beepLatencyMs, 0.99);
+    stats.beepLatencyMaxMs = beepLatencyMs.empty() ? 0 : *std::max_element(beepLatencyMs.begin(), beepLatencyMs.end());
+    double tickTotalUs = 0;
+    for (double us : tickUs) tickTotalUs += us;
+    stats.tickMeanUs = tickUs.empty() ? 0 : tickTotalUs / tickUs.size();
+    stats.tickP999Us = percentile(tickUs, 0.999);
+    stats.tickMaxUs = tickUs.empty() ? 0 : *std::max_element(tickUs.begin(), tickUs.end());
+    stats.logLines = halSimStats().logWrites - simStart.logWrites;
+    stats.logBytes = halSimStats().logBytes - simStart.logBytes;
+    stats.ringOverflows = detectionRing.overflows() - startOverflows;
+    stats.uxOverflows = uxRing.overflows() - startUxOverflows;
+    stats.delivered = halSimStats().advertsDelivered - simStart.advertsDelivered;
+    stats.scanRequests = halSimStats().scanRequests - simStart.scanRequests;
+    stats.hostReports = halSimStats().hostReports - simStart.hostReports;
+    stats.controllerFiltered = halSimStats().controllerFiltered - simStart.controllerFiltered;
+    stats.averageCurrentMa = scanScheduler.averageCurrent();
+
+    // Let the session go quiet before the next replay
+    halScanStop();
+    setBeepInterval(BEEP_SILENT);
+    return true;
+}
+
+// Small deterministic PRNG so generated captures are reproducible
+struct SynthRandom {
+    uint32_t state;
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    uint32_t below(uint32_t n) { return next() % n; }
+};
+
+struct SynthDevice {
+    uint64_t address;
+    uint8_t addressType;
+    uint8_t advType;
+    int8_t rssi;
+    uint8_t payloadLength;
+    uint8_t payload[ADVERT_MAX_PAYLOAD];
+};
+
+std::vector<uint8_t> generateCapture(uint32_t advertsPerSecond, uint32_t durationMs, uint32_t seed) {
+    SynthRandom random = { seed ? seed : 1 };
+
+    // Background devices: connectable, scannable and non-connectable, with
+    // flags plus manufacturer data of varying length
+    size_t deviceCount = std::max<size_t>(1, (size_t)advertsPerSecond * SYNTH_DEVICES_PER_KHZ / 1000);
+    std::vector<SynthDevice> devices(deviceCount);
+    for (SynthDevice& device : devices) {
+        device.address = ((uint64_t)random.next() << 16 | random.below(0x10000)) & MAC_MASK_FULL;
+        device.addressType = random.below(2);
+        device.advType = SYNTH_ADV_TYPES[random.below(sizeof(SYNTH_ADV_TYPES))];
+        device.rssi = (int8_t)(-100 + (int)random.below(60));
+        uint8_t mfgLength = 3 + random.below(ADVERT_MAX_PAYLOAD - 6);  // 3..27, payload fits 31 bytes
+        device.payload[0] = 2;
+        device.payload[1] = 0x01;
+        device.payload[2] = 0x06;
+        device.payload[3] = mfgLength;
+        device.payload[4] = 0xFF;
+        for (uint8_t i = 1; i < mfgLength; i++) device.payload[4 + i] = (uint8_t)random.next();
+        device.payloadLength = 4 + mfgLength;
+    }
+
+    uint64_t targetKey = 0, targetMask = 0;
+    parseMACRule(SYNTH_TARGET, sizeof(SYNTH_TARGET) - 1, targetKey, targetMask);
+    static const uint8_t TARGET_PAYLOAD[] = { 2, 0x01, 0x06 };
+
+    std::vector<uint8_t> capture(ADVERT_CAPTURE_HEADER_SIZE);
+    encodeCaptureHeader(capture.data());
+
+    uint64_t end = (uint64_t)durationMs * 1000;
+    uint64_t backgroundPeriod = advertsPerSecond ? 1000000ULL / advertsPerSecond : end + 1;
+    uint64_t nextBackground = random.below((uint32_t)std::min<uint64_t>(backgroundPeriod, 1000000) + 1);
+    uint64_t nextTarget = SYNTH_TARGET_PERIOD_US / 2;
+    uint8_t record[ADVERT_RECORD_MAX_SIZE];
+
+    while (nextBackground < end || nextTarget < end) {
+        HalAdvert advert = {};
+        uint64_t timestamp;
+        if (nextTarget <= nextBackground) {
+            timestamp = nextTarget;
+            nextTarget += SYNTH_TARGET_PERIOD_US - 5000 + random.below(10000);
+            if (timestamp % SYNTH_TARGET_CYCLE_US >= SYNTH_TARGET_PRESENT_US) continue;
+            advert.address = targetKey;
+            advert.advType = SYNTH_ADV_TYPES[0];
+            advert.rssi = (int8_t)(-80 + (int)random.below(30));
+            advert.payload = TARGET_PAYLOAD;
+            advert.payloadLength = sizeof(TARGET_PAYLOAD);
+        } else {
+            timestamp = nextBackground;
+            nextBackground += backgroundPeriod / 2 + random.below((uint32_t)backgroundPeriod + 1);
+            const SynthDevice& device = devices[random.below((uint32_t)deviceCount)];
+            advert.address = device.address;
+            advert.addressType = device.addressType;
+            advert.advType = device.advType;
+            advert.rssi = (int8_t)(device.rssi + (int)random.below(7) - 3);
+            advert.payload = device.payload;
+            advert.payloadLength = device.payloadLength;
+        }
+        size_t size = encodeCaptureRecord(timestamp, advert, record);
+        capture.insert(capture.end(), record, record + size);
+    }
+    return capture;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Advert capture replay and synthetic capture generation (native build).
+// Replay feeds each record to the registered scan handler, the same path
+// NimBLE results take on the device, and steps the detection and UX sides of
+// the tracking core on a 1 ms simulated tick.
+
+#define SYNTH_TARGET "AA:BB:CC:DD:EE:FF"   // Target present in synthetic captures
+#define SYNTH_UART_BAUD 115200             // Serial log bytes written inline block this long
+
+struct ReplayStats {
+    uint32_t adverts;            // Records offered on air
+    uint32_t hits;               // Records matching a target
+    double simSeconds;           // Capture duration
+    double wallSeconds;          // Host time spent replaying
+    double advertsPerSecond;     // Records processed per host second
+    double callbackP50Ns;        // Scan handler time per advert
+    double callbackP99Ns;
+    double callbackMaxNs;
+    double callbackTotalMs;      // Host time spent in the scan handler (BLE task)
+    double updateTotalMs;        // Host time spent in trackerUpdate() (detection task)
+    double uxTotalMs;            // Host time spent in trackerServiceUx() (UX task)
+    double tickMeanUs;           // Detection + UX pass per tick, host time plus UART blocking
+    double tickP999Us;
+    double tickMaxUs;
+    uint32_t logLines;           // Log lines written out
+    uint64_t logBytes;
+    uint32_t acquisitions;       // Detections while no target was in range
+    double beepLatencyP50Ms;     // Acquisition advert -> first buzzer edge (simulated time)
+    double beepLatencyP99Ms;
+    double beepLatencyMaxMs;
+    uint32_t missed;             // Target appearances never detected
+    uint32_t ringOverflows;      // Detections lost between the handler and the detection task
+    uint32_t uxOverflows;        // Commands lost between the detection and UX tasks
+    uint32_t delivered;          // Scan handler callbacks
+    uint32_t scanRequests;       // Scan requests sent (active scanning)
+    uint32_t hostReports;        // Controller advertising reports, scan responses included
+    uint32_t controllerFiltered; // Adverts dropped by the controller accept list
+    float averageCurrentMa;      // Scan scheduler estimate over the replay
+};
+
+// Replay a capture; realtime paces delivery to the host clock, otherwise it
+// runs as fast as possible. Returns false if the capture header is invalid.
+bool replayCapture(const uint8_t* data, size_t length, bool realtime, ReplayStats& stats);
+
+// Generate a capture of background devices at the given aggregate advert
+// rate plus SYNTH_TARGET (connectable) at 10 Hz, coming and going so it is
+// reacquired
+std::vector<uint8_t> generateCapture(uint32_t advertsPerSecond, uint32_t durationMs, uint32_t seed);
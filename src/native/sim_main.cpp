@@ -0,0 +1,1839 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <unordered_map>
+#include <math.h>
+#include "hal_native.h"
+#include "replay.h"
+#include "../advert_capture.h"
+#include "../tracker.h"
+#include "../target_match.h"
+#include "../telemetry.h"
+#include "../metrics.h"
+#include "../log.h"
+
+// Native foxhunt simulator.
+//
+// Usage:
+//   foxhunt_sim [walk] [filter]        Walk a target up to the antenna and print
+//                                      the beep cadence (filter: none, ema, median, kalman)
+//   foxhunt_sim gen RATE SECONDS FILE  Write a synthetic capture at RATE adverts/s
+//   foxhunt_sim replay FILE [--realtime] [--targets LIST] [--verbose] [--metrics]
+//                                      Replay a capture and print benchmark stats
+//   foxhunt_sim bench                  Benchmark synthetic 10, 1k and 50k adverts/s mixes
+//   foxhunt_sim keybench               ns/advert of the target match, String compare vs packed key
+//   foxhunt_sim tablebench             Scan callback latency with 1 to 256 targets
+//   foxhunt_sim matchbench             OUI/wildcard rule matching vs a linear scan: check and ns/advert
+//   foxhunt_sim scanbench              Detection latency and estimated current per scan policy
+//                                      and per scan response mode
+//   foxhunt_sim curvetest              Beep curve table and parser checks; exits 1 on a failure
+//   foxhunt_sim seqtest                Pattern sequencer step timing; exits 1 on a wrong edge
+//   foxhunt_sim telemetrybench         Live telemetry batching, backpressure and drops under a flood
+//   foxhunt_sim acceptbench            Host load under a flood, controller filter vs host matching
+//   foxhunt_sim rssibench              RSSI filter settling time and variance on step and noise traces,
+//                                      median rounding check; exits 1 on a failure
+//   foxhunt_sim irkbench               RPA resolutions/s with and without the address cache
+//   foxhunt_sim sigbench               Payload signature matching throughput for 1, 50 and 500 rules
+//   foxhunt_sim taskbench              Host time per task context and beep latency under load
+//   foxhunt_sim logbench               Tick latency with logging off, inline, ring-buffered and binary
+//   foxhunt_sim sweepbench             Sweep bearing error on synthetic antenna patterns, check
+//                                      that samples before begin() are dropped; exits 1 on a failure
+//   foxhunt_sim trendbench             Warmer/colder flip latency after direction reversals
+//   foxhunt_sim surveybench            Survey sketch accuracy, cost and memory vs device count
+//   foxhunt_sim recbench [FILE]        Session recorder volume and detection cost; FILE gets
+//                                      the 10 Hz run as a session file for decode_session.py
+//   foxhunt_sim bootbench              Power-on to first scan and first acquisition per boot path
+
+#define SIM_DURATION_MS 60000
+#define SIM_ADVERT_PERIOD_MS 100
+#define SIM_REPORT_PERIOD_MS 5000
+#define SIM_TARGET "AA:BB:CC:DD:EE:FF"
+#define SIM_TARGET_KEY 0xAABBCCDDEEFFULL
+#define SIM_OTHER_KEY 0x112233445566ULL
+
+// Deterministic noise so runs are comparable
+uint32_t simSeed = 12345;
+
+int simNoise(int amplitude) {
+    simSeed = simSeed * 1664525u + 1013904223u;
+    return (int)((simSeed >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+// True RSSI along the walk: -100 dBm at the start, -20 dBm at the end
+int simTrueRssi(uint32_t ms) {
+    return -100 + (int)(80LL * ms / SIM_DURATION_MS);
+}
+
+int runWalk(const char* filter) {
+    if (filter) {
+        for (uint8_t i = 0; i < RSSI_FILTER_COUNT; i++) {
+            if (strcasecmp(filter, rssiFilterName(i)) == 0) rssiFilterType = i;
+        }
+    }
+
+    halSimQuiet(true);
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+    playPatternBlocking(STARTUP_PATTERN);
+    trackerStart();
+
+    printf("Filter: %s\n", rssiFilterName(rssiFilterType));
+    printf("%8s %8s %9s %10s %8s %9s\n", "time_s", "rssi", "filtered", "interval", "beeps", "on_ms");
+
+    uint32_t lastReportEdges = 0;
+    uint64_t lastReportOnUs = 0;
+    for (uint32_t ms = 0; ms < SIM_DURATION_MS; ms++) {
+        if (ms % SIM_ADVERT_PERIOD_MS == 0) {
+            HalAdvert advert = {};
+            advert.address = SIM_TARGET_KEY;
+            advert.rssi = (int8_t)(simTrueRssi(ms) + simNoise(6));
+            halSimAdvert(advert);
+
+            // Unrelated device that must never match
+            advert.address = SIM_OTHER_KEY;
+            advert.rssi = -40;
+            halSimAdvert(advert);
+        }
+
+        trackerUpdate();
+        trackerServiceUx();
+        halSimAdvance(1000);
+
+        if ((ms + 1) % SIM_REPORT_PERIOD_MS == 0) {
+            const HalSimStats& stats = halSimStats();
+            uint32_t interval = beepScheduler.currentInterval();
+            char intervalText[16];
+            if (interval == BEEP_SOLID) {
+                snprintf(intervalText, sizeof(intervalText), "solid");
+            } else if (interval == BEEP_SILENT) {
+                snprintf(intervalText, sizeof(intervalText), "silent");
+            } else {
+                snprintf(intervalText, sizeof(intervalText), "%ums", (unsigned)(interval / 1000));
+            }
+            printf("%8.1f %8d %9d %10s %8u %9u\n", (ms + 1) / 1000.0, simTrueRssi(ms),
+                   targets[0].filteredRssi, intervalText,
+                   (unsigned)(stats.buzzerEdges - lastReportEdges),
+                   (unsigned)((stats.buzzerOnUs - lastReportOnUs) / 1000));
+            lastReportEdges = stats.buzzerEdges;
+            lastReportOnUs = stats.buzzerOnUs;
+        }
+    }
+
+    printf("Beep edge jitter max: %u us\n", (unsigned)beepScheduler.maxJitter());
+    return 0;
+}
+
+void printReplayHeader() {
+    printf("%10s %9s %7s %12s %9s %9s %9s %6s %9s %9s %9s\n", "adverts", "sim_s", "hits", "adverts/s",
+           "cb_p50ns", "cb_p99ns", "cb_maxns", "acq", "beep_p50", "beep_p99", "overflow");
+}
+
+void printReplayStats(const ReplayStats& stats) {
+    printf("%10u %9.1f %7u %12.0f %9.0f %9.0f %9.0f %6u %7.1fms %7.1fms %9u\n", (unsigned)stats.adverts,
+           stats.simSeconds, (unsigned)stats.hits, stats.advertsPerSecond, stats.callbackP50Ns,
+           stats.callbackP99Ns, stats.callbackMaxNs, (unsigned)stats.acquisitions, stats.beepLatencyP50Ms,
+           stats.beepLatencyP99Ms, (unsigned)stats.ringOverflows);
+}
+
+int runGenerate(uint32_t rate, uint32_t seconds, const char* path) {
+    std::vector<uint8_t> capture = generateCapture(rate, seconds * 1000, rate);
+    FILE* file = fopen(path, "wb");
+    if (!file || fwrite(capture.data(), 1, capture.size(), file) != capture.size()) {
+        fprintf(stderr, "Unable to write %s\n", path);
+        if (file) fclose(file);
+        return 1;
+    }
+    fclose(file);
+    printf("Wrote %zu bytes to %s\n", capture.size(), path);
+    return 0;
+}
+
+int runReplay(const char* path, bool realtime, const char* targetList, bool verbose, bool metrics) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Unable to open %s\n", path);
+        return 1;
+    }
+    std::vector<uint8_t> capture;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) capture.insert(capture.end(), buffer, buffer + n);
+    fclose(file);
+
+    halSimQuiet(!verbose);
+    if (verbose) logLevel = LOG_LEVEL_DEBUG;
+    trackerSetTargets(targetList, strlen(targetList));
+    ReplayStats stats;
+    if (!replayCapture(capture.data(), capture.size(), realtime, stats)) {
+        fprintf(stderr, "%s is not an advert capture\n", path);
+        return 1;
+    }
+    printReplayHeader();
+    printReplayStats(stats);
+#if FOXHUNT_METRICS
+    if (metrics) {
+        static char text[12288];
+        formatMetrics(text, sizeof(text));
+        fputs(text, stdout);
+    }
+#endif
+    return 0;
+}
+
+int runBench() {
+    static const uint32_t RATES[] = { 10, 1000, 50000 };
+    halSimQuiet(true);
+    trackerSetTargets(SYNTH_TARGET, strlen(SYNTH_TARGET));
+
+    printf("%8s ", "rate");
+    printReplayHeader();
+    for (uint32_t rate : RATES) {
+        std::vector<uint8_t> capture = generateCapture(rate, 30000, rate);
+        ReplayStats stats;
+        replayCapture(capture.data(), capture.size(), false, stats);
+        printf("%8u ", (unsigned)rate);
+        printReplayStats(stats);
+    }
+    return 0;
+}
+
+#define KEY_BENCH_ADVERTS 2000000
+#define KEY_BENCH_DEVICES 4096
+
+// The scan callback's match before the packed key: NimBLEAddress::toString()
+// copied into an Arduino String, upper-cased and compared with targetMAC
+bool keyBenchStringMatch(const uint8_t* native, const std::string& targetMAC) {
+    char text[18];
+    snprintf(text, sizeof(text), "%02x:%02x:%02x:%02x:%02x:%02x", native[5], native[4], native[3], native[2],
+             native[1], native[0]);
+    std::string address(text);
+    std::string deviceMAC(address.c_str());
+    for (char& c : deviceMAC) c = (char)toupper((unsigned char)c);
+    return deviceMAC == targetMAC;
+}
+
+// ns per advert for the single-target match, String compare vs packed key
+int runKeyBench() {
+    uint64_t targetKey = 0, targetMask = 0;
+    parseMACRule(SIM_TARGET, strlen(SIM_TARGET), targetKey, targetMask);
+    std::string targetMAC = SIM_TARGET;
+
+    // Native (LSB first) address bytes as NimBLE hands them over; 1 in 64 is the target
+    std::vector<uint8_t> natives(KEY_BENCH_DEVICES * 6);
+    uint32_t seed = 42;
+    for (uint32_t d = 0; d < KEY_BENCH_DEVICES; d++) {
+        uint64_t key = SIM_TARGET_KEY;
+        if (d % 64) {
+            seed = seed * 1664525u + 1013904223u;
+            key = ((uint64_t)seed << 16) ^ (d * 0x9E3779B1ULL);
+        }
+        for (int i = 0; i < 6; i++) natives[d * 6 + i] = (uint8_t)(key >> (8 * i));
+    }
+
+    uint32_t stringHits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < KEY_BENCH_ADVERTS; i++) {
+        if (keyBenchStringMatch(&natives[(i % KEY_BENCH_DEVICES) * 6], targetMAC)) stringHits++;
+    }
+    double stringSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    volatile uint32_t keyHits = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < KEY_BENCH_ADVERTS; i++) {
+        if (addressKey(&natives[(i % KEY_BENCH_DEVICES) * 6]) == targetKey) keyHits = keyHits + 1;
+    }
+    double keySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stringHits != keyHits) printf("match mismatch: %u vs %u\n", (unsigned)stringHits, (unsigned)keyHits);
+
+    printf("%-12s %10s %8s %12s\n", "match", "adverts", "hits", "ns/advert");
+    printf("%-12s %10u %8u %12.1f\n", "String", (unsigned)KEY_BENCH_ADVERTS, (unsigned)stringHits,
+           stringSeconds * 1e9 / KEY_BENCH_ADVERTS);
+    printf("%-12s %10u %8u %12.1f\n", "packed key", (unsigned)KEY_BENCH_ADVERTS, (unsigned)keyHits,
+           keySeconds * 1e9 / KEY_BENCH_ADVERTS);
+    printf("speedup %.0fx\n", stringSeconds / keySeconds);
+    return 0;
+}
+
+// Scan callback latency as the target table grows: SYNTH_TARGET plus
+// addresses that never advertise, under a 10k adverts/s crowd
+int runTableBench() {
+    static const uint32_t TARGET_COUNTS[] = { 1, 4, 16, 64, 128, 256 };
+    halSimQuiet(true);
+    acceptListEnabled = false;       // Every advert reaches the callback, whatever the count
+    std::vector<uint8_t> crowd = generateCapture(10000, 30000, 10000);
+
+    printf("%8s ", "targets");
+    printReplayHeader();
+    for (uint32_t targetCount : TARGET_COUNTS) {
+        std::string list = SYNTH_TARGET;
+        uint32_t seed = targetCount;
+        for (uint32_t i = 1; i < targetCount; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            char mac[18];
+            formatMACKey(((uint64_t)seed << 16 | i) & MAC_MASK_FULL, mac);
+            list += "\n";
+            list += mac;
+        }
+        trackerSetTargets(list.c_str(), list.size());
+        ReplayStats stats;
+        replayCapture(crowd.data(), crowd.size(), false, stats);
+        printf("%8u ", (unsigned)targets.count());
+        printReplayStats(stats);
+    }
+    acceptListEnabled = true;
+    return 0;
+}
+
+#define MATCH_BENCH_RULES 1000
+#define MATCH_BENCH_ADVERTS 10000
+#define MATCH_BENCH_REPEATS 100        // Passes over the adverts for the compiled table
+#define MATCH_BENCH_POOL 4             // Values per octet, so rules overlap
+
+// Reference matcher: scan every entry, keep the most specific match (most
+// mask bits, then the larger mask, as TargetTable::compile() orders them)
+const TargetEntry* matchLinear(const TargetTable& table, uint64_t address) {
+    const TargetEntry* best = nullptr;
+    for (size_t i = 0; i < table.count(); i++) {
+        const TargetEntry& entry = table[i];
+        if (entry.mask == 0 || (address & entry.mask) != entry.key) continue;
+        if (!best || __builtin_popcountll(entry.mask) > __builtin_popcountll(best->mask) ||
+            (__builtin_popcountll(entry.mask) == __builtin_popcountll(best->mask) && entry.mask > best->mask)) {
+            best = &entry;
+        }
+    }
+    return best;
+}
+
+// Cross-check TargetTable::match() against a linear scan over random rules
+// and time both. Mixed rules use all 62 wildcard masks, the worst case for
+// the compiled table; typical lists are full addresses and OUIs.
+int runMatchBench() {
+    static std::vector<uint64_t> storage((TargetTable::storageSize(MATCH_BENCH_RULES) + 7) / 8);
+    TargetTable table;
+    table.begin(storage.data(), MATCH_BENCH_RULES);
+    uint32_t seed = 2024;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 16;           // Low LCG bits cycle too quickly for the small pools
+    };
+    auto pooled = [&next]() {
+        uint64_t address = 0;
+        for (int i = 0; i < 6; i++) address = address << 8 | (0x10 * (next() % MATCH_BENCH_POOL) + 0x0A);
+        return address;
+    };
+
+    // A 40-bit wildcard must win over the OUI it overlaps, though its mask is numerically smaller
+    uint64_t key = 0, mask = 0;
+    parseMACRule("AA:BB:CC", 8, key, mask);
+    table.insert(key, mask);
+    parseMACRule("AA:*:CC:DD:EE:FF", 16, key, mask);
+    TargetEntry* wildcard = table.insert(key, mask);
+    table.compile();
+    bool orderOk = table.match(0xAABBCCDDEEFFULL) == wildcard && table.match(0xAABBCC000000ULL) != wildcard;
+    printf("OUI vs wildcard order: %s\n\n", orderOk ? "ok" : "FAILED");
+
+    // Half the adverts from the overlapping pool, half fully random
+    std::vector<uint64_t> adverts(MATCH_BENCH_ADVERTS);
+    for (uint32_t i = 0; i < MATCH_BENCH_ADVERTS; i++) {
+        adverts[i] = i % 2 ? pooled() : (uint64_t)next() << 32 | (uint64_t)next() << 16 | next();
+    }
+
+    printf("%-9s %5s %5s %8s %7s %7s %10s %11s %11s\n", "rules", "full", "OUI", "wildcard", "masks", "matched",
+           "mismatch", "table_ns", "linear_ns");
+    uint32_t totalMismatches = 0;
+    for (int mixed = 1; mixed >= 0; mixed--) {
+        table.clear();
+        uint32_t kinds[3] = {};
+        while (table.count() < MATCH_BENCH_RULES) {
+            uint32_t kind = next() % (mixed ? 3 : 2);
+            mask = kind == 0 ? MAC_MASK_FULL : kind == 1 ? MAC_MASK_OUI : 0;
+            while (kind == 2 && (mask == 0 || mask == MAC_MASK_FULL)) {
+                uint32_t octets = next() & 0x3F;
+                mask = 0;
+                for (int i = 0; i < 6; i++) mask |= (uint64_t)((octets >> i) & 1 ? 0xFF : 0) << (8 * i);
+            }
+            size_t before = table.count();
+            table.insert(pooled(), mask);
+            if (table.count() > before) kinds[kind]++;
+        }
+        table.compile();
+
+        uint32_t matched = 0;
+        uint32_t mismatches = 0;
+        for (uint64_t address : adverts) {
+            const TargetEntry* expected = matchLinear(table, address);
+            if (table.match(address) != expected) mismatches++;
+            if (expected) matched++;
+        }
+        totalMismatches += mismatches;
+
+        volatile uintptr_t sink = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t r = 0; r < MATCH_BENCH_REPEATS; r++) {
+            for (uint64_t address : adverts) sink = sink + (uintptr_t)table.match(address);
+        }
+        double tableSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        start = std::chrono::steady_clock::now();
+        for (uint64_t address : adverts) sink = sink + (uintptr_t)matchLinear(table, address);
+        double linearSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        printf("%-9s %5u %5u %8u %7u %7u %10u %11.1f %11.1f\n", mixed ? "mixed" : "full+OUI", (unsigned)kinds[0],
+               (unsigned)kinds[1], (unsigned)kinds[2], (unsigned)table.maskCount(), (unsigned)matched,
+               (unsigned)mismatches, tableSeconds * 1e9 / ((double)MATCH_BENCH_ADVERTS * MATCH_BENCH_REPEATS),
+               linearSeconds * 1e9 / MATCH_BENCH_ADVERTS);
+    }
+    return orderOk && totalMismatches == 0 ? 0 : 1;
+}
+
+int runScanBench() {
+    halSimQuiet(true);
+    trackerSetTargets(SYNTH_TARGET, strlen(SYNTH_TARGET));
+    std::vector<uint8_t> capture = generateCapture(1000, 120000, 1);
+
+    printf("%-10s %9s %5s %6s %9s %9s %9s %9s %10s\n", "policy", "duty", "acq", "missed",
+           "lat_p50", "lat_p99", "lat_max", "delivered", "est_mA");
+    for (uint8_t level = 0; level <= SCAN_LEVEL_COUNT; level++) {
+        scanScheduler.force(level);
+        ReplayStats stats;
+        replayCapture(capture.data(), capture.size(), false, stats);
+        char duty[16];
+        if (level < SCAN_LEVEL_COUNT) {
+            snprintf(duty, sizeof(duty), "%u/%ums", SCAN_POLICIES[level].windowMs, SCAN_POLICIES[level].intervalMs);
+        } else {
+            snprintf(duty, sizeof(duty), "varies");
+        }
+        printf("%-10s %9s %5u %6u %7.1fms %7.1fms %7.1fms %9u %10.1f\n",
+               level < SCAN_LEVEL_COUNT ? scanLevelName(level) : "Adaptive", duty, (unsigned)stats.acquisitions,
+               (unsigned)stats.missed, stats.beepLatencyP50Ms, stats.beepLatencyP99Ms, stats.beepLatencyMaxMs,
+               (unsigned)stats.delivered, stats.averageCurrentMa);
+    }
+    scanScheduler.force(SCAN_ADAPTIVE);
+
+    // Scan requests in a crowd: callback volume and time to first detection
+    printf("\n%-10s %7s %10s %9s %9s %5s %6s %9s %9s %10s\n", "responses", "rate", "callbacks", "reports",
+           "requests", "acq", "missed", "lat_p50", "lat_p99", "est_mA");
+    static const uint32_t RATES[] = { 1000, 10000 };
+    for (uint32_t rate : RATES) {
+        std::vector<uint8_t> crowd = generateCapture(rate, 120000, rate);
+        for (uint8_t mode = 0; mode < SCAN_RESPONSE_MODE_COUNT; mode++) {
+            scanResponseMode = mode;
+            ReplayStats stats;
+            replayCapture(crowd.data(), crowd.size(), false, stats);
+            printf("%-10s %7u %10u %9u %9u %5u %6u %7.1fms %7.1fms %10.1f\n", scanResponseName(mode), (unsigned)rate,
+                   (unsigned)stats.delivered, (unsigned)stats.hostReports, (unsigned)stats.scanRequests,
+                   (unsigned)stats.acquisitions, (unsigned)stats.missed, stats.beepLatencyP50Ms,
+                   stats.beepLatencyP99Ms, stats.averageCurrentMa);
+        }
+    }
+    scanResponseMode = SCAN_RESPONSE_OFF;
+
+    // A target too slow for FOLLOW hovering around SCAN_CLOSE_IN_RSSI flips
+    // between ACQUIRED and CLOSE_IN; only a change of parameters may restart the scan
+    printf("\n%-10s %7s %9s %9s %9s\n", "hover", "levels", "restarts", "offered", "delivered");
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+    for (uint8_t mode = 0; mode < SCAN_RESPONSE_MODE_COUNT; mode++) {
+        scanResponseMode = mode;
+        simSeed = 12345;
+        trackerStart();
+        HalSimStats before = halSimStats();
+        uint8_t level = scanScheduler.level();
+        uint32_t levelChanges = 0;
+        for (uint32_t ms = 0; ms < SIM_DURATION_MS; ms++) {
+            if (ms % (SIM_ADVERT_PERIOD_MS * 2) == 0) {
+                HalAdvert advert = {};
+                advert.address = SIM_TARGET_KEY;
+                advert.rssi = (int8_t)(SCAN_CLOSE_IN_RSSI + simNoise(6));
+                halSimAdvert(advert);
+            }
+            trackerUpdate();
+            trackerServiceUx();
+            halSimAdvance(1000);
+            if (scanScheduler.level() != level) {
+                level = scanScheduler.level();
+                levelChanges++;
+            }
+        }
+        const HalSimStats& after = halSimStats();
+        printf("%-10s %7u %9u %9u %9u\n", scanResponseName(mode), (unsigned)levelChanges,
+               (unsigned)(after.scanRestarts - before.scanRestarts),
+               (unsigned)(after.advertsOffered - before.advertsOffered),
+               (unsigned)(after.advertsDelivered - before.advertsDelivered));
+    }
+    scanResponseMode = SCAN_RESPONSE_OFF;
+    return 0;
+}
+
+// Beep curve checks: the default table against the original branch-and-map()
+// intervals, custom curves through trackerSetBeepCurve(), and the inputs
+// /save and /curve must reject
+int runCurveTest() {
+    bool ok = true;
+    int mismatches = 0;
+    for (int rssi = BEEP_CURVE_MIN_RSSI; rssi <= -25; rssi++) {
+        if (calculateBeepInterval(rssi) != legacyBeepInterval(rssi)) mismatches++;
+    }
+    printf("%-32s %s (%d of %d RSSI values differ)\n", "default table vs legacy map()", mismatches ? "FAILED" : "ok",
+           mismatches, -25 - BEEP_CURVE_MIN_RSSI + 1);
+    ok &= mismatches == 0;
+
+    // A custom curve is interpolated with the same arithmetic and flat past its ends
+    halSimQuiet(true);
+    const char* custom = "-90:2000,-60:200,-30:20";
+    static const int RSSI[] = { -127, -90, -75, -60, -45, -30, 0 };
+    static const int EXPECTED[] = { 2000, 2000, 1100, 200, 110, 20, 20 };
+    bool customOk = trackerSetBeepCurve(custom);
+    for (size_t i = 0; i < sizeof(RSSI) / sizeof(RSSI[0]); i++) {
+        customOk &= calculateBeepInterval(RSSI[i]) == EXPECTED[i];
+    }
+    printf("%-32s %s\n", "custom curve lookups", customOk ? "ok" : "FAILED");
+    ok &= customOk;
+
+    bool fallbackOk = !trackerSetBeepCurve("-30:20,-90:2000") && calculateBeepInterval(-75) == legacyBeepInterval(-75);
+    printf("%-32s %s\n", "invalid curve keeps the default", fallbackOk ? "ok" : "FAILED");
+    ok &= fallbackOk;
+    trackerSetBeepCurve("");
+
+    static const char* INVALID[] = {
+        "-90:2000",                 // One point
+        "-30:20,-90:2000",          // RSSI descending
+        "-90:2000,-90:20",          // RSSI repeated
+        "-90:0,-30:20",             // Zero interval
+        "-90:60001,-30:20",         // Interval too long
+        "-128:100,-30:20",          // RSSI out of range
+        "-90:2000,1:20",
+        "-90:2000;-30:20",          // Wrong separator
+        "-90:,-30:20",
+        "abc",
+    };
+    CurvePoint points[BEEP_CURVE_MAX_POINTS];
+    for (const char* text : INVALID) {
+        if (parseBeepCurve(text, points) != 0) {
+            printf("%-32s FAILED (accepted \"%s\")\n", "invalid curves rejected", text);
+            ok = false;
+        }
+    }
+    std::string sixteen;
+    for (int i = 0; i < BEEP_CURVE_MAX_POINTS; i++) sixteen += std::to_string(-100 + i) + ":100,";
+    std::string seventeen = sixteen + "-50:100";
+    bool limitsOk = parseBeepCurve(sixteen.c_str(), points) == BEEP_CURVE_MAX_POINTS &&
+                    parseBeepCurve(seventeen.c_str(), points) == 0 &&
+                    parseBeepCurve(" -90:2000, -30:20 ", points) == 2;
+    printf("%-32s %s\n", "invalid curves rejected, 16 max", limitsOk ? "ok" : "FAILED");
+    ok &= limitsOk;
+    return ok ? 0 : 1;
+}
+
+// Buzzer/LED edge from the sequencer: time from the pattern start, buzzer on, LED on
+struct SeqEdge {
+    uint32_t ms;
+    bool buzzer;
+    bool led;
+};
+
+// Poll a pattern every pollMs from t = 1000 and return the edges it produces,
+// with the time each step was due (not when it was polled) and the time the
+// sequencer went idle
+std::vector<SeqEdge> seqRun(const TonePattern& pattern, uint32_t pollMs, uint32_t& doneMs, uint32_t& latestMs) {
+    const uint32_t start = 1000;
+    ToneSequencer sequencer;
+    std::vector<SeqEdge> edges;
+    sequencer.start(pattern, start);
+    doneMs = 0;
+    latestMs = 0;
+    for (uint32_t now = start; now < start + 5000; now += pollMs) {
+        uint32_t due = sequencer.nextEdge();
+        const ToneStep* step;
+        while ((step = sequencer.poll(now)) != nullptr) {
+            edges.push_back({ due - start, step->duty != 0, step->led });
+            if (now - due > latestMs) latestMs = now - due;
+            due = sequencer.nextEdge();
+        }
+        if (!sequencer.active()) {
+            doneMs = due - start;
+            break;
+        }
+    }
+    return edges;
+}
+
+bool seqExpect(const char* name, const std::vector<SeqEdge>& edges, const SeqEdge* expected, size_t count,
+               uint32_t doneMs, uint32_t expectedDoneMs) {
+    bool ok = edges.size() == count && doneMs == expectedDoneMs;
+    for (size_t i = 0; ok && i < count; i++) {
+        ok = edges[i].ms == expected[i].ms && edges[i].buzzer == expected[i].buzzer && edges[i].led == expected[i].led;
+    }
+    printf("%-28s %s", name, ok ? "ok" : "FAILED");
+    if (!ok) {
+        printf(" (got");
+        for (const SeqEdge& edge : edges) printf(" %u:%s", (unsigned)edge.ms, edge.buzzer ? "on" : "off");
+        printf(", done %u)", (unsigned)doneMs);
+    }
+    printf("\n");
+    return ok;
+}
+
+// ToneSequencer step timing: exact edges of READY_PATTERN and
+// ACQUIRED_PATTERN, catch-up after late polls, and the same edges on the
+// simulated buzzer through playPattern()
+int runSeqTest() {
+    static const SeqEdge READY_EDGES[] = {
+        { 0, true, true }, { 150, false, false }, { 200, true, true }, { 350, false, false },
+    };
+    static const SeqEdge ACQUIRED_EDGES[] = {
+        { 0, true, true }, { 100, false, false }, { 150, true, true },
+        { 250, false, false }, { 300, true, true }, { 400, false, false },
+    };
+    static const size_t READY_COUNT = sizeof(READY_EDGES) / sizeof(READY_EDGES[0]);
+    static const size_t ACQUIRED_COUNT = sizeof(ACQUIRED_EDGES) / sizeof(ACQUIRED_EDGES[0]);
+    bool ok = true;
+    uint32_t doneMs, latestMs;
+
+    std::vector<SeqEdge> edges = seqRun(READY_PATTERN, 1, doneMs, latestMs);
+    ok &= seqExpect("READY, 1 ms polls", edges, READY_EDGES, READY_COUNT, doneMs, 850);
+    edges = seqRun(ACQUIRED_PATTERN, 1, doneMs, latestMs);
+    ok &= seqExpect("ACQUIRED, 1 ms polls", edges, ACQUIRED_EDGES, ACQUIRED_COUNT, doneMs, 950);
+
+    // Polled every 70 ms, overdue steps are caught up in order and the
+    // schedule is not stretched
+    edges = seqRun(ACQUIRED_PATTERN, 70, doneMs, latestMs);
+    ok &= seqExpect("ACQUIRED, 70 ms polls", edges, ACQUIRED_EDGES, ACQUIRED_COUNT, doneMs, 950);
+    bool lateOk = latestMs < 70;
+    printf("%-28s %s (latest step applied %u ms after due)\n", "  catch-up within one poll", lateOk ? "ok" : "FAILED",
+           (unsigned)latestMs);
+    ok &= lateOk;
+
+    // End to end: the simulated buzzer sees the pattern's on time exactly
+    halSimQuiet(true);
+    buzzerEnabled = true;
+    const TonePattern* patterns[] = { &READY_PATTERN, &ACQUIRED_PATTERN };
+    const uint32_t onMs[] = { 300, 300 };
+    const uint32_t beeps[] = { 2, 3 };
+    for (int i = 0; i < 2; i++) {
+        HalSimStats before = halSimStats();
+        playPattern(*patterns[i]);
+        for (int ms = 0; ms < 2000; ms++) {
+            halSimAdvance(1000);
+            serviceToneSequencer();
+        }
+        const HalSimStats& after = halSimStats();
+        bool hwOk = after.buzzerEdges - before.buzzerEdges == beeps[i] &&
+                    after.buzzerOnUs - before.buzzerOnUs == onMs[i] * 1000ULL && !toneSequencer.active();
+        printf("%-28s %s (%u beeps, %u us on)\n", i ? "ACQUIRED on the buzzer" : "READY on the buzzer",
+               hwOk ? "ok" : "FAILED", (unsigned)(after.buzzerEdges - before.buzzerEdges),
+               (unsigned)(after.buzzerOnUs - before.buzzerOnUs));
+        ok &= hwOk;
+    }
+    return ok ? 0 : 1;
+}
+
+#define TELEMETRY_BENCH_SECONDS 60
+#define TELEMETRY_BENCH_QUEUE 8        // Messages an AsyncWebSocket client queues before availableForWriteAll() fails
+#define TELEMETRY_BENCH_STALL_MS 5000  // The phone stops reading for this long, every 20 s
+
+// One WebSocket client: frames queue up and drain at the link's byte rate
+struct TelemetryBenchLink {
+    uint32_t bytesPerSecond;
+    std::vector<size_t> queue;
+    double credit = 0;
+    uint64_t delivered = 0;
+
+    bool availableForWrite() const { return queue.size() < TELEMETRY_BENCH_QUEUE; }
+
+    void drain(uint32_t now, bool stalled) {
+        if (stalled) return;
+        credit += bytesPerSecond / 1000.0;
+        while (!queue.empty() && credit >= queue.front()) {
+            credit -= queue.front();
+            delivered += queue.front();
+            queue.erase(queue.begin());
+        }
+        if (queue.empty()) credit = 0;
+    }
+};
+
+// Live telemetry send path under a flood of detections: TelemetryBatcher with
+// serviceTelemetry()'s due/backpressure/drop logic against a slow client.
+// Every frame is decoded again, and sent plus dropped samples must add up.
+int runTelemetryBench() {
+    struct LinkCase {
+        const char* name;
+        uint32_t bytesPerSecond;
+        bool stalls;
+    };
+    static const LinkCase LINKS[] = {
+        { "good", 200000, false },
+        { "weak", 4000, false },
+        { "stalling", 200000, true },
+    };
+    static const uint32_t DETECTION_RATES[] = { 100, 1000, 10000 };
+    static const uint8_t FRAME_RATES[] = { 10, 50 };
+
+    // Cost of the detection-side call alone
+    {
+        static TelemetryBatcher batcher;
+        uint8_t frame[TELEMETRY_FRAME_SIZE];
+        volatile size_t sink = 0;
+        const uint32_t samples = 10000000;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < samples; i++) {
+            batcher.add(TelemetrySample{ i / 1000, (uint16_t)(i & 7), -60, -61 });
+            if ((i & 31) == 31) sink = sink + batcher.pack(frame, i / 1000);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("add + pack: %.1f ns/sample\n\n", seconds * 1e9 / samples);
+    }
+
+    printf("%-9s %6s %6s %8s %8s %9s %9s %10s %10s %8s\n", "link", "det/s", "fps", "frames", "f_drop",
+           "samples", "s_drop", "s_sent%", "kB/s", "check");
+    bool ok = true;
+    for (const LinkCase& link : LINKS) {
+        for (uint32_t detectionRate : DETECTION_RATES) {
+            for (uint8_t frameRate : FRAME_RATES) {
+                static TelemetryBatcher batcher;
+                batcher = TelemetryBatcher();
+                TelemetryBenchLink client = { link.bytesPerSecond, {} };
+                uint8_t frame[TELEMETRY_FRAME_SIZE];
+                uint64_t added = 0;
+                uint64_t decodedSamples = 0;
+                uint32_t framesSent = 0;
+                uint32_t lastDroppedSamples = 0;
+                bool framesOk = true;
+                double pending = 0;
+                for (uint32_t now = 1; now <= TELEMETRY_BENCH_SECONDS * 1000; now++) {
+                    pending += detectionRate / 1000.0;
+                    for (; pending >= 1; pending--) {
+                        batcher.add(TelemetrySample{ now, (uint16_t)(added % 4), -60, -62 });
+                        added++;
+                    }
+
+                    // serviceTelemetry(): send when due if the client can take it, otherwise drop
+                    if (batcher.due(now, 1000 / frameRate)) {
+                        if (client.availableForWrite()) {
+                            size_t length = batcher.pack(frame, now);
+                            framesOk &= frame[0] == TELEMETRY_VERSION &&
+                                        length == (size_t)(TELEMETRY_HEADER_SIZE + frame[1] * TELEMETRY_SAMPLE_SIZE);
+                            uint16_t droppedSamples = (uint16_t)(frame[4] | frame[5] << 8);
+                            framesOk &= droppedSamples >= lastDroppedSamples || droppedSamples == 0xFFFF;
+                            lastDroppedSamples = droppedSamples;
+                            decodedSamples += frame[1];
+                            client.queue.push_back(length);
+                            framesSent++;
+                        } else {
+                            batcher.dropFrame(now);
+                        }
+                    }
+                    client.drain(now, link.stalls && now % 20000 < TELEMETRY_BENCH_STALL_MS);
+                }
+                // Whatever is still batched at the end counts as neither
+                uint64_t accounted = decodedSamples + batcher.samplesDropped();
+                bool checkOk = framesOk && accounted <= added && added - accounted <= TELEMETRY_MAX_SAMPLES;
+                ok &= checkOk;
+                printf("%-9s %6u %6u %8u %8u %9llu %9u %9.1f%% %10.1f %8s\n", link.name, (unsigned)detectionRate,
+                       (unsigned)frameRate, (unsigned)framesSent, (unsigned)batcher.framesDropped(),
+                       (unsigned long long)decodedSamples, (unsigned)batcher.samplesDropped(),
+                       100.0 * decodedSamples / added, client.delivered / 1000.0 / TELEMETRY_BENCH_SECONDS,
+                       checkOk ? "ok" : "FAILED");
+            }
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+// Every report that reaches NimBLE allocates a result object and a payload copy
+#define SIM_HOST_REPORT_BYTES 160
+
+int runAcceptBench() {
+    struct FilterCase {
+        const char* name;
+        const char* targets;
+        bool acceptList;
+    };
+    static const FilterCase CASES[] = {
+        { "Host", SYNTH_TARGET, false },
+        { "Controller", SYNTH_TARGET, true },
+        { "OUI rule", "AA:BB:CC", true },   // Falls back to host matching
+    };
+    halSimQuiet(true);
+    std::vector<uint8_t> flood = generateCapture(50000, 30000, 50000);
+
+    printf("%-10s %6s %9s %10s %9s %10s %6s %10s %5s %9s\n", "matching", "filter", "reports", "filtered",
+           "callbacks", "handler_ms", "cpu%", "alloc_KB/s", "acq", "lat_p50");
+    for (const FilterCase& c : CASES) {
+        acceptListEnabled = c.acceptList;
+        trackerSetTargets(c.targets, strlen(c.targets));
+        ReplayStats stats;
+        replayCapture(flood.data(), flood.size(), false, stats);
+        printf("%-10s %6u %9u %10u %9u %10.1f %6.2f %10.1f %5u %7.1fms\n", c.name, (unsigned)acceptListSize,
+               (unsigned)stats.hostReports, (unsigned)stats.controllerFiltered, (unsigned)stats.delivered,
+               stats.callbackTotalMs, stats.callbackTotalMs / 10 / stats.simSeconds,
+               stats.hostReports * (double)SIM_HOST_REPORT_BYTES / 1024 / stats.simSeconds,
+               (unsigned)stats.acquisitions, stats.beepLatencyP50Ms);
+    }
+    acceptListEnabled = true;
+    return 0;
+}
+
+#define RSSI_BENCH_RUNS 50
+#define RSSI_BENCH_SAMPLES 300         // Per level, at SIM_ADVERT_PERIOD_MS
+#define RSSI_BENCH_FAR -80
+#define RSSI_BENCH_NEAR -50
+#define RSSI_BENCH_JITTER 6            // Uniform multipath jitter, +/- dB
+#define RSSI_BENCH_FADE_DB 12          // Deep fade on 1 in RSSI_BENCH_FADE_EVERY samples
+#define RSSI_BENCH_FADE_EVERY 10
+#define RSSI_BENCH_BAND 6              // Settled: within this many dB of the new level for good
+
+int rssiBenchSample(int level) {
+    int rssi = level + simNoise(RSSI_BENCH_JITTER);
+    if (simNoise(RSSI_BENCH_FADE_EVERY * 50) < -RSSI_BENCH_FADE_EVERY * 50 + 100) rssi -= RSSI_BENCH_FADE_DB;
+    return rssi;
+}
+
+// Step trace (walking from RSSI_BENCH_FAR to RSSI_BENCH_NEAR) through each
+// filter: time to 90% of the step, time to stay within RSSI_BENCH_BAND of the
+// new level, and the spread of the output while the level holds
+int runRssiBench() {
+    printf("Trace: %d -> %d dBm step, +/-%d dB jitter, %d dB fade 1 in %d, %u ms per sample, %u runs\n",
+           RSSI_BENCH_FAR, RSSI_BENCH_NEAR, RSSI_BENCH_JITTER, RSSI_BENCH_FADE_DB, RSSI_BENCH_FADE_EVERY,
+           (unsigned)SIM_ADVERT_PERIOD_MS, (unsigned)RSSI_BENCH_RUNS);
+    printf("%-8s %9s %10s %8s %8s %8s\n", "filter", "t90_ms", "settle_ms", "settled", "std_dB", "bias_dB");
+    for (uint8_t type = 0; type < RSSI_FILTER_COUNT; type++) {
+        double t90Sum = 0;
+        double settleSum = 0;
+        uint32_t settled = 0;
+        double sum = 0;
+        double sumSquares = 0;
+        uint32_t holdSamples = 0;
+        simSeed = 777;
+        for (uint32_t run = 0; run < RSSI_BENCH_RUNS; run++) {
+            RssiFilter filter;
+            filter.reset();
+            for (uint32_t i = 0; i < RSSI_BENCH_SAMPLES; i++) filter.update(type, rssiBenchSample(RSSI_BENCH_FAR));
+
+            int t90 = -1;
+            int lastOutside = -1;
+            for (int i = 0; i < RSSI_BENCH_SAMPLES; i++) {
+                int filtered = filter.update(type, rssiBenchSample(RSSI_BENCH_NEAR));
+                if (t90 < 0 && filtered >= RSSI_BENCH_FAR + (RSSI_BENCH_NEAR - RSSI_BENCH_FAR) * 9 / 10) t90 = i;
+                if (abs(filtered - RSSI_BENCH_NEAR) > RSSI_BENCH_BAND) lastOutside = i;
+                if (i >= RSSI_BENCH_SAMPLES / 2) {
+                    // Second half: the level has held long enough for any filter
+                    sum += filtered - RSSI_BENCH_NEAR;
+                    sumSquares += (double)(filtered - RSSI_BENCH_NEAR) * (filtered - RSSI_BENCH_NEAR);
+                    holdSamples++;
+                }
+            }
+            t90Sum += (t90 < 0 ? RSSI_BENCH_SAMPLES : t90 + 1) * SIM_ADVERT_PERIOD_MS;
+            if (lastOutside < RSSI_BENCH_SAMPLES / 2) {
+                settled++;
+                settleSum += (lastOutside + 1) * SIM_ADVERT_PERIOD_MS;
+            }
+        }
+        double mean = sum / holdSamples;
+        char settleText[16];
+        if (settled) snprintf(settleText, sizeof(settleText), "%.0f", settleSum / settled);
+        else snprintf(settleText, sizeof(settleText), "never");
+        printf("%-8s %9.0f %10s %4u/%-3u %8.2f %8.2f\n", rssiFilterName(type), t90Sum / RSSI_BENCH_RUNS, settleText,
+               (unsigned)settled, (unsigned)RSSI_BENCH_RUNS, sqrt(sumSquares / holdSamples - mean * mean), mean);
+    }
+
+    // Until the window fills, an even count of samples gives a midpoint; it
+    // must round half away from zero like the EMA and Kalman outputs
+    int mismatches = 0;
+    for (int a = -100; a <= -20; a++) {
+        for (int b = -100; b <= -20; b++) {
+            RssiFilter filter;
+            filter.reset();
+            filter.update(RSSI_FILTER_MEDIAN, a);
+            if (filter.update(RSSI_FILTER_MEDIAN, b) != lroundf((a + b) / 2.0f)) mismatches++;
+        }
+    }
+    printf("\n%-32s %s (%d of %d pairs differ)\n", "median midpoint rounding", mismatches ? "FAILED" : "ok",
+           mismatches, 81 * 81);
+    return mismatches ? 1 : 0;
+}
+
+#define IRK_BENCH_DEVICES 300          // Private-address devices in range
+#define IRK_BENCH_TARGETS 8            // Of which resolve to an IRK target
+#define IRK_BENCH_ADVERTS 200000
+
+// Core spec Vol 3 Part H D.7 sample data for ah()
+static const uint8_t AH_SAMPLE_IRK[16] = { 0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+                                           0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b };
+
+double irkBenchRun(IrkResolver& resolver, const std::vector<uint64_t>& addresses, uint32_t& resolved) {
+    uint32_t seed = 7;
+    resolved = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < IRK_BENCH_ADVERTS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        if (resolver.resolve(addresses[(seed >> 8) % addresses.size()]) != RPA_NO_TARGET) resolved++;
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int runIrkBench() {
+    uint32_t sample = rpaHash(AH_SAMPLE_IRK, 0x708194);
+    printf("ah() sample data: %06x (%s)\n", (unsigned)sample, sample == 0x0dfbaa ? "ok" : "expected 0dfbaa");
+
+    static const uint32_t IRK_COUNTS[] = { 1, 8, 32, IRK_MAX };
+    static IrkResolver resolver;
+    uint32_t seed = 99;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    printf("%5s %8s %13s %13s %8s %9s %10s\n", "irks", "devices", "no_cache/s", "cache/s", "speedup",
+           "hit_rate", "aes/advert");
+    for (uint32_t irkCount : IRK_COUNTS) {
+        std::vector<uint8_t> irks(irkCount * 16);
+        for (uint8_t& b : irks) b = (uint8_t)next();
+        resolver.clear();
+        for (uint32_t i = 0; i < irkCount; i++) resolver.add(&irks[i * 16], (uint16_t)i);
+
+        // Target devices use an IRK, the rest random private addresses
+        std::vector<uint64_t> addresses;
+        for (uint32_t d = 0; d < IRK_BENCH_DEVICES; d++) {
+            uint32_t prand = (next() & 0x3FFFFF) | 0x400000;
+            uint32_t hash = d < IRK_BENCH_TARGETS ? rpaHash(&irks[(d % irkCount) * 16], prand) : next() & 0xFFFFFF;
+            addresses.push_back((uint64_t)prand << 24 | hash);
+        }
+
+        uint32_t resolvedPlain, resolvedCached;
+        resolver.setCacheEnabled(false);
+        double plain = irkBenchRun(resolver, addresses, resolvedPlain);
+        resolver.setCacheEnabled(true);
+        uint32_t aesBefore = resolver.aesCount();
+        uint32_t hitsBefore = resolver.cacheHits();
+        double cached = irkBenchRun(resolver, addresses, resolvedCached);
+        if (resolvedPlain != resolvedCached) printf("cache changed the result: %u vs %u\n", resolvedPlain, resolvedCached);
+
+        printf("%5u %8u %13.0f %13.0f %7.0fx %8.1f%% %10.3f\n", (unsigned)irkCount, (unsigned)IRK_BENCH_DEVICES,
+               IRK_BENCH_ADVERTS / plain, IRK_BENCH_ADVERTS / cached, plain / cached,
+               100.0 * (resolver.cacheHits() - hitsBefore) / IRK_BENCH_ADVERTS,
+               (double)(resolver.aesCount() - aesBefore) / IRK_BENCH_ADVERTS);
+    }
+    return 0;
+}
+
+#define SIG_BENCH_PAYLOADS 4096
+#define SIG_BENCH_ADVERTS 2000000
+#define SIG_BENCH_COMPANIES 64         // Company IDs and UUIDs on air are drawn from small pools
+#define SIG_BENCH_UUIDS 64
+
+struct SigBenchPayload {
+    uint8_t length;
+    uint8_t data[ADVERT_MAX_PAYLOAD];
+};
+
+// Flags plus manufacturer data, a 16-bit UUID list, service data, a 128-bit UUID or a name
+std::vector<SigBenchPayload> sigBenchPayloads(uint32_t& seed) {
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+    std::vector<SigBenchPayload> payloads(SIG_BENCH_PAYLOADS);
+    for (SigBenchPayload& p : payloads) {
+        uint8_t* d = p.data;
+        size_t n = 0;
+        d[n++] = 2; d[n++] = 0x01; d[n++] = 0x06;
+        switch (next() % 5) {
+            case 0: {
+                uint16_t company = (uint16_t)(next() % SIG_BENCH_COMPANIES);
+                uint8_t dataLength = 2 + next() % 20;
+                d[n++] = dataLength + 3; d[n++] = AD_MANUFACTURER;
+                d[n++] = (uint8_t)company; d[n++] = (uint8_t)(company >> 8);
+                for (uint8_t i = 0; i < dataLength; i++) d[n++] = (uint8_t)next();
+                break;
+            }
+            case 1: {
+                uint8_t count = 1 + next() % 3;
+                d[n++] = 1 + count * 2; d[n++] = AD_UUID16_COMPLETE;
+                for (uint8_t i = 0; i < count; i++) {
+                    uint16_t uuid = (uint16_t)(0xFD00 + next() % SIG_BENCH_UUIDS);
+                    d[n++] = (uint8_t)uuid; d[n++] = (uint8_t)(uuid >> 8);
+                }
+                break;
+            }
+            case 2: {
+                uint16_t uuid = (uint16_t)(0xFD00 + next() % SIG_BENCH_UUIDS);
+                d[n++] = 11; d[n++] = AD_SERVICE_DATA16; d[n++] = (uint8_t)uuid; d[n++] = (uint8_t)(uuid >> 8);
+                for (int i = 0; i < 8; i++) d[n++] = (uint8_t)next();
+                break;
+            }
+            case 3:
+                d[n++] = 17; d[n++] = AD_UUID128_COMPLETE;
+                for (int i = 0; i < 16; i++) d[n++] = (uint8_t)(next() % 4);
+                break;
+            default: {
+                uint8_t nameLength = 4 + next() % 12;
+                d[n++] = nameLength + 1; d[n++] = AD_NAME_COMPLETE;
+                for (uint8_t i = 0; i < nameLength; i++) d[n++] = (uint8_t)('a' + next() % 4);
+                break;
+            }
+        }
+        p.length = (uint8_t)n;
+    }
+    return payloads;
+}
+
+int runSigBench() {
+    static const uint32_t RULE_COUNTS[] = { 1, 50, 500 };
+    uint32_t seed = 4242;
+    std::vector<SigBenchPayload> payloads = sigBenchPayloads(seed);
+    std::vector<uint8_t> storage(SignatureMatcher::storageSize(SIGNATURE_MAX));
+    SignatureMatcher matcher;
+    matcher.begin(storage.data(), SIGNATURE_MAX);
+
+    printf("%6s %11s %12s %8s\n", "rules", "ns/advert", "adverts/s", "hit%");
+    for (uint32_t ruleCount : RULE_COUNTS) {
+        // Rules of every kind; many will never match, as in a real target list
+        matcher.clear();
+        char line[64];
+        for (uint32_t i = 0; i < ruleCount; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t r = seed >> 8;
+            switch (i % 4) {
+                case 0: snprintf(line, sizeof(line), "MFG:%04X", (unsigned)(r % (SIG_BENCH_COMPANIES * 8))); break;
+                case 1: snprintf(line, sizeof(line), "UUID:%04X", (unsigned)(0xFD00 + r % (SIG_BENCH_UUIDS * 4))); break;
+                case 2: snprintf(line, sizeof(line), "NAME:%c%c%c%c%c", 'a' + r % 4, 'a' + (r >> 2) % 4,
+                                 'a' + (r >> 4) % 4, 'a' + (r >> 6) % 4, 'a' + (r >> 8) % 4); break;
+                default: snprintf(line, sizeof(line), "UUID:%08X-0000-1000-8000-%012X", (unsigned)r, (unsigned)r); break;
+            }
+            SignatureRule rule;
+            if (parseSignature(line, strlen(line), rule)) matcher.add(rule, (uint16_t)i);
+        }
+        matcher.compile();
+
+        uint32_t hits = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < SIG_BENCH_ADVERTS; i++) {
+            const SigBenchPayload& p = payloads[i & (SIG_BENCH_PAYLOADS - 1)];
+            if (matcher.match(p.data, p.length) != SIGNATURE_NONE) hits++;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%6u %11.1f %12.0f %7.1f%%\n", (unsigned)ruleCount, seconds * 1e9 / SIG_BENCH_ADVERTS,
+               SIG_BENCH_ADVERTS / seconds, 100.0 * hits / SIG_BENCH_ADVERTS);
+    }
+    return 0;
+}
+
+// Stands in for the telemetry hook so every detection also crosses to the UX side
+uint32_t taskBenchSamples = 0;
+void countSample(const DetectionRecord& record, int filteredRssi) {
+    taskBenchSamples++;
+}
+
+int runTaskBench() {
+    static const uint32_t RATES[] = { 1000, 10000, 50000 };
+    halSimQuiet(true);
+    trackerSetTargets(SYNTH_TARGET, strlen(SYNTH_TARGET));
+    detectionHook = countSample;
+    acceptListEnabled = false;   // Every advert reaches the BLE task, as with OUI rules
+
+    // Host time per simulated second, per context; the device figure scales
+    // with its slower core but the split between contexts carries over
+    printf("%7s %9s %9s %9s %8s %8s %9s %9s %9s\n", "rate", "ble_ms/s", "det_ms/s", "ux_ms/s", "samples",
+           "ux_high", "ux_drop", "beep_p50", "beep_p99");
+    for (uint32_t rate : RATES) {
+        std::vector<uint8_t> capture = generateCapture(rate, 30000, rate);
+        taskBenchSamples = 0;
+        ReplayStats stats;
+        replayCapture(capture.data(), capture.size(), false, stats);
+        printf("%7u %9.3f %9.3f %9.3f %8u %8u %9u %7.1fms %7.1fms\n", (unsigned)rate,
+               stats.callbackTotalMs / stats.simSeconds, stats.updateTotalMs / stats.simSeconds,
+               stats.uxTotalMs / stats.simSeconds, (unsigned)taskBenchSamples, (unsigned)uxRing.highWater(),
+               (unsigned)stats.uxOverflows, stats.beepLatencyP50Ms, stats.beepLatencyP99Ms);
+    }
+    detectionHook = nullptr;
+    acceptListEnabled = true;
+    return 0;
+}
+
+int runLogBench() {
+    struct LogSetup {
+        const char* name;
+        uint8_t level;
+        uint8_t format;
+        bool deferred;
+    };
+    static const LogSetup SETUPS[] = {
+        { "off", LOG_LEVEL_WARN, LOG_FORMAT_TEXT, false },
+        { "inline", LOG_LEVEL_DEBUG, LOG_FORMAT_TEXT, false },   // println from the tracking path
+        { "ring", LOG_LEVEL_DEBUG, LOG_FORMAT_TEXT, true },
+        { "binary", LOG_LEVEL_DEBUG, LOG_FORMAT_BINARY, true },
+    };
+    halSimQuiet(true);
+    trackerSetTargets(SYNTH_TARGET, strlen(SYNTH_TARGET));
+    std::vector<uint8_t> capture = generateCapture(1000, 60000, 1);
+
+    // Tick latency counts host time plus the UART time of any bytes written
+    // inline at SYNTH_UART_BAUD; deferred lines are written between ticks
+    printf("%-8s %8s %9s %9s %10s %10s %10s\n", "logging", "lines/s", "bytes/s", "dropped", "tick_mean",
+           "tick_p99.9", "tick_max");
+    for (const LogSetup& setup : SETUPS) {
+        logLevel = setup.level;
+        logFormat = setup.format;
+        logDeferred = setup.deferred;
+        uint32_t dropped = logDropped();
+        ReplayStats stats;
+        replayCapture(capture.data(), capture.size(), false, stats);
+        printf("%-8s %8.1f %9.0f %9u %8.1fus %8.1fus %8.1fus\n", setup.name, stats.logLines / stats.simSeconds,
+               stats.logBytes / stats.simSeconds, (unsigned)(logDropped() - dropped), stats.tickMeanUs,
+               stats.tickP999Us, stats.tickMaxUs);
+    }
+    logLevel = LOG_LEVEL_INFO;
+    logFormat = LOG_FORMAT_TEXT;
+    logDeferred = false;
+    return 0;
+}
+
+// Direction-finding sweeps against synthetic antenna patterns. Each trial
+// places the target at a random bearing and turns the antenna one full circle
+// in 6-12 s, speeding up and slowing down along the way as a hand does.
+// Adverts arrive every ~100 ms with Gaussian fading on top of the antenna gain;
+// anything under the receiver floor is lost.
+#define SWEEP_BENCH_TRIALS 500
+#define SWEEP_BENCH_TRACKER_TRIALS 50
+#define SWEEP_BENCH_RSSI -60           // Boresight RSSI
+#define SWEEP_BENCH_FLOOR -95          // Receiver sensitivity
+
+enum SweepAntenna {
+    SWEEP_YAGI,     // 3-element yagi: ~60 deg beam, -15 dB back lobe
+    SWEEP_PATCH,    // Patch: ~90 deg beam, -12 dB behind
+    SWEEP_BODY      // Whip held against the body: shallow cardioid, -8 dB behind
+};
+
+struct SweepBenchCase {
+    const char* name;
+    uint8_t antenna;
+    float fadingDb;          // Standard deviation per advert
+    float rateWobble;        // Rotation speed swing, fraction of the mean
+};
+
+// Gain in dB relative to boresight, offset in degrees from it
+float sweepAntennaGain(uint8_t antenna, float offset) {
+    float radians = offset * (float)M_PI / 180.0f;
+    switch (antenna) {
+        case SWEEP_YAGI: {
+            float front = -3.0f * (1.0f - cosf(radians)) / (1.0f - cosf(30.0f * (float)M_PI / 180.0f));
+            float back = -15.0f - 6.0f * (1.0f + cosf(radians));
+            float gain = front > back ? front : back;
+            return gain < -25.0f ? -25.0f : gain;
+        }
+        case SWEEP_PATCH: {
+            float front = -3.0f * (1.0f - cosf(radians)) / (1.0f - cosf(45.0f * (float)M_PI / 180.0f));
+            return front < -12.0f ? -12.0f : front;
+        }
+        default:
+            return -4.0f * (1.0f - cosf(radians));
+    }
+}
+
+float sweepGaussian() {
+    float u1 = ((simNoise(32767) + 32768) + 0.5f) / 65536.0f;
+    float u2 = (simNoise(32767) + 32768) / 65536.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+int sweepBearingError(int estimate, int truth) {
+    int error = (estimate - truth) % 360;
+    if (error < 0) error += 360;
+    return error > 180 ? 360 - error : error;
+}
+
+struct SweepTrace {
+    int trueBearing;                        // Degrees from the start heading
+    uint32_t durationMs;
+    std::vector<std::pair<uint32_t, int>> samples;  // ms since start, RSSI
+};
+
+SweepTrace sweepTrace(const SweepBenchCase& c) {
+    SweepTrace trace;
+    trace.trueBearing = (simNoise(180) + 180) % 360;
+    trace.durationMs = 9000 + simNoise(3000);
+    float wobblePhase = (simNoise(180) + 180) * (float)M_PI / 180.0f;
+    uint32_t t = (uint32_t)(simNoise(50) + 50);
+    while (t < trace.durationMs) {
+        // Heading advances 360 deg over the sweep; the sine term varies the
+        // speed by +-rateWobble without ever turning backwards
+        float phase = (float)t / trace.durationMs;
+        float heading = 360.0f * (phase + c.rateWobble / (2.0f * (float)M_PI) *
+                                  (sinf(2.0f * (float)M_PI * phase + wobblePhase) - sinf(wobblePhase)));
+        float rssi = SWEEP_BENCH_RSSI + sweepAntennaGain(c.antenna, heading - trace.trueBearing) +
+                     c.fadingDb * sweepGaussian();
+        if (rssi >= SWEEP_BENCH_FLOOR) trace.samples.push_back({ t, (int)lroundf(rssi) });
+        t += 100 + simNoise(10);
+    }
+    return trace;
+}
+
+struct SweepBenchStats {
+    uint32_t fixes = 0;
+    std::vector<int> errors;
+
+    void add(const SweepResult& result, int truth) {
+        if (result.bearing == SWEEP_NO_BEARING) return;
+        fixes++;
+        errors.push_back(sweepBearingError(result.bearing, truth));
+    }
+
+    int percentile(int p) {
+        if (errors.empty()) return -1;
+        std::sort(errors.begin(), errors.end());
+        return errors[(errors.size() - 1) * p / 100];
+    }
+};
+
+// Whole path: adverts through the simulated radio, sweep toggled around one turn
+SweepResult trackerSweepResult;
+void captureSweep(uint16_t target, const SweepResult& result) {
+    trackerSweepResult = result;
+}
+
+void sweepThroughTracker(const SweepTrace& trace, SweepBenchStats& stats) {
+    trackerStart();
+    // Find the target before starting: a sweep needs it in range
+    for (int i = 0; i < 10; i++) {
+        HalAdvert advert = {};
+        advert.address = SIM_TARGET_KEY;
+        advert.rssi = SWEEP_BENCH_RSSI;
+        halSimAdvert(advert);
+        trackerUpdate();
+        trackerServiceUx();
+        halSimAdvance(100000);
+    }
+
+    trackerSweepToggle();
+    trackerUpdate();
+    size_t next = 0;
+    for (uint32_t ms = 0; ms < trace.durationMs; ms++) {
+        while (next < trace.samples.size() && trace.samples[next].first <= ms) {
+            HalAdvert advert = {};
+            advert.address = SIM_TARGET_KEY;
+            advert.rssi = (int8_t)trace.samples[next++].second;
+            halSimAdvert(advert);
+        }
+        trackerUpdate();
+        trackerServiceUx();
+        halSimAdvance(1000);
+    }
+    trackerSweepResult = {};
+    trackerSweepResult.bearing = SWEEP_NO_BEARING;
+    trackerSweepToggle();
+    trackerUpdate();
+    trackerServiceUx();
+    stats.add(trackerSweepResult, trace.trueBearing);
+}
+
+int runSweepBench() {
+    static const SweepBenchCase CASES[] = {
+        { "yagi", SWEEP_YAGI, 2.0f, 0.0f },
+        { "yagi", SWEEP_YAGI, 4.0f, 0.0f },
+        { "yagi", SWEEP_YAGI, 4.0f, 0.3f },
+        { "yagi", SWEEP_YAGI, 6.0f, 0.3f },
+        { "patch", SWEEP_PATCH, 4.0f, 0.3f },
+        { "body", SWEEP_BODY, 2.0f, 0.3f },
+        { "body", SWEEP_BODY, 4.0f, 0.3f },
+    };
+    halSimQuiet(true);
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+    sweepHook = captureSweep;
+
+    printf("Estimator state: %u bytes\n", (unsigned)sizeof(SweepEstimator));
+    printf("%-7s %6s %7s  %-22s %-22s %-22s\n", "antenna", "fade", "wobble", "raw fix%/p50/p90",
+           "ema fix%/p50/p90", "tracker fix%/p50/p90");
+    for (const SweepBenchCase& c : CASES) {
+        SweepBenchStats raw, filtered, tracked;
+        for (int trial = 0; trial < SWEEP_BENCH_TRIALS; trial++) {
+            SweepTrace trace = sweepTrace(c);
+
+            // Estimator alone, on raw RSSI and on the EMA the proximity beep uses
+            SweepEstimator rawEstimator, emaEstimator;
+            RssiFilter ema;
+            ema.reset();
+            rawEstimator.begin(0);
+            emaEstimator.begin(0);
+            for (const auto& sample : trace.samples) {
+                rawEstimator.add(sample.first, sample.second);
+                emaEstimator.add(sample.first, ema.update(RSSI_FILTER_EMA, sample.second));
+            }
+            raw.add(rawEstimator.finish(trace.durationMs), trace.trueBearing);
+            filtered.add(emaEstimator.finish(trace.durationMs), trace.trueBearing);
+
+            if (trial < SWEEP_BENCH_TRACKER_TRIALS) sweepThroughTracker(trace, tracked);
+        }
+        char rawText[32], emaText[32], trackerText[32];
+        snprintf(rawText, sizeof(rawText), "%3u%% %3d %3d", (unsigned)(raw.fixes * 100 / SWEEP_BENCH_TRIALS),
+                 raw.percentile(50), raw.percentile(90));
+        snprintf(emaText, sizeof(emaText), "%3u%% %3d %3d", (unsigned)(filtered.fixes * 100 / SWEEP_BENCH_TRIALS),
+                 filtered.percentile(50), filtered.percentile(90));
+        snprintf(trackerText, sizeof(trackerText), "%3u%% %3d %3d",
+                 (unsigned)(tracked.fixes * 100 / SWEEP_BENCH_TRACKER_TRIALS), tracked.percentile(50),
+                 tracked.percentile(90));
+        printf("%-7s %4.0fdB %6.0f%%  %-22s %-22s %-22s\n", c.name, c.fadingDb, c.rateWobble * 100, rawText,
+               emaText, trackerText);
+    }
+    sweepHook = nullptr;
+
+    // A detection still queued from before begin() must be dropped, not wrap
+    // the time offset and merge every bin away
+    bool earlyOk = true;
+    for (int trial = 0; trial < SWEEP_BENCH_TRIALS && earlyOk; trial++) {
+        SweepTrace trace = sweepTrace(CASES[0]);
+        const uint32_t start = 100000;
+        SweepEstimator clean, early;
+        clean.begin(start);
+        early.begin(start);
+        early.add(start - 1, SWEEP_BENCH_RSSI);
+        for (const auto& sample : trace.samples) {
+            clean.add(start + sample.first, sample.second);
+            early.add(start + sample.first, sample.second);
+        }
+        SweepResult expected = clean.finish(start + trace.durationMs);
+        SweepResult result = early.finish(start + trace.durationMs);
+        earlyOk = result.bearing == expected.bearing && result.contrast == expected.contrast &&
+                  result.lobeWidth == expected.lobeWidth;
+        if (!earlyOk) {
+            printf("\n%-32s FAILED (bearing %u contrast %d, expected %u contrast %d)\n",
+                   "sample before begin() dropped", result.bearing, result.contrast, expected.bearing,
+                   expected.contrast);
+        }
+    }
+    if (earlyOk) printf("\n%-32s ok\n", "sample before begin() dropped");
+    return earlyOk ? 0 : 1;
+}
+
+// A walker heads toward the target, turns back, comes in again, stands still
+// and closes in, at walking pace with log-distance path loss and Gaussian
+// fading on every advert. For each reversal the bench reports how long the
+// trend cue takes to flip to the new direction, and how much of the walk it
+// spends on the wrong call (the opposite direction, or any call while
+// standing still).
+#define TREND_BENCH_RUNS 20
+#define TREND_BENCH_STEP_MS 10
+#define TREND_BENCH_FADING_DB 4.0f
+#define TREND_BENCH_START_M 25.0f
+
+struct TrendLeg {
+    uint32_t durationMs;
+    float speed;             // m/s, negative = toward the target
+};
+
+static const TrendLeg TREND_BENCH_LEGS[] = {
+    { 12000, -1.2f },
+    { 10000, 1.2f },
+    { 15000, -1.2f },
+    { 10000, 1.2f },
+    { 8000, 0.0f },
+    { 10000, -1.2f },
+};
+
+// RSSI at distance (m): -45 dBm at 1 m, path loss exponent 2.5
+float trendBenchRssi(float distance) {
+    return -45.0f - 25.0f * log10f(distance < 0.5f ? 0.5f : distance);
+}
+
+struct TrendBenchResult {
+    std::vector<uint32_t> flipMs;    // Per reversal, reversal to the new call
+    uint32_t missed = 0;             // Reversals never called before the next one
+    uint64_t wrongMs = 0;            // Time on the wrong call
+    uint64_t totalMs = 0;
+    uint32_t wrongFlips = 0;         // Changes to a wrong call
+};
+
+void trendBenchRun(TrendBenchResult& result) {
+    trackerStart();
+    float distance = TREND_BENCH_START_M;
+    uint8_t previous = trackerTrend();
+    for (const TrendLeg& leg : TREND_BENCH_LEGS) {
+        uint8_t expected = leg.speed < 0 ? TREND_WARMER : leg.speed > 0 ? TREND_COLDER : TREND_STEADY;
+        bool reversal = &leg != TREND_BENCH_LEGS && expected != TREND_STEADY;
+        bool called = false;
+        for (uint32_t ms = 0; ms < leg.durationMs; ms += TREND_BENCH_STEP_MS) {
+            if (halMillis() % SIM_ADVERT_PERIOD_MS < TREND_BENCH_STEP_MS) {
+                HalAdvert advert = {};
+                advert.address = SIM_TARGET_KEY;
+                advert.rssi = (int8_t)lroundf(trendBenchRssi(distance) + TREND_BENCH_FADING_DB * sweepGaussian());
+                halSimAdvert(advert);
+            }
+            trackerUpdate();
+            trackerServiceUx();
+            halSimAdvance(TREND_BENCH_STEP_MS * 1000);
+            distance += leg.speed * TREND_BENCH_STEP_MS / 1000.0f;
+
+            uint8_t now = trackerTrend();
+            if (reversal && !called && now == expected) {
+                result.flipMs.push_back(ms);
+                called = true;
+            }
+            bool wrong = expected == TREND_STEADY ? now != TREND_STEADY : now != expected && now != TREND_STEADY;
+            if (wrong) {
+                result.wrongMs += TREND_BENCH_STEP_MS;
+                if (now != previous) result.wrongFlips++;
+            }
+            previous = now;
+            result.totalMs += TREND_BENCH_STEP_MS;
+        }
+        if (reversal && !called) result.missed++;
+    }
+}
+
+int runTrendBench() {
+    static const uint8_t FILTERS[] = { RSSI_FILTER_EMA, RSSI_FILTER_MEDIAN, RSSI_FILTER_KALMAN };
+    static const uint8_t THRESHOLDS[] = { 5, 10, 15, 25 };
+    halSimQuiet(true);
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+    trendCue = true;
+
+    printf("%-7s %8s %9s %9s %9s %7s %7s %11s\n", "filter", "dB/s", "flip_p50", "flip_p90", "flip_max",
+           "missed", "wrong%", "wrong/run");
+    for (uint8_t filter : FILTERS) {
+        rssiFilterType = filter;
+        for (uint8_t threshold : THRESHOLDS) {
+            trendThreshold = threshold;
+            simSeed = 12345;
+            TrendBenchResult result;
+            for (int run = 0; run < TREND_BENCH_RUNS; run++) trendBenchRun(result);
+
+            std::sort(result.flipMs.begin(), result.flipMs.end());
+            auto flip = [&](int p) {
+                return result.flipMs.empty() ? -1.0 : result.flipMs[(result.flipMs.size() - 1) * p / 100] / 1000.0;
+            };
+            printf("%-7s %8.1f %8.1fs %8.1fs %8.1fs %7u %6.1f%% %11.1f\n", rssiFilterName(filter), threshold / 10.0,
+                   flip(50), flip(90), flip(100), (unsigned)result.missed, 100.0 * result.wrongMs / result.totalMs,
+                   (double)result.wrongFlips / TREND_BENCH_RUNS);
+        }
+    }
+    rssiFilterType = RSSI_FILTER_EMA;
+    trendThreshold = TREND_DEFAULT_THRESHOLD;
+    return 0;
+}
+
+// The trend walk again, with the target going quiet for a while after each
+// pass so it is lost and reacquired, at several advertising rates. The session
+// ring is drained every RECBENCH_DRAIN_MS into chunks the way the recorder
+// task does on the device (src/recorder.cpp, which needs LittleFS); the bench
+// reports how much that writes and what recording adds to the detection task.
+#define RECBENCH_SECONDS 600
+#define RECBENCH_QUIET_MS 15000
+#define RECBENCH_DRAIN_MS 50              // RECORDER_TASK_PERIOD_MS
+#define RECBENCH_FLUSH_MS 5000            // RECORDER_FLUSH_MS
+#define RECBENCH_FS_BYTES (896 * 1024)    // spiffs partition in huge_app.csv, mounted as LittleFS
+#define RECBENCH_BUDGET_PERCENT 75        // RECORDER_BUDGET_PERCENT
+
+struct RecBenchResult {
+    uint32_t events = 0;
+    uint32_t records = 0;
+    uint32_t chunks = 0;
+    uint64_t bytes = 0;
+    double seconds = 0;      // Simulated
+    double detectMs = 0;     // Host time in trackerUpdate()
+    std::vector<uint8_t> file;
+};
+
+void recBenchWrite(SessionChunk& chunk, bool& open, RecBenchResult& result) {
+    if (!open) return;
+    open = false;
+    result.records += chunk.records();
+    size_t length = chunk.finish((uint16_t)result.chunks++);
+    result.bytes += length;
+    result.file.insert(result.file.end(), chunk.bytes(), chunk.bytes() + length);
+}
+
+void recBenchRun(uint32_t periodMs, bool recording, RecBenchResult& result) {
+    static SessionChunk chunk;
+    bool open = false;
+    SessionEvent event;
+    simSeed = 12345;
+    while (sessionRing.pop(event)) {}
+    sessionRecording = recording;
+    uint8_t header[SESSION_FILE_HEADER_SIZE];
+    result.file.assign(header, header + encodeSessionHeader(1, halMillis(), header));
+
+    // The recorder opens every session with a MODE record
+    event = {};
+    event.type = SESSION_MODE;
+    event.timestamp = halMillis();
+    event.arg = SESSION_MODE_TRACKING;
+    if (recording) sessionRing.push(event);
+    trackerStart();
+
+    uint32_t start = halMillis();
+    uint32_t nextAdvert = start;
+    while (halMillis() - start < RECBENCH_SECONDS * 1000) {
+        float distance = TREND_BENCH_START_M;
+        for (const TrendLeg& leg : TREND_BENCH_LEGS) {
+            for (uint32_t ms = 0; ms < leg.durationMs; ms += TREND_BENCH_STEP_MS) {
+                uint32_t now = halMillis();
+                if ((int32_t)(now - nextAdvert) >= 0) {
+                    HalAdvert advert = {};
+                    advert.address = SIM_TARGET_KEY;
+                    advert.rssi = (int8_t)lroundf(trendBenchRssi(distance) + TREND_BENCH_FADING_DB * sweepGaussian());
+                    halSimAdvert(advert);
+                    nextAdvert = now + periodMs;
+                }
+                auto before = std::chrono::steady_clock::now();
+                trackerUpdate();
+                result.detectMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - before).count();
+                trackerServiceUx();
+                halSimAdvance(TREND_BENCH_STEP_MS * 1000);
+                distance += leg.speed * TREND_BENCH_STEP_MS / 1000.0f;
+
+                // Recorder task
+                if (halMillis() % RECBENCH_DRAIN_MS < TREND_BENCH_STEP_MS) {
+                    while (sessionRing.pop(event)) {
+                        result.events++;
+                        if (!open) {
+                            chunk.begin(event.timestamp);
+                            open = true;
+                        }
+                        if (!chunk.add(event)) {
+                            recBenchWrite(chunk, open, result);
+                            chunk.begin(event.timestamp);
+                            open = true;
+                            chunk.add(event);
+                        }
+                    }
+                    if (open && halMillis() - chunk.started() >= RECBENCH_FLUSH_MS) recBenchWrite(chunk, open, result);
+                }
+            }
+        }
+        for (uint32_t ms = 0; ms < RECBENCH_QUIET_MS; ms += TREND_BENCH_STEP_MS) {
+            auto before = std::chrono::steady_clock::now();
+            trackerUpdate();
+            result.detectMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - before).count();
+            trackerServiceUx();
+            halSimAdvance(TREND_BENCH_STEP_MS * 1000);
+        }
+        nextAdvert = halMillis();
+    }
+    while (sessionRing.pop(event)) {
+        result.events++;
+        if (!open) {
+            chunk.begin(event.timestamp);
+            open = true;
+        }
+        chunk.add(event);
+    }
+    recBenchWrite(chunk, open, result);
+    result.seconds = (halMillis() - start) / 1000.0;
+    sessionRecording = false;
+}
+
+int runRecBench(const char* path) {
+    static const uint32_t PERIODS[] = { 1000, 100, 20 };
+    halSimQuiet(true);
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+
+    printf("%7s %8s %9s %9s %10s %7s %8s %9s %10s %10s\n", "rate", "events/s", "records/s", "bytes/s",
+           "chunks/min", "ring_hi", "dropped", "budget_h", "det_ms/s", "rec_ms/s");
+    for (uint32_t period : PERIODS) {
+        RecBenchResult off, on;
+        recBenchRun(period, false, off);
+        uint32_t overflows = sessionRing.overflows();
+        recBenchRun(period, true, on);
+
+        double seconds = on.seconds;
+        double bytesPerSecond = on.bytes / seconds;
+        double budgetHours = RECBENCH_FS_BYTES * RECBENCH_BUDGET_PERCENT / 100.0 / bytesPerSecond / 3600;
+        printf("%5uHz %8.1f %9.1f %9.1f %10.1f %7u %8u %9.1f %10.3f %10.3f\n", (unsigned)(1000 / period),
+               on.events / seconds, on.records / seconds, bytesPerSecond, on.chunks * 60 / seconds,
+               (unsigned)sessionRing.highWater(), (unsigned)(sessionRing.overflows() - overflows),
+               budgetHours, off.detectMs / off.seconds, on.detectMs / seconds);
+
+        if (path && period == 100) {
+            FILE* file = fopen(path, "wb");
+            if (!file || fwrite(on.file.data(), 1, on.file.size(), file) != on.file.size()) {
+                fprintf(stderr, "Unable to write %s\n", path);
+                if (file) fclose(file);
+                return 1;
+            }
+            fclose(file);
+        }
+    }
+    if (path) printf("Wrote the 10Hz session to %s\n", path);
+    return 0;
+}
+
+// A crowd where advert counts follow a Zipf law (a few chatty devices, a long
+// tail of quiet ones), each device at its own distance with fading on every
+// advert, and vendors that are Zipf-popular too. The survey sketches see the
+// stream in arrival order; the bench compares what they report against exact
+// per-device tallies.
+#define SURVEY_BENCH_ADVERTS 2000000
+#define SURVEY_BENCH_VENDORS 400
+#define SURVEY_BENCH_ZIPF 1.1
+
+struct SurveyBenchDevice {
+    uint64_t address;
+    uint8_t addressType;
+    float rssi;                // Mean at its distance
+};
+
+struct SurveyBenchExact {
+    uint32_t count = 0;
+    int8_t peak = -128;
+};
+
+// Draw from a Zipf law over n items by inverting its cumulative weights
+struct ZipfTable {
+    std::vector<double> cumulative;
+
+    ZipfTable(size_t n, double s) {
+        double total = 0;
+        for (size_t i = 0; i < n; i++) cumulative.push_back(total += 1.0 / pow((double)(i + 1), s));
+        for (double& c : cumulative) c /= total;
+    }
+
+    size_t draw() {
+        double u = (simNoise(32767) + 32768 + (simNoise(32767) + 32768) / 65536.0) / 65536.0;
+        return std::lower_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+    }
+};
+
+// Share of the true top n keys (by value) found among the reported top n keys
+template <typename Value>
+double surveyRecall(const std::unordered_map<uint64_t, Value>& exact, const SurveyEntry* reported,
+                    size_t reportedCount, size_t n, int64_t (*rank)(const Value&)) {
+    std::vector<std::pair<int64_t, uint64_t>> ranked;
+    for (const auto& item : exact) ranked.push_back({ rank(item.second), item.first });
+    std::sort(ranked.rbegin(), ranked.rend());
+    if (ranked.size() < n) n = ranked.size();
+    if (n == 0) return 1;
+    // Ties at the cut-off make either key a right answer
+    int64_t cutoff = ranked[n - 1].first;
+    size_t found = 0;
+    for (size_t i = 0; i < reportedCount && i < n; i++) {
+        auto it = exact.find(reported[i].key);
+        if (it != exact.end() && rank(it->second) >= cutoff) found++;
+    }
+    return (double)found / n;
+}
+
+int64_t surveyExactCount(const SurveyBenchExact& e) { return e.count; }
+int64_t surveyExactPeak(const SurveyBenchExact& e) { return e.peak; }
+
+int runSurveyBench() {
+    static const uint32_t DEVICES[] = { 100, 1000, 10000, 100000 };
+    halSimQuiet(true);
+
+    printf("%8s %9s %8s %8s %9s %9s %9s %10s %9s %9s\n", "devices", "adverts", "top10", "top20", "cnt_err%",
+           "strong10", "vendor10", "ns/advert", "sketch_kb", "exact_kb");
+    for (uint32_t deviceCount : DEVICES) {
+        simSeed = 12345;
+        ZipfTable vendorPopularity(SURVEY_BENCH_VENDORS, SURVEY_BENCH_ZIPF);
+        std::vector<SurveyBenchDevice> devices(deviceCount);
+        for (SurveyBenchDevice& device : devices) {
+            // Most phones and trackers advertise from random addresses
+            bool random = simNoise(50) > 20;
+            uint64_t low = ((uint64_t)(simSeed & 0xFFFF) << 8) | (uint64_t)(simNoise(127) + 128);
+            low = (low << 8 | (uint64_t)(simNoise(127) + 128)) & 0xFFFFFF;
+            uint64_t oui = random ? (0xC00000 | (uint64_t)(simSeed >> 8 & 0x3FFFFF)) :
+                                    0x100000 + vendorPopularity.draw() * 0x1111;
+            device.address = oui << 24 | low;
+            device.addressType = random ? HAL_ADDR_RANDOM : HAL_ADDR_PUBLIC;
+            float distance = 1.0f + (simNoise(1000) + 1000) / 2000.0f * 40.0f;
+            device.rssi = -45.0f - 25.0f * log10f(distance);
+        }
+
+        // Pre-draw the stream so only the sketches are timed
+        ZipfTable chattiness(deviceCount, SURVEY_BENCH_ZIPF);
+        std::vector<SurveySample> stream(SURVEY_BENCH_ADVERTS);
+        for (uint32_t i = 0; i < SURVEY_BENCH_ADVERTS; i++) {
+            const SurveyBenchDevice& device = devices[chattiness.draw()];
+            int rssi = (int)lroundf(device.rssi + 4.0f * sweepGaussian());
+            stream[i].address = device.address;
+            stream[i].addressType = device.addressType;
+            stream[i].rssi = (int8_t)(rssi < -127 ? -127 : rssi > 0 ? 0 : rssi);
+            stream[i].timestamp = i / 10;
+        }
+
+        surveyDevices.reset();
+        surveyStrongest.reset();
+        surveyVendors.reset();
+        auto start = std::chrono::steady_clock::now();
+        for (const SurveySample& sample : stream) {
+            surveyRing.push(sample);
+            trackerSurveyUpdate();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::unordered_map<uint64_t, SurveyBenchExact> exact, exactVendors;
+        for (const SurveySample& sample : stream) {
+            SurveyBenchExact& e = exact[sample.address];
+            e.count++;
+            if (sample.rssi > e.peak) e.peak = sample.rssi;
+            if (sample.addressType == HAL_ADDR_PUBLIC) exactVendors[sample.address >> 24].count++;
+        }
+
+        SurveyEntry busiest[20], strongest[10], vendors[10];
+        size_t busiestCount = surveyDevices.sorted(busiest, 20);
+        size_t strongestCount = surveyStrongest.sorted(strongest, 10);
+        size_t vendorCount = surveyVendors.sorted(vendors, 10);
+        double countError = 0;
+        for (size_t i = 0; i < busiestCount; i++) {
+            double truth = exact[busiest[i].key].count;
+            countError = std::max(countError, (busiest[i].count - truth) / truth);
+        }
+        // A hash map node per device: key, tallies, next pointer and bucket
+        double exactKb = exact.size() * (sizeof(uint64_t) + sizeof(SurveyEntry) + 2 * sizeof(void*)) / 1024.0;
+        double sketchKb = (sizeof(surveyDevices) + sizeof(surveyStrongest) + sizeof(surveyVendors)) / 1024.0;
+        printf("%8u %9u %7.0f%% %7.0f%% %8.1f%% %8.0f%% %8.0f%% %10.1f %9.1f %9.1f\n", (unsigned)deviceCount,
+               (unsigned)SURVEY_BENCH_ADVERTS,
+               100 * surveyRecall(exact, busiest, busiestCount, 10, surveyExactCount),
+               100 * surveyRecall(exact, busiest, busiestCount, 20, surveyExactCount), 100 * countError,
+               100 * surveyRecall(exact, strongest, strongestCount, 10, surveyExactPeak),
+               100 * surveyRecall(exactVendors, vendors, vendorCount, 10, surveyExactCount),
+               seconds * 1e9 / SURVEY_BENCH_ADVERTS, sketchKb, exactKb);
+    }
+    return 0;
+}
+
+// Boot sequences as setup() runs them, from power-on to tracking
+#define BOOT_AP_SETTLE_MS 2000        // Old startConfigMode(): delay after softAP()
+#define BOOT_CONFIG_WINDOW_MS 20000   // CONFIG_TIMEOUT, no client connected
+#define BOOT_BENCH_LIMIT_MS 60000
+#define BOOT_ADVERT_PHASE_MS 37       // The target advertises out of step with the boot
+
+enum BootPath {
+    BOOT_CONFIG_SETTLE,      // Config portal with the AP settle delay (before fast boot)
+    BOOT_CONFIG,             // Config portal: no targets saved, or the portal requested
+    BOOT_FAST                // Targets saved: tracking straight away
+};
+
+// Power-on to the first tracking scan and to the first acquisition of a
+// target advertising every SIM_ADVERT_PERIOD_MS at -60 dBm
+int runBootBench() {
+    static const char* names[] = { "config + AP settle", "config", "fast boot" };
+    halSimQuiet(true);
+    trackerSetTargets(SIM_TARGET, strlen(SIM_TARGET));
+
+    printf("%-20s %14s %18s\n", "path", "first_scan_ms", "first_acquired_ms");
+    for (uint8_t path = BOOT_CONFIG_SETTLE; path <= BOOT_FAST; path++) {
+        uint32_t powerOn = halMillis();
+        bootFirstScanMs = 0;
+        bootFirstAcquiredMs = 0;
+        if (path != BOOT_FAST) {
+            playPatternBlocking(STARTUP_PATTERN);
+            if (path == BOOT_CONFIG_SETTLE) halDelay(BOOT_AP_SETTLE_MS);
+            trackerSurveyStart();
+            uint32_t configStart = halMillis();
+            while (halMillis() - configStart < BOOT_CONFIG_WINDOW_MS) {
+                trackerSurveyUpdate();
+                halSimAdvance(1000);
+            }
+        }
+        trackerStart();
+
+        while (bootFirstAcquiredMs == 0 && halMillis() - powerOn < BOOT_BENCH_LIMIT_MS) {
+            if ((halMillis() - powerOn) % SIM_ADVERT_PERIOD_MS == BOOT_ADVERT_PHASE_MS) {
+                HalAdvert advert = {};
+                advert.address = SIM_TARGET_KEY;
+                advert.rssi = -60;
+                halSimAdvert(advert);
+            }
+            trackerUpdate();
+            trackerServiceUx();
+            halSimAdvance(1000);
+        }
+        printf("%-20s %14u %18u\n", names[path], (unsigned)(bootFirstScanMs - powerOn),
+               bootFirstAcquiredMs ? (unsigned)(bootFirstAcquiredMs - powerOn) : 0u);
+
+        // Let the ready and acquired patterns finish before the next boot
+        halScanStop();
+        for (int i = 0; i < 2000; i++) {
+            trackerServiceUx();
+            halSimAdvance(1000);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    halInit();
+    trackerInit();
+
+    const char* command = argc > 1 ? argv[1] : "walk";
+    if (strcmp(command, "gen") == 0 && argc == 5) {
+        return runGenerate((uint32_t)atoi(argv[2]), (uint32_t)atoi(argv[3]), argv[4]);
+    }
+    if (strcmp(command, "replay") == 0 && argc >= 3) {
+        bool realtime = false;
+        bool verbose = false;
+        bool metrics = false;
+        const char* targetList = SYNTH_TARGET;
+        for (int i = 3; i < argc; i++) {
+            if (strcmp(argv[i], "--realtime") == 0) realtime = true;
+            else if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+            else if (strcmp(argv[i], "--metrics") == 0) metrics = true;
+            else if (strcmp(argv[i], "--targets") == 0 && i + 1 < argc) targetList = argv[++i];
+        }
+        return runReplay(argv[2], realtime, targetList, verbose, metrics);
+    }
+    if (strcmp(command, "bench") == 0) {
+        return runBench();
+    }
+    if (strcmp(command, "keybench") == 0) {
+        return runKeyBench();
+    }
+    if (strcmp(command, "tablebench") == 0) {
+        return runTableBench();
+    }
+    if (strcmp(command, "matchbench") == 0) {
+        return runMatchBench();
+    }
+    if (strcmp(command, "scanbench") == 0) {
+        return runScanBench();
+    }
+    if (strcmp(command, "curvetest") == 0) {
+        return runCurveTest();
+    }
+    if (strcmp(command, "seqtest") == 0) {
+        return runSeqTest();
+    }
+    if (strcmp(command, "telemetrybench") == 0) {
+        return runTelemetryBench();
+    }
+    if (strcmp(command, "acceptbench") == 0) {
+        return runAcceptBench();
+    }
+    if (strcmp(command, "rssibench") == 0) {
+        return runRssiBench();
+    }
+    if (strcmp(command, "irkbench") == 0) {
+        return runIrkBench();
+    }
+    if (strcmp(command, "sigbench") == 0) {
+        return runSigBench();
+    }
+    if (strcmp(command, "taskbench") == 0) {
+        return runTaskBench();
+    }
+    if (strcmp(command, "logbench") == 0) {
+        return runLogBench();
+    }
+    if (strcmp(command, "sweepbench") == 0) {
+        return runSweepBench();
+    }
+    if (strcmp(command, "trendbench") == 0) {
+        return runTrendBench();
+    }
+    if (strcmp(command, "surveybench") == 0) {
+        return runSurveyBench();
+    }
+    if (strcmp(command, "bootbench") == 0) {
+        return runBootBench();
+    }
+    if (strcmp(command, "recbench") == 0) {
+        return runRecBench(argc > 2 ? argv[2] : nullptr);
+    }
+    if (strcmp(command, "walk") == 0) {
+        return runWalk(argc > 2 ? argv[2] : nullptr);
+    }
+    return runWalk(command);
+}
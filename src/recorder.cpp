@@ -0,0 +1,269 @@
+#include "recorder.h"
+#include <LittleFS.h>
+#include <atomic>
+#include "tracker.h"
+#include "session_log.h"
+#include "metrics.h"
+#include "log.h"
+
+bool recordSessions = true;
+
+bool recorderMounted = false;
+uint32_t nextSession = 1;               // Number for the next file
+std::atomic<bool> startRequested{false};
+std::atomic<bool> stopRequested{false};
+
+// Recorder task only
+bool recorderActive = false;            // A session is open (file opened lazily)
+File sessionFile;
+uint32_t sessionNumber = 0;
+uint16_t chunkSequence = 0;
+SessionChunk chunk;
+bool chunkOpen = false;
+uint32_t reportedSessionDrops = 0;
+
+// Totals for printRecorderReport()
+uint32_t recorderBytes = 0;
+uint32_t recorderChunks = 0;
+uint32_t recorderWriteErrors = 0;
+uint32_t recorderMaxWriteUs = 0;        // Worst chunk write + flush since the last report
+
+void sessionFileName(uint32_t session, char* path, size_t size) {
+    snprintf(path, size, RECORDER_DIR "/%08u.fxs", (unsigned)session);
+}
+
+// Numbers of the recorded files, ascending; returns the count
+size_t listSessions(uint32_t* numbers, size_t max) {
+    size_t count = 0;
+    File dir = LittleFS.open(RECORDER_DIR);
+    if (!dir || !dir.isDirectory()) return 0;
+    for (File file = dir.openNextFile(); file && count < max; file = dir.openNextFile()) {
+        const char* name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        char* end;
+        unsigned long number = strtoul(name, &end, 10);
+        if (end == name || strcmp(end, ".fxs") != 0) continue;
+
+        // Insertion sort: a few dozen files at most
+        size_t i = count++;
+        for (; i > 0 && numbers[i - 1] > number; i--) numbers[i] = numbers[i - 1];
+        numbers[i] = (uint32_t)number;
+    }
+    return count;
+}
+
+bool recorderBegin() {
+    if (recorderMounted) return true;
+    if (!LittleFS.begin(true)) {
+        LOG_ERROR("Recorder: unable to mount LittleFS");
+        return false;
+    }
+    if (!LittleFS.exists(RECORDER_DIR)) LittleFS.mkdir(RECORDER_DIR);
+
+    uint32_t numbers[RECORDER_MAX_FILES];
+    size_t count = listSessions(numbers, RECORDER_MAX_FILES);
+    if (count) nextSession = numbers[count - 1] + 1;
+    recorderMounted = true;
+    LOG_INFO("Recorder: %u sessions, %u of %u KB used", (unsigned)count, (unsigned)(LittleFS.usedBytes() / 1024),
+             (unsigned)(LittleFS.totalBytes() / 1024));
+    return true;
+}
+
+// Make room for a new file: drop the oldest past the file count or space budget
+void enforceBudget() {
+    uint32_t numbers[RECORDER_MAX_FILES];
+    size_t count = listSessions(numbers, RECORDER_MAX_FILES);
+    size_t oldest = 0;
+    while (oldest < count && (count - oldest >= RECORDER_MAX_FILES ||
+                              LittleFS.usedBytes() * 100 > LittleFS.totalBytes() * RECORDER_BUDGET_PERCENT)) {
+        char path[32];
+        sessionFileName(numbers[oldest++], path, sizeof(path));
+        LittleFS.remove(path);
+        LOG_INFO("Recorder: removed %s", path);
+    }
+}
+
+bool openSessionFile(uint32_t now) {
+    enforceBudget();
+    char path[32];
+    sessionFileName(nextSession, path, sizeof(path));
+    sessionFile = LittleFS.open(path, "w");
+    if (!sessionFile) {
+        LOG_ERROR("Recorder: unable to create %s", path);
+        return false;
+    }
+    uint8_t header[SESSION_FILE_HEADER_SIZE];
+    sessionFile.write(header, encodeSessionHeader(nextSession, now, header));
+    sessionFile.flush();
+    sessionNumber = nextSession++;
+    chunkSequence = 0;
+    LOG_INFO("Recorder: writing %s", path);
+    return true;
+}
+
+// Write the chunk in progress as one block and flush it, so the file always
+// ends at a complete chunk
+void writeChunk(uint32_t now) {
+    if (!chunkOpen) return;
+    chunkOpen = false;
+    if (!sessionFile && !openSessionFile(now)) {
+        recorderWriteErrors++;
+        return;
+    }
+
+    size_t length = chunk.finish(chunkSequence++);
+    uint32_t start = micros();
+    size_t written = sessionFile.write(chunk.bytes(), length);
+    sessionFile.flush();
+    uint32_t elapsed = micros() - start;
+    METRIC_OBSERVE_US(metricFlashWriteUs, elapsed);
+    if (elapsed > recorderMaxWriteUs) recorderMaxWriteUs = elapsed;
+
+    if (written != length) {
+        // Filesystem full or failing: close, the next chunk tries a new file
+        LOG_ERROR("Recorder: write failed (%u of %u bytes)", (unsigned)written, (unsigned)length);
+        recorderWriteErrors++;
+        sessionFile.close();
+        return;
+    }
+    recorderBytes += length;
+    recorderChunks++;
+
+    // Rotate: the next chunk opens a new file
+    if (sessionFile.size() >= RECORDER_FILE_MAX) {
+        sessionFile.close();
+    }
+}
+
+void addEvent(const SessionEvent& event, uint32_t now) {
+    if (!chunkOpen) {
+        chunk.begin(event.timestamp);
+        chunkOpen = true;
+    }
+    if (!chunk.add(event)) {
+        writeChunk(now);
+        chunk.begin(event.timestamp);
+        chunkOpen = true;
+        chunk.add(event);
+    }
+}
+
+void recorderStart() {
+    if (!recordSessions || !recorderMounted) return;
+    // Events queue up from here; the task opens the file on its next pass
+    sessionRecording = true;
+    startRequested = true;
+}
+
+void recorderService() {
+    uint32_t now = millis();
+    if (startRequested.exchange(false)) {
+        // A new session closes the previous file; its events go in first
+        SessionEvent event;
+        while (recorderActive && sessionRing.pop(event)) addEvent(event, now);
+        writeChunk(now);
+        if (sessionFile) sessionFile.close();
+        recorderActive = true;
+        reportedSessionDrops = sessionRing.overflows();
+
+        // Tracking may have started before the recorder; the session opens here
+        event = {};
+        event.type = SESSION_MODE;
+        event.timestamp = now;
+        event.arg = SESSION_MODE_TRACKING;
+        addEvent(event, now);
+    }
+    if (!recorderActive) return;
+
+    // Events lost to a full ring are recorded as a count in their place
+    uint32_t drops = sessionRing.overflows();
+    if (drops != reportedSessionDrops) {
+        SessionEvent event = {};
+        event.type = SESSION_DROPPED;
+        event.timestamp = now;
+        event.value = drops - reportedSessionDrops;
+        addEvent(event, now);
+        LOG_WARN("Recorder: dropped %u events", (unsigned)event.value);
+        reportedSessionDrops = drops;
+    }
+
+    SessionEvent event;
+    while (sessionRing.pop(event)) {
+        addEvent(event, now);
+    }
+    if (chunkOpen && (int32_t)(now - chunk.started()) >= RECORDER_FLUSH_MS) {
+        writeChunk(now);
+    }
+
+    if (stopRequested) {
+        sessionRecording = false;
+        while (sessionRing.pop(event)) addEvent(event, now);
+        event = {};
+        event.type = SESSION_MODE;
+        event.timestamp = now;
+        event.arg = SESSION_MODE_STOPPED;
+        addEvent(event, now);
+        writeChunk(now);
+        if (sessionFile) sessionFile.close();
+        recorderActive = false;
+        stopRequested = false;
+    }
+}
+
+void recorderStop(uint32_t timeoutMs) {
+    if (!sessionRecording) return;
+    stopRequested = true;
+    uint32_t start = millis();
+    while (stopRequested && millis() - start < timeoutMs) {
+        delay(1);
+    }
+}
+
+String recorderListJSON() {
+    String json = "{\"sessions\":[";
+    if (recorderBegin()) {
+        uint32_t numbers[RECORDER_MAX_FILES];
+        size_t count = listSessions(numbers, RECORDER_MAX_FILES);
+        for (size_t i = 0; i < count; i++) {
+            char path[32];
+            sessionFileName(numbers[i], path, sizeof(path));
+            File file = LittleFS.open(path);
+            if (i > 0) json += ",";
+            json += "{\"session\":";
+            json += String(numbers[i]);
+            json += ",\"bytes\":";
+            json += String(file ? (unsigned)file.size() : 0u);
+            json += "}";
+        }
+        json += "],\"usedKB\":";
+        json += String((unsigned)(LittleFS.usedBytes() / 1024));
+        json += ",\"totalKB\":";
+        json += String((unsigned)(LittleFS.totalBytes() / 1024));
+    } else {
+        json += "]";
+    }
+    json += ",\"recording\":";
+    json += sessionRecording ? "true" : "false";
+    json += "}";
+    return json;
+}
+
+bool recorderPath(uint32_t session, char* path, size_t size) {
+    if (!recorderBegin()) return false;
+    sessionFileName(session, path, size);
+    return LittleFS.exists(path);
+}
+
+void printRecorderReport() {
+    static uint32_t lastBytes = 0;
+    static uint32_t lastChunks = 0;
+    if (!sessionRecording) return;
+
+    LOG_INFO("Recorder: file %08u, %u chunks / %u KB since last report, flash write max %u us, %u errors",
+             (unsigned)sessionNumber, (unsigned)(recorderChunks - lastChunks),
+             (unsigned)((recorderBytes - lastBytes) / 1024), (unsigned)recorderMaxWriteUs,
+             (unsigned)recorderWriteErrors);
+    lastBytes = recorderBytes;
+    lastChunks = recorderChunks;
+    recorderMaxWriteUs = 0;
+}
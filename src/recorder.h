@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Session recorder: writes the tracking core's session events (sessionRing,
+// format in session_log.h) to LittleFS from a low-priority task, so the
+// detection path only ever pushes to a ring.
+//
+// Events are packed into one chunk in RAM and written out whole when it fills
+// or RECORDER_FLUSH_MS after its first event, then flushed so the file on
+// flash always ends at a complete chunk. Files are append-only and numbered
+// upwards, never reused; past RECORDER_FILE_MAX a new file starts, and the
+// oldest files go once the set outgrows RECORDER_BUDGET_PERCENT of the
+// filesystem. Writes stay few and large, and LittleFS spreads them over
+// fresh blocks.
+//
+// While SPI flash is written or erased the instruction cache is off on both
+// cores, so tasks running from flash (NimBLE, detection) pause too; the
+// detection ring absorbs that, and foxhunt_flash_write_us shows how long.
+
+#define RECORDER_DIR "/rec"
+#define RECORDER_FILE_MAX (64 * 1024)     // Start a new file beyond this size
+#define RECORDER_MAX_FILES 64
+#define RECORDER_BUDGET_PERCENT 75        // Share of the filesystem sessions may use
+#define RECORDER_FLUSH_MS 5000            // Longest a recorded event waits in RAM
+
+extern bool recordSessions;              // Setting: record every hunt
+
+// Mount the filesystem and find the next file number. Safe to call again.
+bool recorderBegin();
+
+// Ask the recorder task to open a new session file and set sessionRecording
+void recorderStart();
+
+// Drain sessionRing and write due chunks; called from the recorder task
+void recorderService();
+
+// Close the session (written and flushed) before a restart; waits up to timeoutMs
+void recorderStop(uint32_t timeoutMs);
+
+// Recorded files as JSON: [{"session":n,"bytes":size}, ...], oldest first
+String recorderListJSON();
+
+// Path of a recorded session file; false if there is no such file
+bool recorderPath(uint32_t session, char* path, size_t size);
+
+// Log bytes written, chunk count and flash write latency since the last call
+void printRecorderReport();
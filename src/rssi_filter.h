@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+
+// Per-target RSSI smoothing. Every filter runs in constant time per sample
+// with fixed-size state, so it can sit in the detection path.
+
+enum RssiFilterType : uint8_t {
+    RSSI_FILTER_NONE = 0,   // Raw RSSI, most recent sample only
+    RSSI_FILTER_EMA = 1,    // Exponential moving average
+    RSSI_FILTER_MEDIAN = 2, // Sliding median over RSSI_MEDIAN_WINDOW samples
+    RSSI_FILTER_KALMAN = 3, // 1-D Kalman filter with a random-walk model
+    RSSI_FILTER_COUNT
+};
+
+#define RSSI_MEDIAN_WINDOW 5
+#define RSSI_EMA_ALPHA 0.3f      // Weight of the newest sample
+#define RSSI_KALMAN_Q 0.5f       // Process noise: how fast true RSSI drifts (dB^2/sample)
+#define RSSI_KALMAN_R 16.0f      // Measurement noise: multipath jitter (dB^2)
+
+static inline const char* rssiFilterName(uint8_t type) {
+    switch (type) {
+        case RSSI_FILTER_NONE: return "None";
+        case RSSI_FILTER_EMA: return "EMA";
+        case RSSI_FILTER_MEDIAN: return "Median";
+        case RSSI_FILTER_KALMAN: return "Kalman";
+        default: return "Unknown";
+    }
+}
+
+struct RssiFilter {
+    float estimate;                       // EMA/Kalman state
+    float variance;                       // Kalman error covariance
+    int8_t window[RSSI_MEDIAN_WINDOW];    // Median history
+    uint8_t count;                        // Samples seen, saturates at window size
+    uint8_t next;                         // Next median slot to overwrite
+
+    void reset() {
+        estimate = 0;
+        variance = 0;
+        count = 0;
+        next = 0;
+    }
+
+    // Feed one raw sample and return the filtered RSSI
+    int update(uint8_t type, int rssi) {
+        switch (type) {
+            case RSSI_FILTER_EMA:
+                if (count == 0) {
+                    estimate = (float)rssi;
+                    count = 1;
+                } else {
+                    estimate += RSSI_EMA_ALPHA * ((float)rssi - estimate);
+                }
+                return roundToInt(estimate);
+
+            case RSSI_FILTER_MEDIAN: {
+                window[next] = (int8_t)rssi;
+                next = (uint8_t)((next + 1) % RSSI_MEDIAN_WINDOW);
+                if (count < RSSI_MEDIAN_WINDOW) count++;
+
+                // Insertion sort of at most RSSI_MEDIAN_WINDOW samples
+                int8_t sorted[RSSI_MEDIAN_WINDOW];
+                for (uint8_t i = 0; i < count; i++) {
+                    int8_t v = window[i];
+                    uint8_t j = i;
+                    while (j > 0 && sorted[j - 1] > v) {
+                        sorted[j] = sorted[j - 1];
+                        j--;
+                    }
+                    sorted[j] = v;
+                }
+                if (count & 1) return sorted[count / 2];
+                // Midpoint rounded half away from zero like roundToInt(); a plain
+                // / 2 truncates the negative sum toward zero, +0.5 dB high
+                int sum = sorted[count / 2 - 1] + sorted[count / 2];
+                return (sum < 0 ? sum - 1 : sum + 1) / 2;
+            }
+
+            case RSSI_FILTER_KALMAN:
+                if (count == 0) {
+                    estimate = (float)rssi;
+                    variance = RSSI_KALMAN_R;
+                    count = 1;
+                } else {
+                    variance += RSSI_KALMAN_Q;
+                    float gain = variance / (variance + RSSI_KALMAN_R);
+                    estimate += gain * ((float)rssi - estimate);
+                    variance *= (1.0f - gain);
+                }
+                return roundToInt(estimate);
+
+            default:
+                return rssi;
+        }
+    }
+
+private:
+    static int roundToInt(float v) {
+        return (int)(v < 0 ? v - 0.5f : v + 0.5f);
+    }
+};
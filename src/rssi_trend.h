@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Warmer/colder detection from the RSSI slope.
+// A least-squares line is fitted to the samples of the last TREND_WINDOW_MS.
+// The fit keeps running sums of t, y, t*t and t*y, adding each new sample and
+// subtracting each one that ages out, so an update is O(1) however many
+// samples are in the window. Times are kept relative to a base that moves up
+// now and then so the integer sums never overflow and stay exact.
+//
+// The slope (dB/s) is turned into a trend with hysteresis: it must reach the
+// threshold to call warmer or colder, and fall under half of it to go back
+// to steady, so fading does not make the cue flicker.
+
+#define TREND_WINDOW_MS 3000          // Fit over this much history
+#define TREND_MAX_SAMPLES 64          // Ring size, power of two; fast advertisers shorten the window
+#define TREND_MIN_SAMPLES 5           // Fewer samples give no trend
+#define TREND_MIN_SPAN_MS 1000        // Nor does a window shorter than this
+#define TREND_REBASE_MS (1UL << 20)   // Move the time base once samples are this far past it
+
+enum Trend {
+    TREND_STEADY,
+    TREND_WARMER,    // RSSI rising: closing in
+    TREND_COLDER     // RSSI falling: moving away
+};
+
+inline const char* trendName(uint8_t trend) {
+    switch (trend) {
+        case TREND_WARMER: return "Warmer";
+        case TREND_COLDER: return "Colder";
+        default: return "Steady";
+    }
+}
+
+class TrendEstimator {
+    static_assert((TREND_MAX_SAMPLES & (TREND_MAX_SAMPLES - 1)) == 0, "TREND_MAX_SAMPLES must be a power of two");
+
+public:
+    void reset() {
+        head = 0;
+        count = 0;
+        sumT = sumY = sumTT = sumTY = 0;
+        state = TREND_STEADY;
+    }
+
+    // Add a sample (millis(), dBm) and return the trend for a threshold in dB/s
+    uint8_t update(uint32_t timestamp, int rssi, float thresholdDbPerSecond) {
+        if (count == 0) base = timestamp;
+
+        // Age out old samples, and the oldest if the ring is full
+        while (count > 0 && (timestamp - (base + times[tail()]) > TREND_WINDOW_MS || count == TREND_MAX_SAMPLES)) {
+            remove(tail());
+            count--;
+        }
+        if (count == 0) base = timestamp;
+        if (timestamp - base >= TREND_REBASE_MS) rebase(timestamp);
+
+        size_t slot = head;
+        head = (head + 1) & (TREND_MAX_SAMPLES - 1);
+        times[slot] = timestamp - base;
+        values[slot] = (int16_t)rssi;
+        count++;
+        sumT += times[slot];
+        sumY += rssi;
+        sumTT += (int64_t)times[slot] * times[slot];
+        sumTY += (int64_t)times[slot] * rssi;
+
+        return classify(thresholdDbPerSecond);
+    }
+
+    // Least-squares slope in dB/s, 0 without enough samples
+    float slope() const {
+        if (!ready()) return 0;
+        int64_t denominator = (int64_t)count * sumTT - sumT * sumT;
+        if (denominator <= 0) return 0;
+        return 1000.0f * (float)((int64_t)count * sumTY - sumT * sumY) / (float)denominator;
+    }
+
+    bool ready() const {
+        return count >= TREND_MIN_SAMPLES && times[newest()] - times[tail()] >= TREND_MIN_SPAN_MS;
+    }
+
+    uint8_t trend() const { return state; }
+    size_t samples() const { return count; }
+
+private:
+    size_t tail() const { return (head - count) & (TREND_MAX_SAMPLES - 1); }
+    size_t newest() const { return (head - 1) & (TREND_MAX_SAMPLES - 1); }
+
+    void remove(size_t slot) {
+        sumT -= times[slot];
+        sumY -= values[slot];
+        sumTT -= (int64_t)times[slot] * times[slot];
+        sumTY -= (int64_t)times[slot] * values[slot];
+    }
+
+    // Move the time base up to the oldest sample and rebuild the sums
+    void rebase(uint32_t timestamp) {
+        uint32_t shift = count ? times[tail()] : timestamp - base;
+        base += shift;
+        sumT = sumY = sumTT = sumTY = 0;
+        for (size_t i = 0; i < count; i++) {
+            size_t slot = (tail() + i) & (TREND_MAX_SAMPLES - 1);
+            times[slot] -= shift;
+            sumT += times[slot];
+            sumY += values[slot];
+            sumTT += (int64_t)times[slot] * times[slot];
+            sumTY += (int64_t)times[slot] * values[slot];
+        }
+    }
+
+    uint8_t classify(float threshold) {
+        if (!ready()) return state = TREND_STEADY;
+        float s = slope();
+        if (s >= threshold) {
+            state = TREND_WARMER;
+        } else if (s <= -threshold) {
+            state = TREND_COLDER;
+        } else if ((state == TREND_WARMER && s < threshold / 2) || (state == TREND_COLDER && s > -threshold / 2)) {
+            state = TREND_STEADY;
+        }
+        return state;
+    }
+
+    uint32_t times[TREND_MAX_SAMPLES];    // ms since base
+    int16_t values[TREND_MAX_SAMPLES];
+    size_t head = 0;
+    size_t count = 0;
+    uint32_t base = 0;
+    int64_t sumT = 0, sumY = 0, sumTT = 0, sumTY = 0;
+    uint8_t state = TREND_STEADY;
+};
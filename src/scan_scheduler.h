@@ -0,0 +1,256 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// Adaptive BLE scan scheduling.
+// Picks scan interval, window and active/passive scanning from the tracking
+// state, so the radio runs at full duty only while a target is in range:
+//
+//   IDLE       nothing seen for SCAN_IDLE_AFTER - lowest duty
+//   SEARCHING  no target in range
+//   REACQUIRE  target lost in the last SCAN_REACQUIRE_TIME - likely still close
+//   ACQUIRED   target in range - full duty, entered on the first detection
+//   FOLLOW     target in range and advertising fast enough that half duty
+//              still sees it at least SCAN_FOLLOW_RATE / 2 times a second
+//   CLOSE_IN   filtered RSSI at or above SCAN_CLOSE_IN_RSSI - full duty
+//
+// Scanning is passive unless scan responses are wanted. Active scanning sends
+// a scan request to every scannable advertiser in range, which doubles the
+// airtime and host reports in a crowd, and NimBLE holds back the result until
+// the response arrives. The response mode decides when that is worth it:
+//
+//   OFF        always passive (default)
+//   TARGETS    active only while a target is in range (ACQUIRED, FOLLOW, CLOSE_IN)
+//   ALL        always active
+//
+// Rules that match on scan response data override the mode with
+// requireScanResponses(), since they cannot match without the response.
+//
+// A level is held for at least SCAN_MIN_DWELL so the scan is not restarted on
+// every flicker, except that acquiring a target switches at once. Current draw is
+// estimated per level from the duty cycle and scan-request rate, with
+// datasheet-level figures for the ESP32-S3.
+
+#define SCAN_IDLE_AFTER 300000        // ms without a detection before IDLE
+#define SCAN_REACQUIRE_TIME 30000     // ms after a loss spent in REACQUIRE
+#define SCAN_SETTLE_TIME 2000         // ms at full duty after acquisition before FOLLOW
+#define SCAN_FOLLOW_RATE 8            // Target adverts/s needed for FOLLOW
+#define SCAN_CLOSE_IN_RSSI -60
+#define SCAN_MIN_DWELL 500            // ms a level is held before changing again
+#define SCAN_RATE_PERIOD 1000         // Advert rate measurement period (ms)
+
+// Current model (mA, ESP32-S3 at 240 MHz, Wi-Fi off)
+#define SCAN_BASE_MA 40.0f            // CPU running, radio idle
+#define SCAN_RX_MA 60.0f              // Extra while the receiver is on
+#define SCAN_REQUEST_MAS 0.024f       // mA*s per scan request/response exchange
+
+enum ScanLevel : uint8_t {
+    SCAN_IDLE,
+    SCAN_SEARCHING,
+    SCAN_REACQUIRE,
+    SCAN_ACQUIRED,
+    SCAN_FOLLOW,
+    SCAN_CLOSE_IN,
+    SCAN_LEVEL_COUNT,
+    SCAN_ADAPTIVE = SCAN_LEVEL_COUNT   // force(): return to adaptive scheduling
+};
+
+enum ScanResponseMode : uint8_t {
+    SCAN_RESPONSE_OFF,
+    SCAN_RESPONSE_TARGETS,
+    SCAN_RESPONSE_ALL,
+    SCAN_RESPONSE_MODE_COUNT
+};
+
+static inline const char* scanResponseName(uint8_t mode) {
+    switch (mode) {
+        case SCAN_RESPONSE_OFF: return "Off";
+        case SCAN_RESPONSE_TARGETS: return "Targets";
+        case SCAN_RESPONSE_ALL: return "All";
+        default: return "Unknown";
+    }
+}
+
+struct ScanPolicy {
+    uint16_t intervalMs;
+    uint16_t windowMs;
+    bool active;          // In the table: active in SCAN_RESPONSE_TARGETS mode
+};
+
+static const ScanPolicy SCAN_POLICIES[SCAN_LEVEL_COUNT] = {
+    { 320, 32, false },   // IDLE       10%
+    { 120, 30, false },   // SEARCHING  25%
+    { 60,  30, false },   // REACQUIRE  50%
+    { 16,  15, true },    // ACQUIRED   94%
+    { 32,  16, true },    // FOLLOW     50%
+    { 16,  15, true },    // CLOSE_IN   94%
+};
+
+static inline const char* scanLevelName(uint8_t level) {
+    switch (level) {
+        case SCAN_IDLE: return "Idle";
+        case SCAN_SEARCHING: return "Searching";
+        case SCAN_REACQUIRE: return "Reacquire";
+        case SCAN_ACQUIRED: return "Acquired";
+        case SCAN_FOLLOW: return "Follow";
+        case SCAN_CLOSE_IN: return "Close-in";
+        default: return "Unknown";
+    }
+}
+
+class ScanScheduler {
+public:
+    void begin(uint32_t now) {
+        current = forced < SCAN_LEVEL_COUNT ? forced : (uint8_t)SCAN_SEARCHING;
+        levelSince = now;
+        lastDetected = now;
+        acquiredAt = now;
+        everDetected = false;
+        wasDetected = false;
+        rateStart = now;
+        lastAdverts = adverts.load(std::memory_order_relaxed);
+        lastDetections = detections;
+        advertRate = 0;
+        targetRate = 0;
+        lastAccount = now;
+        for (int i = 0; i < SCAN_LEVEL_COUNT; i++) {
+            timeIn[i] = 0;
+            chargeUaMs[i] = 0;
+        }
+    }
+
+    // BLE task: every advert delivered by the scan
+    void countAdvert() { adverts.fetch_add(1, std::memory_order_relaxed); }
+
+    // Detection task: every detection applied to a target
+    void countDetection() { detections++; }
+
+    // Pin a level for benchmarking, SCAN_ADAPTIVE to resume
+    void force(uint8_t level) { forced = level; }
+
+    // When to scan actively; takes effect with the next policy()
+    void setResponseMode(uint8_t mode) { responses = mode < SCAN_RESPONSE_MODE_COUNT ? mode : (uint8_t)SCAN_RESPONSE_OFF; }
+    uint8_t responseMode() const { return responses; }
+
+    // Scan actively at every level regardless of the mode (scan response rules)
+    void requireScanResponses(bool required) { responsesRequired = required; }
+
+    // Re-evaluate from the tracking state (detection task).
+    // Returns true when the scan must be restarted with policy(): a level change
+    // alone is not enough, since several levels share the same parameters and
+    // every restart loses adverts.
+    bool update(uint32_t now, bool detected, int nearestRssi) {
+        account(now);
+        measureRates(now);
+
+        if (detected) {
+            if (!wasDetected) acquiredAt = now;
+            lastDetected = now;
+            everDetected = true;
+        }
+        wasDetected = detected;
+
+        uint8_t next = forced < SCAN_LEVEL_COUNT ? forced : choose(now, detected, nearestRssi);
+        if (next == current) return false;
+        bool acquiring = next >= SCAN_ACQUIRED && current < SCAN_ACQUIRED;
+        if (!acquiring && now - levelSince < SCAN_MIN_DWELL) return false;
+        ScanPolicy before = policy();
+        current = next;
+        levelSince = now;
+        ScanPolicy after = policy();
+        return after.intervalMs != before.intervalMs || after.windowMs != before.windowMs ||
+               after.active != before.active;
+    }
+
+    uint8_t level() const { return current; }
+    ScanPolicy policy() const {
+        ScanPolicy p = SCAN_POLICIES[current];
+        p.active = scanActive(current);
+        return p;
+    }
+
+    bool scanActive(uint8_t level) const {
+        if (responsesRequired || responses == SCAN_RESPONSE_ALL) return true;
+        return responses == SCAN_RESPONSE_TARGETS && SCAN_POLICIES[level].active;
+    }
+    uint32_t advertsPerSecond() const { return advertRate; }
+    uint32_t targetAdvertsPerSecond() const { return targetRate; }
+
+    // Estimated average current for a level at the measured advert rate
+    float estimatedCurrent(uint8_t level) const {
+        const ScanPolicy& p = SCAN_POLICIES[level];
+        float duty = (float)p.windowMs / p.intervalMs;
+        float ma = SCAN_BASE_MA + SCAN_RX_MA * duty;
+        if (scanActive(level)) ma += advertRate * SCAN_REQUEST_MAS;
+        return ma;
+    }
+
+    // Time (ms) spent per level since begin()
+    uint32_t timeInLevel(uint8_t level) const { return timeIn[level]; }
+
+    // Average estimated current (mA) since begin()
+    float averageCurrent() const {
+        uint64_t time = 0;
+        uint64_t total = 0;
+        for (int i = 0; i < SCAN_LEVEL_COUNT; i++) {
+            time += timeIn[i];
+            total += chargeUaMs[i];
+        }
+        return time ? total / 1000.0f / time : estimatedCurrent(current);
+    }
+
+private:
+    uint8_t choose(uint32_t now, bool detected, int nearestRssi) const {
+        if (detected) {
+            if (nearestRssi >= SCAN_CLOSE_IN_RSSI) return SCAN_CLOSE_IN;
+            if (now - acquiredAt < SCAN_SETTLE_TIME) return SCAN_ACQUIRED;
+            // Hysteresis: FOLLOW needs the full rate, ACQUIRED resumes below half
+            if (current == SCAN_FOLLOW) return targetRate * 2 >= SCAN_FOLLOW_RATE ? SCAN_FOLLOW : SCAN_ACQUIRED;
+            return targetRate >= SCAN_FOLLOW_RATE ? SCAN_FOLLOW : SCAN_ACQUIRED;
+        }
+        if (everDetected && now - lastDetected < SCAN_REACQUIRE_TIME) return SCAN_REACQUIRE;
+        if (now - lastDetected >= SCAN_IDLE_AFTER) return SCAN_IDLE;
+        return SCAN_SEARCHING;
+    }
+
+    void measureRates(uint32_t now) {
+        uint32_t elapsed = now - rateStart;
+        if (elapsed < SCAN_RATE_PERIOD) return;
+        uint32_t count = adverts.load(std::memory_order_relaxed);
+        advertRate = (uint32_t)((uint64_t)(count - lastAdverts) * 1000 / elapsed);
+        // Detections are seen through the current duty cycle; scale to what the target sends
+        const ScanPolicy& p = SCAN_POLICIES[current];
+        targetRate = (uint32_t)((uint64_t)(detections - lastDetections) * 1000 * p.intervalMs / ((uint64_t)elapsed * p.windowMs));
+        lastAdverts = count;
+        lastDetections = detections;
+        rateStart = now;
+    }
+
+    void account(uint32_t now) {
+        uint32_t elapsed = now - lastAccount;
+        timeIn[current] += elapsed;
+        chargeUaMs[current] += (uint64_t)(estimatedCurrent(current) * 1000) * elapsed;
+        lastAccount = now;
+    }
+
+    std::atomic<uint32_t> adverts{0};
+    uint32_t detections = 0;
+    uint8_t current = SCAN_SEARCHING;
+    uint8_t forced = SCAN_ADAPTIVE;
+    uint8_t responses = SCAN_RESPONSE_OFF;
+    bool responsesRequired = false;
+    uint32_t levelSince = 0;
+    uint32_t lastDetected = 0;
+    uint32_t acquiredAt = 0;
+    bool everDetected = false;
+    bool wasDetected = false;
+    uint32_t rateStart = 0;
+    uint32_t lastAdverts = 0;
+    uint32_t lastDetections = 0;
+    uint32_t advertRate = 0;
+    uint32_t targetRate = 0;
+    uint32_t lastAccount = 0;
+    uint32_t timeIn[SCAN_LEVEL_COUNT] = {};
+    uint64_t chargeUaMs[SCAN_LEVEL_COUNT] = {};   // Estimated charge, uA*ms
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Session recording format.
+// Every hunt is written to flash as a file of fixed 8-byte records packed
+// into self-contained chunks. Each chunk carries its own base time and CRC, so
+// a chunk torn by a power cut is detected and dropped on its own and
+// everything before it still decodes. tools/decode_session.py reads it back.
+//
+// File header (SESSION_FILE_HEADER_SIZE bytes, little-endian):
+//   char[4] magic          "FXSL"
+//   uint16  version        SESSION_VERSION
+//   uint16  recordSize     SESSION_RECORD_SIZE
+//   uint32  session        file number, increasing across sessions
+//   uint32  startTime      millis() when the file was opened
+// Chunk:
+//   uint8   sync           SESSION_CHUNK_SYNC
+//   uint8   count          records in the chunk
+//   uint16  sequence       chunk number within the file
+//   uint32  baseTime       millis() the first record's delta counts from
+//   count x record
+//   uint32  crc            CRC-32 (IEEE) over the header and records
+// Record:
+//   uint8   type           SessionRecordType
+//   uint16  dt             ms since the previous record (or baseTime)
+//   uint8[5] payload       per type, see SessionRecordType
+// A gap longer than 65535 ms is bridged by a SESSION_TIME record.
+
+#define SESSION_VERSION 1
+#define SESSION_FILE_HEADER_SIZE 16
+#define SESSION_RECORD_SIZE 8
+#define SESSION_CHUNK_SYNC 0xF5
+#define SESSION_CHUNK_HEADER_SIZE 8
+#define SESSION_CHUNK_RECORDS 254     // Keeps a chunk within 2 KB, half a flash erase block
+#define SESSION_CHUNK_MAX (SESSION_CHUNK_HEADER_SIZE + SESSION_CHUNK_RECORDS * SESSION_RECORD_SIZE + 4)
+
+enum SessionRecordType {
+    SESSION_TIME = 1,        // uint32 millis()
+    SESSION_MODE,            // uint8 SessionMode
+    SESSION_HIT,             // uint16 target, int8 rssi, int8 filtered, uint8 last address octet
+    SESSION_ADDRESS_HIGH,    // uint16 target, first three address octets: device now followed
+    SESSION_ADDRESS_LOW,     // uint16 target, last three address octets (always follows ADDRESS_HIGH)
+    SESSION_ACQUIRED,        // uint16 target
+    SESSION_LOST,            // uint16 target
+    SESSION_BEEP,            // uint32 interval us (BEEP_SOLID / BEEP_SILENT as in beep_scheduler.h)
+    SESSION_TREND,           // uint8 Trend
+    SESSION_SCAN,            // uint8 ScanLevel
+    SESSION_BEARING,         // uint16 target, uint16 bearing (0xFFFF none), int8 contrast
+    SESSION_DROPPED          // uint32 events lost to a full ring since the last report
+};
+
+enum SessionMode {
+    SESSION_MODE_TRACKING,
+    SESSION_MODE_SWEEP,      // Sweep started
+    SESSION_MODE_STOPPED     // Recording closed (reset, or the session ended)
+};
+
+// One event from the tracking core, before encoding
+struct SessionEvent {
+    uint32_t timestamp;      // millis()
+    uint8_t type;            // SessionRecordType
+    uint8_t arg;             // MODE, TREND, SCAN
+    uint16_t target;
+    int8_t rssi;             // HIT
+    int8_t filtered;         // HIT; contrast for BEARING
+    uint16_t bearing;        // BEARING
+    uint32_t value;          // BEEP interval, DROPPED count
+    uint64_t address;        // HIT, ADDRESS_*
+};
+
+// Write the file header; returns SESSION_FILE_HEADER_SIZE
+static inline size_t encodeSessionHeader(uint32_t session, uint32_t startTime, uint8_t* out) {
+    memcpy(out, "FXSL", 4);
+    out[4] = (uint8_t)SESSION_VERSION;
+    out[5] = 0;
+    out[6] = SESSION_RECORD_SIZE;
+    out[7] = 0;
+    for (int i = 0; i < 4; i++) out[8 + i] = (uint8_t)(session >> (8 * i));
+    for (int i = 0; i < 4; i++) out[12 + i] = (uint8_t)(startTime >> (8 * i));
+    return SESSION_FILE_HEADER_SIZE;
+}
+
+static inline uint32_t sessionCrc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+    }
+    return ~crc;
+}
+
+// Builds one chunk in RAM; the recorder writes it out whole
+class SessionChunk {
+public:
+    void begin(uint32_t now) {
+        count = 0;
+        lastTime = now;
+        data[0] = SESSION_CHUNK_SYNC;
+        put32(data + 4, now);
+        startTime = now;
+    }
+
+    // Records an event needs, including a TIME record for a long gap
+    size_t recordsFor(const SessionEvent& event) const {
+        size_t records = event.type == SESSION_ADDRESS_HIGH ? 2 : 1;
+        return records + (timeOf(event) - lastTime > 0xFFFF ? 1 : 0);
+    }
+
+    // Encode an event; false (and nothing written) when the chunk cannot hold it
+    bool add(const SessionEvent& event) {
+        if (count + recordsFor(event) > SESSION_CHUNK_RECORDS) return false;
+        uint32_t timestamp = timeOf(event);
+        if (timestamp - lastTime > 0xFFFF) {
+            uint8_t* r = next(SESSION_TIME, timestamp);
+            put32(r, timestamp);
+        }
+
+        uint8_t* r = next(event.type, timestamp);
+        switch (event.type) {
+            case SESSION_TIME:
+                put32(r, timestamp);
+                break;
+            case SESSION_MODE:
+            case SESSION_TREND:
+            case SESSION_SCAN:
+                r[0] = event.arg;
+                break;
+            case SESSION_HIT:
+                put16(r, event.target);
+                r[2] = (uint8_t)event.rssi;
+                r[3] = (uint8_t)event.filtered;
+                r[4] = (uint8_t)event.address;
+                break;
+            case SESSION_ADDRESS_HIGH:
+                putAddress(r, event.target, event.address >> 24);
+                putAddress(next(SESSION_ADDRESS_LOW, timestamp), event.target, event.address);
+                break;
+            case SESSION_ACQUIRED:
+            case SESSION_LOST:
+                put16(r, event.target);
+                break;
+            case SESSION_BEEP:
+            case SESSION_DROPPED:
+                put32(r, event.value);
+                break;
+            case SESSION_BEARING:
+                put16(r, event.target);
+                put16(r + 2, event.bearing);
+                r[4] = (uint8_t)event.filtered;
+                break;
+        }
+        return true;
+    }
+
+    // Close the chunk with its sequence number and CRC; returns the bytes to write
+    size_t finish(uint16_t sequence) {
+        data[1] = (uint8_t)count;
+        put16(data + 2, sequence);
+        size_t length = SESSION_CHUNK_HEADER_SIZE + count * SESSION_RECORD_SIZE;
+        put32(data + length, sessionCrc32(data, length));
+        return length + 4;
+    }
+
+    const uint8_t* bytes() const { return data; }
+    size_t records() const { return count; }
+    uint32_t started() const { return startTime; }
+
+private:
+    // Events from different tasks can arrive slightly out of order; never step back
+    uint32_t timeOf(const SessionEvent& event) const {
+        return (int32_t)(event.timestamp - lastTime) < 0 ? lastTime : event.timestamp;
+    }
+
+    uint8_t* next(uint8_t type, uint32_t timestamp) {
+        uint8_t* r = data + SESSION_CHUNK_HEADER_SIZE + count++ * SESSION_RECORD_SIZE;
+        uint32_t dt = timestamp - lastTime;
+        if (dt > 0xFFFF) dt = 0;           // Preceded by a TIME record
+        lastTime = timestamp;
+        r[0] = type;
+        put16(r + 1, (uint16_t)dt);
+        memset(r + 3, 0, SESSION_RECORD_SIZE - 3);
+        return r + 3;
+    }
+
+    static void putAddress(uint8_t* p, uint16_t target, uint64_t octets) {
+        put16(p, target);
+        p[2] = (uint8_t)(octets >> 16);
+        p[3] = (uint8_t)(octets >> 8);
+        p[4] = (uint8_t)octets;
+    }
+
+    static void put16(uint8_t* p, uint16_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+    }
+
+    static void put32(uint8_t* p, uint32_t v) {
+        put16(p, (uint16_t)v);
+        put16(p + 2, (uint16_t)(v >> 16));
+    }
+
+    uint8_t data[SESSION_CHUNK_MAX];
+    size_t count = 0;
+    uint32_t lastTime = 0;
+    uint32_t startTime = 0;
+};
@@ -0,0 +1,376 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include "target_match.h"
+
+// Payload signature targets, for devices that rotate their address but
+// advertise something fixed. Rule forms (one per target line):
+//   MFG:004C            manufacturer data company ID
+//   MFG:004C:0215       company ID followed by these data bytes
+//   UUID:FD6F           16-bit service UUID (32-bit as 8 hex digits)
+//   UUID:0000FE2C-0000-1000-8000-00805F9B34FB  128-bit service UUID
+//   NAME:Tile           local name prefix, ASCII case-insensitive
+// Service UUIDs match in the UUID lists and in service data.
+//
+// Rules are compiled into one array sorted by (kind, key, bytes), so each
+// AD structure costs one binary search in its kind's range, name prefixes one
+// search per prefix length in use (a bitmask of lengths). match() walks the
+// raw AD structures once, straight from the scan buffer, with no allocation.
+// Storage is supplied by the caller so it can be placed in PSRAM.
+
+#define SIGNATURE_MAX 512
+#define SIGNATURE_DATA_MAX 29          // Longest AD field after type and length bytes
+#define SIGNATURE_NONE 0xFFFF
+
+// AD types
+#define AD_UUID16_PARTIAL 0x02
+#define AD_UUID16_COMPLETE 0x03
+#define AD_UUID32_PARTIAL 0x04
+#define AD_UUID32_COMPLETE 0x05
+#define AD_UUID128_PARTIAL 0x06
+#define AD_UUID128_COMPLETE 0x07
+#define AD_NAME_SHORT 0x08
+#define AD_NAME_COMPLETE 0x09
+#define AD_SERVICE_DATA16 0x16
+#define AD_SERVICE_DATA32 0x20
+#define AD_SERVICE_DATA128 0x21
+#define AD_MANUFACTURER 0xFF
+
+enum SignatureKind : uint8_t {
+    SIGNATURE_MFG,
+    SIGNATURE_UUID16,
+    SIGNATURE_UUID128,
+    SIGNATURE_NAME,
+    SIGNATURE_KIND_COUNT
+};
+
+struct SignatureRule {
+    uint16_t target;                 // Target table index
+    uint16_t key;                    // Company ID, 16-bit UUID or name prefix length
+    uint8_t kind;                    // SignatureKind
+    uint8_t length;                  // Bytes used in data
+    uint8_t data[SIGNATURE_DATA_MAX];// MFG data prefix, UUID128 (big-endian) or upper-case name prefix
+};
+
+// Bluetooth base UUID 00000000-0000-1000-8000-00805F9B34FB, big-endian
+static const uint8_t BLUETOOTH_BASE_UUID[16] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00,
+                                                 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB };
+
+static inline uint8_t asciiUpper(uint8_t c) {
+    return (c >= 'a' && c <= 'z') ? (uint8_t)(c - 'a' + 'A') : c;
+}
+
+// Parse hex digits (ignoring '-') into out; returns the byte count, -1 on error
+static inline int parseHexBytes(const char* str, size_t len, uint8_t* out, size_t maxBytes) {
+    size_t count = 0;
+    int hi = -1;
+    for (size_t i = 0; i < len; i++) {
+        if (str[i] == '-') continue;
+        int nibble = hexNibble(str[i]);
+        if (nibble < 0) return -1;
+        if (hi < 0) {
+            hi = nibble;
+        } else {
+            if (count >= maxBytes) return -1;
+            out[count++] = (uint8_t)((hi << 4) | nibble);
+            hi = -1;
+        }
+    }
+    return hi < 0 ? (int)count : -1;
+}
+
+// 16- or 32-bit UUID expanded on the base UUID, stored as 16-bit when it fits
+static inline void setShortUuid(SignatureRule& rule, uint32_t uuid) {
+    if (uuid <= 0xFFFF) {
+        rule.kind = SIGNATURE_UUID16;
+        rule.key = (uint16_t)uuid;
+        return;
+    }
+    rule.kind = SIGNATURE_UUID128;
+    rule.length = 16;
+    memcpy(rule.data, BLUETOOTH_BASE_UUID, 16);
+    rule.data[0] = (uint8_t)(uuid >> 24);
+    rule.data[1] = (uint8_t)(uuid >> 16);
+    rule.data[2] = (uint8_t)(uuid >> 8);
+    rule.data[3] = (uint8_t)uuid;
+}
+
+// Parse a "MFG:", "UUID:" or "NAME:" target line
+static inline bool parseSignature(const char* str, size_t len, SignatureRule& rule) {
+    while (len > 0 && (*str == ' ' || *str == '\t')) {
+        str++;
+        len--;
+    }
+    while (len > 0 && (str[len - 1] == ' ' || str[len - 1] == '\t' || str[len - 1] == '\r')) {
+        len--;
+    }
+    memset(&rule, 0, sizeof(rule));
+
+    const char* colon = (const char*)memchr(str, ':', len);
+    if (!colon) return false;
+    size_t prefixLength = colon - str;
+    const char* value = colon + 1;
+    size_t valueLength = len - prefixLength - 1;
+    char prefix[5] = {};
+    if (prefixLength > 4) return false;
+    for (size_t i = 0; i < prefixLength; i++) prefix[i] = (char)asciiUpper(str[i]);
+
+    if (strcmp(prefix, "MFG") == 0) {
+        const char* dataColon = (const char*)memchr(value, ':', valueLength);
+        size_t idLength = dataColon ? (size_t)(dataColon - value) : valueLength;
+        uint8_t id[2];
+        if (idLength != 4 || parseHexBytes(value, 4, id, 2) != 2) return false;
+        rule.kind = SIGNATURE_MFG;
+        rule.key = (uint16_t)((id[0] << 8) | id[1]);
+        if (dataColon) {
+            int count = parseHexBytes(dataColon + 1, valueLength - idLength - 1, rule.data, SIGNATURE_DATA_MAX - 2);
+            if (count <= 0) return false;
+            rule.length = (uint8_t)count;
+        }
+        return true;
+    }
+    if (strcmp(prefix, "UUID") == 0) {
+        uint8_t bytes[16];
+        int count = parseHexBytes(value, valueLength, bytes, 16);
+        if (count == 2) {
+            setShortUuid(rule, (uint32_t)(bytes[0] << 8) | bytes[1]);
+        } else if (count == 4) {
+            setShortUuid(rule, ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | (bytes[2] << 8) | bytes[3]);
+        } else if (count == 16 && memcmp(bytes + 4, BLUETOOTH_BASE_UUID + 4, 12) == 0) {
+            // Base UUIDs are matched in their short form, as on air
+            setShortUuid(rule, ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | (bytes[2] << 8) | bytes[3]);
+        } else if (count == 16) {
+            rule.kind = SIGNATURE_UUID128;
+            rule.length = 16;
+            memcpy(rule.data, bytes, 16);
+        } else {
+            return false;
+        }
+        return true;
+    }
+    if (strcmp(prefix, "NAME") == 0) {
+        if (valueLength == 0 || valueLength > SIGNATURE_DATA_MAX) return false;
+        rule.kind = SIGNATURE_NAME;
+        rule.key = (uint16_t)valueLength;
+        rule.length = (uint8_t)valueLength;
+        for (size_t i = 0; i < valueLength; i++) rule.data[i] = asciiUpper(value[i]);
+        return true;
+    }
+    return false;
+}
+
+class SignatureMatcher {
+public:
+    static size_t storageSize(size_t capacity) { return capacity * sizeof(SignatureRule); }
+
+    void begin(void* storage, size_t capacity) {
+        rules = (SignatureRule*)storage;
+        maxRules = capacity;
+        clear();
+    }
+
+    void clear() {
+        ruleCount = 0;
+        nameLengths = 0;
+        for (int i = 0; i < SIGNATURE_KIND_COUNT; i++) {
+            ranges[i].start = 0;
+            ranges[i].count = 0;
+        }
+    }
+
+    bool add(const SignatureRule& rule, uint16_t target) {
+        if (!rules || ruleCount >= maxRules) return false;
+        rules[ruleCount] = rule;
+        rules[ruleCount].target = target;
+        ruleCount++;
+        return true;
+    }
+
+    // Sort the rules and index the kinds; call after add() and before match()
+    void compile() {
+        std::sort(rules, rules + ruleCount, [](const SignatureRule& a, const SignatureRule& b) {
+            return compareRules(a, b) < 0;
+        });
+        nameLengths = 0;
+        for (int i = 0; i < SIGNATURE_KIND_COUNT; i++) {
+            ranges[i].start = 0;
+            ranges[i].count = 0;
+        }
+        for (size_t i = 0; i < ruleCount; i++) {
+            Range& range = ranges[rules[i].kind];
+            if (range.count == 0) range.start = (uint16_t)i;
+            range.count++;
+            if (rules[i].kind == SIGNATURE_NAME) nameLengths |= 1u << rules[i].key;
+        }
+    }
+
+    size_t count() const { return ruleCount; }
+
+    // Local names usually travel in the scan response
+    bool needsScanResponse() const { return ranges[SIGNATURE_NAME].count > 0; }
+
+    // Target index for the first rule the payload satisfies, SIGNATURE_NONE if none
+    uint16_t match(const uint8_t* payload, size_t length) const {
+        if (ruleCount == 0) return SIGNATURE_NONE;
+        size_t pos = 0;
+        while (pos + 1 < length) {
+            uint8_t fieldLength = payload[pos];
+            if (fieldLength == 0 || pos + 1 + fieldLength > length) break;
+            uint8_t type = payload[pos + 1];
+            const uint8_t* data = payload + pos + 2;
+            size_t dataLength = fieldLength - 1;
+            pos += 1 + fieldLength;
+
+            uint16_t target = SIGNATURE_NONE;
+            switch (type) {
+                case AD_MANUFACTURER:
+                    if (dataLength >= 2) target = matchManufacturer(data, dataLength);
+                    break;
+                case AD_UUID16_PARTIAL:
+                case AD_UUID16_COMPLETE:
+                    for (size_t i = 0; i + 2 <= dataLength && target == SIGNATURE_NONE; i += 2) {
+                        target = matchUuid32(data[i] | (data[i + 1] << 8));
+                    }
+                    break;
+                case AD_UUID32_PARTIAL:
+                case AD_UUID32_COMPLETE:
+                    for (size_t i = 0; i + 4 <= dataLength && target == SIGNATURE_NONE; i += 4) {
+                        target = matchUuid32(readLe32(data + i));
+                    }
+                    break;
+                case AD_UUID128_PARTIAL:
+                case AD_UUID128_COMPLETE:
+                    for (size_t i = 0; i + 16 <= dataLength && target == SIGNATURE_NONE; i += 16) {
+                        target = matchUuid128Le(data + i);
+                    }
+                    break;
+                case AD_SERVICE_DATA16:
+                    if (dataLength >= 2) target = matchUuid32(data[0] | (data[1] << 8));
+                    break;
+                case AD_SERVICE_DATA32:
+                    if (dataLength >= 4) target = matchUuid32(readLe32(data));
+                    break;
+                case AD_SERVICE_DATA128:
+                    if (dataLength >= 16) target = matchUuid128Le(data);
+                    break;
+                case AD_NAME_SHORT:
+                case AD_NAME_COMPLETE:
+                    target = matchName(data, dataLength);
+                    break;
+            }
+            if (target != SIGNATURE_NONE) return target;
+        }
+        return SIGNATURE_NONE;
+    }
+
+private:
+    struct Range {
+        uint16_t start;
+        uint16_t count;
+    };
+
+    static int compareRules(const SignatureRule& a, const SignatureRule& b) {
+        if (a.kind != b.kind) return a.kind < b.kind ? -1 : 1;
+        if (a.key != b.key) return a.key < b.key ? -1 : 1;
+        return memcmp(a.data, b.data, SIGNATURE_DATA_MAX);
+    }
+
+    static uint32_t readLe32(const uint8_t* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // First rule in [first, last) not less than (key, bytes)
+    const SignatureRule* lowerBound(uint8_t kind, uint16_t key, const uint8_t* bytes, size_t length) const {
+        const SignatureRule* first = rules + ranges[kind].start;
+        const SignatureRule* last = first + ranges[kind].count;
+        while (first < last) {
+            const SignatureRule* mid = first + (last - first) / 2;
+            int order = mid->key != key ? (mid->key < key ? -1 : 1) : memcmp(mid->data, bytes, length);
+            if (order < 0) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        return first;
+    }
+
+    const SignatureRule* rangeEnd(uint8_t kind) const {
+        return rules + ranges[kind].start + ranges[kind].count;
+    }
+
+    uint16_t matchManufacturer(const uint8_t* data, size_t length) const {
+        if (ranges[SIGNATURE_MFG].count == 0) return SIGNATURE_NONE;
+        uint16_t company = (uint16_t)(data[0] | (data[1] << 8));
+        static const uint8_t NO_BYTES[SIGNATURE_DATA_MAX] = {};
+        // Rules for one company are adjacent, sorted by their data prefix
+        for (const SignatureRule* rule = lowerBound(SIGNATURE_MFG, company, NO_BYTES, SIGNATURE_DATA_MAX);
+             rule < rangeEnd(SIGNATURE_MFG) && rule->key == company; rule++) {
+            if (rule->length <= length - 2 && memcmp(rule->data, data + 2, rule->length) == 0) return rule->target;
+        }
+        return SIGNATURE_NONE;
+    }
+
+    uint16_t matchUuid32(uint32_t uuid) const {
+        if (uuid > 0xFFFF) {
+            uint8_t bytes[16];
+            memcpy(bytes, BLUETOOTH_BASE_UUID, 16);
+            bytes[0] = (uint8_t)(uuid >> 24);
+            bytes[1] = (uint8_t)(uuid >> 16);
+            bytes[2] = (uint8_t)(uuid >> 8);
+            bytes[3] = (uint8_t)uuid;
+            return matchUuid128(bytes);
+        }
+        if (ranges[SIGNATURE_UUID16].count == 0) return SIGNATURE_NONE;
+        static const uint8_t NO_BYTES[SIGNATURE_DATA_MAX] = {};
+        const SignatureRule* rule = lowerBound(SIGNATURE_UUID16, (uint16_t)uuid, NO_BYTES, SIGNATURE_DATA_MAX);
+        return rule < rangeEnd(SIGNATURE_UUID16) && rule->key == uuid ? rule->target : SIGNATURE_NONE;
+    }
+
+    // AD structures carry 128-bit UUIDs little-endian
+    uint16_t matchUuid128Le(const uint8_t* le) const {
+        uint8_t bytes[16];
+        for (int i = 0; i < 16; i++) bytes[i] = le[15 - i];
+        // Base UUIDs are matched as their short form
+        if (memcmp(bytes + 4, BLUETOOTH_BASE_UUID + 4, 12) == 0) {
+            return matchUuid32(((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | (bytes[2] << 8) | bytes[3]);
+        }
+        return matchUuid128(bytes);
+    }
+
+    uint16_t matchUuid128(const uint8_t* bytes) const {
+        if (ranges[SIGNATURE_UUID128].count == 0) return SIGNATURE_NONE;
+        const SignatureRule* rule = lowerBound(SIGNATURE_UUID128, 0, bytes, 16);
+        return rule < rangeEnd(SIGNATURE_UUID128) && memcmp(rule->data, bytes, 16) == 0 ? rule->target
+                                                                                        : SIGNATURE_NONE;
+    }
+
+    uint16_t matchName(const uint8_t* name, size_t length) const {
+        if (nameLengths == 0) return SIGNATURE_NONE;
+        uint8_t upper[SIGNATURE_DATA_MAX];
+        size_t usable = std::min<size_t>(length, SIGNATURE_DATA_MAX);
+        for (size_t i = 0; i < usable; i++) upper[i] = asciiUpper(name[i]);
+
+        // One binary search per prefix length in use, longest (most specific) first
+        uint32_t lengths = nameLengths & ((2u << usable) - 1);
+        while (lengths) {
+            int prefixLength = 31 - __builtin_clz(lengths);
+            lengths &= ~(1u << prefixLength);
+            const SignatureRule* rule = lowerBound(SIGNATURE_NAME, (uint16_t)prefixLength, upper, prefixLength);
+            if (rule < rangeEnd(SIGNATURE_NAME) && rule->key == prefixLength &&
+                memcmp(rule->data, upper, prefixLength) == 0) {
+                return rule->target;
+            }
+        }
+        return SIGNATURE_NONE;
+    }
+
+    SignatureRule* rules = nullptr;
+    size_t maxRules = 0;
+    size_t ruleCount = 0;
+    Range ranges[SIGNATURE_KIND_COUNT];
+    uint32_t nameLengths = 0;          // Bit n set when a name prefix of length n exists
+};
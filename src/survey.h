@@ -0,0 +1,199 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Environment survey: the busiest and strongest devices around, in fixed memory.
+// A SurveySketch keeps K entries however many devices are on air. Ranked by
+// count it is the Space-Saving heavy-hitter algorithm: an unseen key takes over
+// the entry with the lowest count and inherits that count as its error bound,
+// so any key making up more than 1/K of the adverts is always kept, and a
+// kept key's true count lies between count - error and count. Ranked by RSSI
+// it keeps the K highest peaks exactly, replacing the weakest peak only when
+// a stronger advert arrives.
+// Entries sit in a min-heap on their rank, so the entry to replace is at the
+// root and an update is O(log K); a linear-probing index of 2K slots finds a
+// key in O(1).
+
+#define SURVEY_SLOT_EMPTY 0xFFFF
+
+// One advert, queued by the scan handler for the sketches
+struct SurveySample {
+    uint64_t address;
+    uint32_t timestamp;      // millis()
+    int8_t rssi;
+    uint8_t addressType;     // HAL_ADDR_*
+};
+
+enum SurveyRank {
+    SURVEY_BY_COUNT,     // Space-Saving on advert count
+    SURVEY_BY_RSSI       // Exact top K by peak RSSI
+};
+
+struct SurveyEntry {
+    uint64_t key;            // Packed address, or OUI (top three octets)
+    uint32_t count;          // Adverts counted, an overestimate by at most error
+    uint32_t error;          // Count inherited from the entry this key replaced
+    int32_t rssiSum;         // Over the count - error adverts seen since it entered
+    uint32_t lastSeen;       // millis()
+    int8_t peakRssi;
+    uint8_t addressType;     // HAL_ADDR_* of the latest advert
+
+    int meanRssi() const {
+        uint32_t seen = count - error;
+        return seen ? (int)(rssiSum / (int32_t)seen) : peakRssi;
+    }
+};
+
+// Smallest power of two >= n
+static constexpr size_t surveySlotCount(size_t n) {
+    return n <= 1 ? 1 : 2 * surveySlotCount((n + 1) / 2);
+}
+
+template <size_t K, uint8_t RANK>
+class SurveySketch {
+    static_assert(K >= 2 && K < SURVEY_SLOT_EMPTY / 2, "SurveySketch capacity out of range");
+
+public:
+    SurveySketch() { reset(); }
+
+    void reset() {
+        size = 0;
+        offered = 0;
+        memset(slots, 0xFF, sizeof(slots));
+    }
+
+    // Count one advert from key
+    void offer(uint64_t key, int8_t rssi, uint8_t addressType, uint32_t now) {
+        offered++;
+        uint16_t index = find(key);
+        if (index == SURVEY_SLOT_EMPTY) {
+            if (size < K) {
+                index = (uint16_t)size++;
+                entries[index] = SurveyEntry{ key, 0, 0, 0, now, rssi, addressType };
+                heap[index] = index;
+                position[index] = index;
+                insert(index);
+                siftUp(index);
+            } else {
+                // Replace the lowest ranked entry, at the root
+                index = heap[0];
+                SurveyEntry& victim = entries[index];
+                if (RANK == SURVEY_BY_RSSI && rssi <= victim.peakRssi) return;
+                remove(victim.key);
+                uint32_t inherited = RANK == SURVEY_BY_COUNT ? victim.count : 0;
+                victim = SurveyEntry{ key, inherited, inherited, 0, now, rssi, addressType };
+                insert(index);
+            }
+        }
+
+        SurveyEntry& entry = entries[index];
+        entry.count++;
+        entry.rssiSum += rssi;
+        entry.lastSeen = now;
+        entry.addressType = addressType;
+        if (rssi > entry.peakRssi) entry.peakRssi = rssi;
+        siftDown(position[index]);
+    }
+
+    // Copy up to max entries, highest ranked first; returns how many. By
+    // count the order is on count - error, the adverts a key is known to
+    // have sent: a key that just took over an entry has a high count but
+    // little to show for it.
+    size_t sorted(SurveyEntry* out, size_t max) const {
+        size_t n = 0;
+        for (size_t i = 0; i < size; i++) {
+            // Insertion sort into the top max: K is small
+            const SurveyEntry& entry = entries[i];
+            size_t j = n < max ? n++ : max;
+            while (j > 0 && reportRank(out[j - 1]) < reportRank(entry)) {
+                if (j < max) out[j] = out[j - 1];
+                j--;
+            }
+            if (j < max) out[j] = entry;
+        }
+        return n;
+    }
+
+    size_t count() const { return size; }
+    uint32_t adverts() const { return offered; }
+    static constexpr size_t capacity() { return K; }
+
+private:
+    static constexpr size_t SLOTS = surveySlotCount(K * 2);
+
+    static int64_t rank(const SurveyEntry& entry) {
+        return RANK == SURVEY_BY_COUNT ? (int64_t)entry.count : entry.peakRssi;
+    }
+
+    static int64_t reportRank(const SurveyEntry& entry) {
+        return RANK == SURVEY_BY_COUNT ? (int64_t)(entry.count - entry.error) : entry.peakRssi;
+    }
+
+    static size_t home(uint64_t key) {
+        return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 40) & (SLOTS - 1);
+    }
+
+    uint16_t find(uint64_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & (SLOTS - 1)) {
+            if (slots[i] == SURVEY_SLOT_EMPTY) return SURVEY_SLOT_EMPTY;
+            if (entries[slots[i]].key == key) return slots[i];
+        }
+    }
+
+    void insert(uint16_t index) {
+        size_t i = home(entries[index].key);
+        while (slots[i] != SURVEY_SLOT_EMPTY) i = (i + 1) & (SLOTS - 1);
+        slots[i] = index;
+    }
+
+    // Backward-shift deletion keeps probe chains unbroken without tombstones
+    void remove(uint64_t key) {
+        size_t i = home(key);
+        while (entries[slots[i]].key != key) i = (i + 1) & (SLOTS - 1);
+        for (size_t j = (i + 1) & (SLOTS - 1); slots[j] != SURVEY_SLOT_EMPTY; j = (j + 1) & (SLOTS - 1)) {
+            // An entry may fill the hole only if its home is not in (i, j]
+            size_t h = home(entries[slots[j]].key);
+            if (((j - h) & (SLOTS - 1)) >= ((j - i) & (SLOTS - 1))) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i] = SURVEY_SLOT_EMPTY;
+    }
+
+    void swap(size_t a, size_t b) {
+        uint16_t t = heap[a];
+        heap[a] = heap[b];
+        heap[b] = t;
+        position[heap[a]] = (uint16_t)a;
+        position[heap[b]] = (uint16_t)b;
+    }
+
+    void siftUp(size_t i) {
+        while (i > 0 && rank(entries[heap[i]]) < rank(entries[heap[(i - 1) / 2]])) {
+            swap(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void siftDown(size_t i) {
+        for (;;) {
+            size_t smallest = i;
+            for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < size; child++) {
+                if (rank(entries[heap[child]]) < rank(entries[heap[smallest]])) smallest = child;
+            }
+            if (smallest == i) return;
+            swap(i, smallest);
+            i = smallest;
+        }
+    }
+
+    SurveyEntry entries[K];
+    uint16_t heap[K];            // Entry indexes, min-heap on rank
+    uint16_t position[K];        // Heap position of each entry
+    uint16_t slots[SLOTS];       // Key index: entry index or SURVEY_SLOT_EMPTY
+    size_t size;
+    uint32_t offered;
+};
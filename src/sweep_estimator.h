@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Bearing from one antenna sweep.
+// The operator turns a directional antenna one full circle clockwise at a
+// roughly steady pace; the bearing is where in that turn the signal peaked,
+// in degrees clockwise from the heading the sweep started at. Samples land in
+// a fixed set of time bins as they arrive, so memory and per-sample cost do
+// not depend on sweep length: when the sweep outgrows the bins, neighbouring
+// bins are merged and the bin width doubles.
+//
+// finish() fills empty bins from their neighbours, smooths the circular
+// profile, takes the main lobe (bins within SWEEP_LOBE_DB of the peak) and
+// returns its power-weighted circular centroid. The native simulator's
+// sweepbench checks it against synthetic antenna patterns.
+
+#define SWEEP_BINS 64                 // Time bins over one sweep
+#define SWEEP_BIN_START_MS 25         // Initial bin width, doubled as the sweep outgrows the bins
+#define SWEEP_MIN_SAMPLES 12          // Fewer samples give no bearing
+#define SWEEP_MIN_COVERAGE 50         // Percent of bins that need a sample
+#define SWEEP_LOBE_DB 6.0f            // Main lobe: bins within this of the peak
+#define SWEEP_MIN_CONTRAST_DB 4.0f    // Peak over median needed for a fix
+#define SWEEP_NO_BEARING 0xFFFF
+
+struct SweepResult {
+    uint16_t bearing;        // Degrees clockwise from the start heading, SWEEP_NO_BEARING without a fix
+    uint16_t lobeWidth;      // Main lobe width in degrees
+    int8_t contrast;         // Peak over median, dB
+    uint16_t samples;        // Samples in the sweep (saturating)
+    uint32_t durationMs;
+};
+
+class SweepEstimator {
+public:
+    void begin(uint32_t now) {
+        start = now;
+        width = SWEEP_BIN_START_MS;
+        sampleCount = 0;
+        for (size_t i = 0; i < SWEEP_BINS; i++) bins[i] = Bin();
+    }
+
+    // One RSSI sample at timestamp (millis()). Samples from before begin(), still
+    // queued when the sweep started, are dropped: their offset would wrap and
+    // merge every bin away.
+    void add(uint32_t timestamp, int rssi) {
+        if ((int32_t)(timestamp - start) < 0) return;
+        uint32_t offset = timestamp - start;
+        while (offset / width >= SWEEP_BINS) merge();
+        Bin& bin = bins[offset / width];
+        bin.sum += rssi;
+        bin.count++;
+        if (sampleCount < 0xFFFF) sampleCount++;
+    }
+
+    // End the sweep at now (one full turn since begin()) and estimate the bearing
+    SweepResult finish(uint32_t now) {
+        SweepResult result = {};
+        result.bearing = SWEEP_NO_BEARING;
+        result.samples = sampleCount;
+        result.durationMs = now - start;
+        while (result.durationMs / width >= SWEEP_BINS) merge();
+
+        size_t n = (result.durationMs + width - 1) / width;
+        if (n < 4 || sampleCount < SWEEP_MIN_SAMPLES) return result;
+
+        // Mean RSSI per bin, gaps interpolated around the circle
+        float profile[SWEEP_BINS];
+        size_t filled = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (bins[i].count) {
+                profile[i] = (float)bins[i].sum / bins[i].count;
+                filled++;
+            }
+        }
+        if (filled * 100 < n * SWEEP_MIN_COVERAGE) return result;
+        for (size_t i = 0; i < n; i++) {
+            if (bins[i].count) continue;
+            size_t before = 1, after = 1;
+            while (!bins[(i + n - before) % n].count) before++;
+            while (!bins[(i + after) % n].count) after++;
+            float a = profile[(i + n - before) % n], b = profile[(i + after) % n];
+            profile[i] = a + (b - a) * before / (before + after);
+        }
+
+        // [1 2 1] circular smoothing, peak and median
+        float smooth[SWEEP_BINS];
+        size_t peak = 0;
+        for (size_t i = 0; i < n; i++) {
+            smooth[i] = (profile[(i + n - 1) % n] + 2 * profile[i] + profile[(i + 1) % n]) / 4;
+            if (smooth[i] > smooth[peak]) peak = i;
+        }
+        float sorted[SWEEP_BINS];
+        for (size_t i = 0; i < n; i++) sorted[i] = smooth[i];
+        for (size_t i = 1; i < n; i++) {
+            float v = sorted[i];
+            size_t j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+            sorted[j] = v;
+        }
+        float contrast = smooth[peak] - sorted[n / 2];
+
+        // Power-weighted circular centroid of the main lobe
+        float floor = smooth[peak] - SWEEP_LOBE_DB;
+        float x = 0, y = 0;
+        size_t lobe = 1;
+        accumulate(0.0f, peak, result.durationMs, x, y);
+        for (size_t k = 1; k < n / 2 && smooth[(peak + k) % n] >= floor; k++, lobe++) {
+            accumulate(smooth[(peak + k) % n] - smooth[peak], (peak + k) % n, result.durationMs, x, y);
+        }
+        for (size_t k = 1; k < n / 2 && smooth[(peak + n - k) % n] >= floor; k++, lobe++) {
+            accumulate(smooth[(peak + n - k) % n] - smooth[peak], (peak + n - k) % n, result.durationMs, x, y);
+        }
+
+        result.contrast = (int8_t)(contrast > 127 ? 127 : contrast);
+        result.lobeWidth = (uint16_t)(lobe * 360u * width / (result.durationMs ? result.durationMs : 1));
+        if (result.lobeWidth > 360) result.lobeWidth = 360;
+        if (contrast >= SWEEP_MIN_CONTRAST_DB) {
+            float degrees = atan2f(y, x) * 180.0f / (float)M_PI;
+            if (degrees < 0) degrees += 360.0f;
+            result.bearing = (uint16_t)(degrees + 0.5f) % 360;
+        }
+        return result;
+    }
+
+    bool empty() const { return sampleCount == 0; }
+
+private:
+    struct Bin {
+        int32_t sum = 0;
+        uint16_t count = 0;
+    };
+
+    // Halve the resolution: pairs of bins become one
+    void merge() {
+        for (size_t i = 0; i < SWEEP_BINS / 2; i++) {
+            bins[i].sum = bins[2 * i].sum + bins[2 * i + 1].sum;
+            bins[i].count = (uint16_t)(bins[2 * i].count + bins[2 * i + 1].count);
+        }
+        for (size_t i = SWEEP_BINS / 2; i < SWEEP_BINS; i++) bins[i] = Bin();
+        width *= 2;
+    }
+
+    // Add bin i as a vector at its centre angle, weighted by its power relative to the peak
+    void accumulate(float relativeDb, size_t i, uint32_t duration, float& x, float& y) const {
+        uint32_t binStart = (uint32_t)(i * width);
+        uint32_t binEnd = binStart + width < duration ? binStart + width : duration;
+        float angle = 2.0f * (float)M_PI * (binStart + binEnd) / 2 / (duration ? duration : 1);
+        float weight = powf(10.0f, relativeDb / 10.0f);
+        x += weight * cosf(angle);
+        y += weight * sinf(angle);
+    }
+
+    Bin bins[SWEEP_BINS];
+    uint32_t start = 0;
+    uint32_t width = SWEEP_BIN_START_MS;
+    uint16_t sampleCount = 0;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Target address matching helpers.
+// Addresses are packed into a 48-bit key with the first octet of the
+// "AA:BB:CC:DD:EE:FF" notation in the most significant byte, which is the
+// same layout NimBLE uses internally (native bytes are stored LSB first).
+
+static inline int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Parse a target rule into a packed key and octet mask. Accepted forms:
+//   "AA:BB:CC:DD:EE:FF"  full address
+//   "AA:BB:CC"           24-bit OUI prefix
+//   "AA:BB:CC:*:*:*"     wildcard octets ('*' or "**")
+// ':' or '-' separators, any case
+static inline bool parseMACRule(const char* str, size_t len, uint64_t& key, uint64_t& mask) {
+    // Skip surrounding whitespace
+    while (len > 0 && (*str == ' ' || *str == '\t' || *str == '\r' || *str == '\n')) {
+        str++;
+        len--;
+    }
+    while (len > 0 && (str[len - 1] == ' ' || str[len - 1] == '\t' ||
+                       str[len - 1] == '\r' || str[len - 1] == '\n')) {
+        len--;
+    }
+
+    uint64_t value = 0;
+    uint64_t bits = 0;
+    int octets = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        if (octets == 6) return false;
+        if (octets > 0) {
+            if (str[pos] != ':' && str[pos] != '-') return false;
+            pos++;
+        }
+
+        size_t end = pos;
+        while (end < len && str[end] != ':' && str[end] != '-') end++;
+        size_t tokenLength = end - pos;
+
+        value <<= 8;
+        bits <<= 8;
+        if ((tokenLength == 1 || tokenLength == 2) && str[pos] == '*' && str[end - 1] == '*') {
+            // Wildcard octet
+        } else if (tokenLength == 2) {
+            int hi = hexNibble(str[pos]);
+            int lo = hexNibble(str[pos + 1]);
+            if (hi < 0 || lo < 0) return false;
+            value |= (uint64_t)((hi << 4) | lo);
+            bits |= 0xFF;
+        } else {
+            return false;
+        }
+        octets++;
+        pos = end;
+    }
+
+    // OUI shorthand leaves the device half wildcarded
+    if (octets == 3) {
+        value <<= 24;
+        bits <<= 24;
+    } else if (octets != 6) {
+        return false;
+    }
+    if (bits == 0) return false; // A rule matching everything is never intended
+
+    key = value & bits;
+    mask = bits;
+    return true;
+}
+
+// Parse an "IRK:<32 hex digits>" target (identity resolving key, most
+// significant octet first as in the Core spec sample data)
+static inline bool parseIRK(const char* str, size_t len, uint8_t irk[16]) {
+    while (len > 0 && (*str == ' ' || *str == '\t')) {
+        str++;
+        len--;
+    }
+    while (len > 0 && (str[len - 1] == ' ' || str[len - 1] == '\t' || str[len - 1] == '\r')) {
+        len--;
+    }
+    if (len != 36 || (str[0] != 'I' && str[0] != 'i') || (str[1] != 'R' && str[1] != 'r') ||
+        (str[2] != 'K' && str[2] != 'k') || str[3] != ':') {
+        return false;
+    }
+    for (int i = 0; i < 16; i++) {
+        int hi = hexNibble(str[4 + i * 2]);
+        int lo = hexNibble(str[5 + i * 2]);
+        if (hi < 0 || lo < 0) return false;
+        irk[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+}
+
+// Resolvable private addresses have 0b01 in the two most significant bits
+static inline bool isResolvablePrivate(uint64_t key) {
+    return (key >> 46) == 0x1;
+}
+
+// Pack NimBLE native address bytes (LSB first) into a key without allocating
+static inline uint64_t addressKey(const uint8_t* native) {
+    return  (uint64_t)native[0]        | ((uint64_t)native[1] << 8)  |
+           ((uint64_t)native[2] << 16) | ((uint64_t)native[3] << 24) |
+           ((uint64_t)native[4] << 32) | ((uint64_t)native[5] << 40);
+}
+
+// Format a packed key as "AA:BB:CC:DD:EE:FF" into out (at least 18 bytes).
+// Octets outside mask are written as "**".
+static inline void formatMACKey(uint64_t key, char* out, uint64_t mask = 0xFFFFFFFFFFFFULL) {
+    static const char digits[] = "0123456789ABCDEF";
+    for (int i = 0; i < 6; i++) {
+        int shift = 40 - i * 8;
+        uint8_t b = (uint8_t)(key >> shift);
+        bool wildcard = ((mask >> shift) & 0xFF) == 0;
+        out[i * 3] = wildcard ? '*' : digits[b >> 4];
+        out[i * 3 + 1] = wildcard ? '*' : digits[b & 0x0F];
+        out[i * 3 + 2] = (i < 5) ? ':' : '\0';
+    }
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include "rssi_filter.h"
+
+// Fixed-capacity target table and matcher.
+// Targets live in a dense entry array (walked by the detection task). Full
+// addresses are found through a power-of-two index of uint16_t slots with
+// linear probing. OUI and wildcard rules are compiled into one sorted array
+// of masked values per distinct mask and found by binary search, so a lookup
+// costs one hash probe plus at most one binary search per mask in use.
+// Indexed entries (mask 0) are never matched by address; they belong to IRK
+// and payload signature targets, found through irk_resolver.h and
+// signature_match.h.
+// Storage is supplied by the caller so it can be placed in PSRAM.
+
+#define MAX_TARGETS 1024
+#define MAX_RULE_MASKS 64              // Octet-granular masks, 2^6 possible
+#define TARGET_SLOT_EMPTY 0xFFFF
+#define MAC_MASK_FULL 0xFFFFFFFFFFFFULL
+#define MAC_MASK_OUI  0xFFFFFF000000ULL
+
+struct TargetEntry {
+    uint64_t key;                    // Packed 48-bit address, already masked
+    uint64_t mask;                   // Bits of the address that must match, 0 for indexed targets
+    uint64_t address;                // Address of the device being followed
+    int rssi;                        // Most recent raw RSSI
+    int filteredRssi;                // RSSI after the configured filter stage
+    RssiFilter filter;               // Filter state for the followed device
+    unsigned long lastSeen;          // millis() of most recent advert
+    bool detected;                   // Seen within the detection timeout
+    bool oneDevice;                  // Every match is the same device (IRK targets)
+};
+
+class TargetTable {
+public:
+    // Bytes of storage needed for a table holding up to `capacity` targets
+    static size_t storageSize(size_t capacity) {
+        return capacity * (sizeof(TargetEntry) + sizeof(RuleRef)) +
+               slotCountFor(capacity) * sizeof(uint16_t);
+    }
+
+    void begin(void* storage, size_t capacity) {
+        entries = (TargetEntry*)storage;
+        rules = (RuleRef*)(entries + capacity);
+        slots = (uint16_t*)(rules + capacity);
+        maxEntries = capacity;
+        slotMask = slotCountFor(capacity) - 1;
+        clear();
+    }
+
+    void clear() {
+        entryCount = 0;
+        groupCount = 0;
+        if (slots) memset(slots, 0xFF, (slotMask + 1) * sizeof(uint16_t));
+    }
+
+    // Returns the entry for key/mask, adding it if needed; nullptr when full.
+    // Call compile() after adding masked rules and before matching.
+    TargetEntry* insert(uint64_t key, uint64_t mask = MAC_MASK_FULL) {
+        if (!slots) return nullptr;
+        key &= mask;
+
+        size_t slot = 0;
+        if (mask == MAC_MASK_FULL) {
+            slot = hash(key);
+            while (slots[slot] != TARGET_SLOT_EMPTY) {
+                if (entries[slots[slot]].key == key) return &entries[slots[slot]];
+                slot = (slot + 1) & slotMask;
+            }
+        } else {
+            // Masked rules are only added at configuration time
+            for (size_t i = 0; i < entryCount; i++) {
+                if (entries[i].mask == mask && entries[i].key == key) return &entries[i];
+            }
+        }
+        if (entryCount >= maxEntries) return nullptr;
+
+        TargetEntry* entry = &entries[entryCount];
+        entry->key = key;
+        entry->mask = mask;
+        entry->address = key;
+        entry->rssi = -100;
+        entry->filteredRssi = -100;
+        entry->filter.reset();
+        entry->lastSeen = 0;
+        entry->detected = false;
+        entry->oneDevice = mask == MAC_MASK_FULL;
+        if (mask == MAC_MASK_FULL) {
+            slots[slot] = (uint16_t)entryCount;
+        }
+        entryCount++;
+        return entry;
+    }
+
+    // Add an entry that is only found through its index; nullptr when full
+    TargetEntry* insertIndexed(bool oneDevice) {
+        if (!slots || entryCount >= maxEntries) return nullptr;
+        TargetEntry* entry = &entries[entryCount++];
+        entry->key = 0;
+        entry->mask = 0;
+        entry->address = 0;
+        entry->rssi = -100;
+        entry->filteredRssi = -100;
+        entry->filter.reset();
+        entry->lastSeen = 0;
+        entry->detected = false;
+        entry->oneDevice = oneDevice;
+        return entry;
+    }
+
+    // Build the per-mask sorted rule arrays from the masked entries
+    void compile() {
+        size_t ruleCount = 0;
+        for (size_t i = 0; i < entryCount; i++) {
+            if (entries[i].mask == MAC_MASK_FULL || entries[i].mask == 0) continue;
+            rules[ruleCount].mask = entries[i].mask;
+            rules[ruleCount].value = entries[i].key;
+            rules[ruleCount].entry = (uint16_t)i;
+            ruleCount++;
+        }
+        // Most specific masks (most bits set) sort first so the best rule wins;
+        // equally specific masks keep a fixed order
+        std::sort(rules, rules + ruleCount, [](const RuleRef& a, const RuleRef& b) {
+            int bitsA = __builtin_popcountll(a.mask);
+            int bitsB = __builtin_popcountll(b.mask);
+            if (bitsA != bitsB) return bitsA > bitsB;
+            return a.mask != b.mask ? a.mask > b.mask : a.value < b.value;
+        });
+
+        // insert() callers check ruleMaskAvailable(), so no group is dropped here
+        groupCount = 0;
+        for (size_t i = 0; i < ruleCount && groupCount < MAX_RULE_MASKS; i++) {
+            if (groupCount == 0 || groups[groupCount - 1].mask != rules[i].mask) {
+                groups[groupCount].mask = rules[i].mask;
+                groups[groupCount].start = (uint16_t)i;
+                groups[groupCount].count = 0;
+                groupCount++;
+            }
+            groups[groupCount - 1].count++;
+        }
+    }
+
+    // False when a rule with this mask would need a group past MAX_RULE_MASKS
+    bool ruleMaskAvailable(uint64_t mask) const {
+        if (mask == MAC_MASK_FULL || mask == 0) return true;
+        uint64_t seen[MAX_RULE_MASKS];
+        size_t seenCount = 0;
+        for (size_t i = 0; i < entryCount; i++) {
+            uint64_t m = entries[i].mask;
+            if (m == MAC_MASK_FULL || m == 0) continue;
+            if (m == mask) return true;
+            if (std::find(seen, seen + seenCount, m) == seen + seenCount) seen[seenCount++] = m;
+        }
+        return seenCount < MAX_RULE_MASKS;
+    }
+
+    // Find the entry matching a full address: exact targets first, then rules
+    TargetEntry* match(uint64_t address) const {
+        TargetEntry* entry = find(address);
+        if (entry) return entry;
+
+        for (size_t g = 0; g < groupCount; g++) {
+            uint64_t value = address & groups[g].mask;
+            const RuleRef* first = rules + groups[g].start;
+            const RuleRef* last = first + groups[g].count;
+            while (first < last) {
+                const RuleRef* mid = first + (last - first) / 2;
+                if (mid->value < value) {
+                    first = mid + 1;
+                } else {
+                    last = mid;
+                }
+            }
+            if (first < rules + groups[g].start + groups[g].count && first->value == value) {
+                return &entries[first->entry];
+            }
+        }
+        return nullptr;
+    }
+
+    // Exact full-address lookup
+    TargetEntry* find(uint64_t key) const {
+        if (!slots) return nullptr;
+        size_t i = hash(key);
+        while (slots[i] != TARGET_SLOT_EMPTY) {
+            if (entries[slots[i]].key == key) return &entries[slots[i]];
+            i = (i + 1) & slotMask;
+        }
+        return nullptr;
+    }
+
+    size_t count() const { return entryCount; }
+    size_t indexOf(const TargetEntry* entry) const { return entry - entries; }
+    size_t maskCount() const { return groupCount; }
+    TargetEntry& operator[](size_t i) const { return entries[i]; }
+
+private:
+    struct RuleRef {
+        uint64_t mask;
+        uint64_t value;
+        uint16_t entry;
+    };
+
+    struct RuleGroup {
+        uint64_t mask;
+        uint16_t start;
+        uint16_t count;
+    };
+
+    // Keep the load factor at or below 0.5 so probe chains stay short
+    static size_t slotCountFor(size_t capacity) {
+        size_t n = 16;
+        while (n < capacity * 2) n <<= 1;
+        return n;
+    }
+
+    size_t hash(uint64_t key) const {
+        return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & slotMask;
+    }
+
+    TargetEntry* entries = nullptr;
+    RuleRef* rules = nullptr;
+    uint16_t* slots = nullptr;
+    RuleGroup groups[MAX_RULE_MASKS];
+    size_t maxEntries = 0;
+    size_t entryCount = 0;
+    size_t groupCount = 0;
+    size_t slotMask = 0;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Live RSSI telemetry batching.
+// Samples are coalesced into a fixed buffer and packed into one binary frame
+// per send period, so the detection path only ever does a bounded copy.
+//
+// Frame layout (little-endian):
+//   uint8  version         TELEMETRY_VERSION
+//   uint8  count           samples in this frame
+//   uint16 droppedFrames   frames dropped so far (saturating)
+//   uint16 droppedSamples  samples dropped so far (saturating)
+//   uint32 baseTime        millis() of the first sample
+//   count x { uint16 dt (ms since baseTime), uint16 target, int8 rssi, int8 filtered }
+//
+// A finished direction-finding sweep is sent as a frame of its own:
+//   uint8  TELEMETRY_BEARING_FRAME
+//   uint16 target
+//   uint16 bearing         degrees clockwise from the sweep start, 0xFFFF without a fix
+//   uint16 lobeWidth       degrees
+//   int8   contrast        peak over median, dB
+//   uint16 samples
+//   uint32 duration        ms
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_MAX_SAMPLES 64
+#define TELEMETRY_HEADER_SIZE 10
+#define TELEMETRY_SAMPLE_SIZE 6
+#define TELEMETRY_FRAME_SIZE (TELEMETRY_HEADER_SIZE + TELEMETRY_MAX_SAMPLES * TELEMETRY_SAMPLE_SIZE)
+#define TELEMETRY_BEARING_FRAME 0x80  // First byte of a bearing frame; sample frames start with the version
+#define TELEMETRY_BEARING_SIZE 14
+
+struct TelemetrySample {
+    uint32_t timestamp;
+    uint16_t target;
+    int8_t rssi;
+    int8_t filtered;
+};
+
+class TelemetryBatcher {
+public:
+    // Queue a sample; dropped (and counted) when the batch is full
+    void add(const TelemetrySample& sample) {
+        if (count >= TELEMETRY_MAX_SAMPLES ||
+            (count > 0 && sample.timestamp - samples[0].timestamp > 0xFFFF)) {
+            droppedSamples++;
+            return;
+        }
+        samples[count++] = sample;
+    }
+
+    // True when a frame is due for the given send period
+    bool due(uint32_t now, uint32_t periodMs) const {
+        return count > 0 && now - lastSend >= periodMs;
+    }
+
+    // Pack pending samples into frame (TELEMETRY_FRAME_SIZE bytes) and clear them
+    size_t pack(uint8_t* frame, uint32_t now) {
+        frame[0] = TELEMETRY_VERSION;
+        frame[1] = (uint8_t)count;
+        put16(frame + 2, saturate(droppedFrames));
+        put16(frame + 4, saturate(droppedSamples));
+        uint32_t base = count > 0 ? samples[0].timestamp : now;
+        put32(frame + 6, base);
+
+        uint8_t* p = frame + TELEMETRY_HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            put16(p, (uint16_t)(samples[i].timestamp - base));
+            put16(p + 2, samples[i].target);
+            p[4] = (uint8_t)samples[i].rssi;
+            p[5] = (uint8_t)samples[i].filtered;
+            p += TELEMETRY_SAMPLE_SIZE;
+        }
+        count = 0;
+        lastSend = now;
+        return p - frame;
+    }
+
+    // Discard pending samples because the link could not take a frame
+    void dropFrame(uint32_t now) {
+        droppedSamples += count;
+        droppedFrames++;
+        count = 0;
+        lastSend = now;
+    }
+
+    // Pack a bearing frame (TELEMETRY_BEARING_SIZE bytes)
+    static size_t packBearing(uint8_t* frame, uint16_t target, uint16_t bearing, uint16_t lobeWidth,
+                              int8_t contrast, uint16_t samples, uint32_t durationMs) {
+        frame[0] = TELEMETRY_BEARING_FRAME;
+        put16(frame + 1, target);
+        put16(frame + 3, bearing);
+        put16(frame + 5, lobeWidth);
+        frame[7] = (uint8_t)contrast;
+        put16(frame + 8, samples);
+        put32(frame + 10, durationMs);
+        return TELEMETRY_BEARING_SIZE;
+    }
+
+    uint32_t framesDropped() const { return droppedFrames; }
+    uint32_t samplesDropped() const { return droppedSamples; }
+
+private:
+    static uint16_t saturate(uint32_t v) { return v > 0xFFFF ? 0xFFFF : (uint16_t)v; }
+
+    static void put16(uint8_t* p, uint16_t v) {
+        p[0] = (uint8_t)v;
+        p[1] = (uint8_t)(v >> 8);
+    }
+
+    static void put32(uint8_t* p, uint32_t v) {
+        put16(p, (uint16_t)v);
+        put16(p + 2, (uint16_t)(v >> 16));
+    }
+
+    TelemetrySample samples[TELEMETRY_MAX_SAMPLES];
+    size_t count = 0;
+    uint32_t lastSend = 0;
+    uint32_t droppedFrames = 0;
+    uint32_t droppedSamples = 0;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Non-blocking audio/LED pattern sequencer.
+// A pattern is a table of steps; each step sets the buzzer and LED and then
+// holds for its duration. The sequencer only decides *when* each step is due,
+// the caller applies it to the hardware. Step times are measured from the
+// scheduled time of the previous step, not from when it was polled, so a late
+// poll never stretches the rest of the pattern.
+
+struct ToneStep {
+    uint16_t frequency; // Buzzer frequency in Hz, 0 keeps the current frequency
+    uint8_t duty;       // Buzzer PWM duty, 0 = silent
+    bool led;           // LED state for this step
+    uint16_t duration;  // Hold time in ms before the next step
+};
+
+struct TonePattern {
+    const ToneStep* steps;
+    uint8_t count;
+};
+
+#define TONE_PATTERN(steps) TonePattern{ steps, (uint8_t)(sizeof(steps) / sizeof(steps[0])) }
+
+class ToneSequencer {
+public:
+    // Start a pattern; the first step is due immediately. Replaces any pattern in progress.
+    void start(const TonePattern& pattern, uint32_t now) {
+        current = pattern;
+        nextStep = 0;
+        nextTime = now;
+        running = pattern.count > 0;
+    }
+
+    void stop() {
+        running = false;
+    }
+
+    // Returns the next step to apply if it is due, nullptr otherwise.
+    // Call repeatedly until it returns nullptr to catch up on overdue steps.
+    const ToneStep* poll(uint32_t now) {
+        if (!running) return nullptr;
+        if ((int32_t)(now - nextTime) < 0) return nullptr;
+
+        if (nextStep >= current.count) {
+            // Final step's hold time has elapsed
+            running = false;
+            return nullptr;
+        }
+        const ToneStep* step = &current.steps[nextStep++];
+        nextTime += step->duration;
+        return step;
+    }
+
+    // True while a pattern (including its final hold time) is playing
+    bool active() const { return running; }
+
+    // Scheduled time of the next edge, valid while active()
+    uint32_t nextEdge() const { return nextTime; }
+
+private:
+    TonePattern current = { nullptr, 0 };
+    uint8_t nextStep = 0;
+    uint32_t nextTime = 0;
+    bool running = false;
+};
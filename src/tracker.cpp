@@ -0,0 +1,956 @@
+#include "tracker.h"
+#include <atomic>
+#include "target_match.h"
+#include "metrics.h"
+#include "log.h"
+
+// Persistent settings
+bool buzzerEnabled = true;
+bool ledEnabled = true;
+uint8_t rssiFilterType = RSSI_FILTER_EMA;
+uint8_t scanResponseMode = SCAN_RESPONSE_OFF;
+bool acceptListEnabled = true;
+uint8_t acceptListSize = 0;
+bool proximityCue = true;
+bool trendCue = true;
+uint8_t trendThreshold = TREND_DEFAULT_THRESHOLD;
+
+TargetTable targets;
+SpscRing<DetectionRecord, DETECTION_RING_SIZE> detectionRing;
+SpscRing<UxCommand, UX_RING_SIZE> uxRing;
+SpscRing<SessionEvent, SESSION_RING_SIZE> sessionRing;
+std::atomic<bool> sessionRecording{false};
+uint32_t bootFirstScanMs = 0;
+uint32_t bootFirstAcquiredMs = 0;
+SpscRing<SurveySample, SURVEY_RING_SIZE> surveyRing;
+SurveySketch<SURVEY_DEVICES, SURVEY_BY_COUNT> surveyDevices;
+SurveySketch<SURVEY_STRONGEST, SURVEY_BY_RSSI> surveyStrongest;
+SurveySketch<SURVEY_VENDORS, SURVEY_BY_COUNT> surveyVendors;
+std::atomic<bool> surveyActive{false};
+uint32_t reportedRingOverflows = 0;
+uint32_t reportedUxOverflows = 0;
+bool sessionFirstDetection = true; // Only beep once per hunting session
+DetectionHook detectionHook = nullptr;
+WakeHook detectionWake = nullptr;
+WakeHook uxWake = nullptr;
+
+// Proximity beep handoff: the detection task queues an interval when it
+// changes, the UX task applies the latest one once no pattern is playing
+uint32_t queuedInterval = BEEP_SILENT;  // Detection task: last interval queued
+uint32_t pendingInterval = BEEP_SILENT; // UX task: interval to apply
+uint32_t pendingDetectionUs = 0;        // UX task: reception time behind pendingInterval
+
+// RSSI->interval lookup, default table built at compile time
+BeepTable customBeepTable;
+const BeepTable* activeBeepTable = &DEFAULT_BEEP_TABLE;
+
+// Audio/LED pattern playback (startup, ready, target acquired)
+ToneSequencer toneSequencer;
+
+// Proximity beep edges, timed by the HAL beep timer instead of loop() polling
+BeepScheduler beepScheduler;
+uint32_t proximityFrequency = PROXIMITY_FREQ; // Pitch for proximity beeps, set by the trend cue
+bool proximityToneSet = false;          // Buzzer already at proximityFrequency
+
+// Warmer/colder: slope of the nearest target's filtered RSSI (detection task),
+// applied as the proximity beep pitch (UX task)
+TrendEstimator trend;
+uint16_t trendTarget = 0xFFFF;          // Target the estimator follows, 0xFFFF for none
+uint64_t trendAddress = 0;
+uint8_t queuedTrend = TREND_STEADY;     // Detection task: last trend queued
+uint8_t appliedTrend = TREND_STEADY;    // UX task
+
+// Scan duty follows the tracking state
+ScanScheduler scanScheduler;
+
+// Targets that rotate their address, matched by identity resolving key
+IrkResolver irkResolver;
+
+// Targets recognised by a fixed payload field
+SignatureMatcher signatures;
+
+// Direction-finding sweep: requested from any task, run on the detection task
+SweepEstimator sweepEstimator;
+std::atomic<bool> sweepRequested{false};
+std::atomic<bool> sweepActive{false};
+uint16_t sweepTarget = 0;
+uint64_t sweepAddress = 0;
+uint32_t sweepStartTime = 0;
+SweepHook sweepHook = nullptr;
+
+int calculateBeepInterval(int rssi) {
+    // REAL-TIME foxhunting intervals from the precomputed curve table
+    return activeBeepTable->lookup(rssi);
+}
+
+bool trackerSetBeepCurve(const char* text) {
+    CurvePoint points[BEEP_CURVE_MAX_POINTS];
+    size_t count = parseBeepCurve(text, points);
+    if (count > 0) {
+        customBeepTable = buildBeepTable(points, count);
+        activeBeepTable = &customBeepTable;
+        return true;
+    }
+    if (*text) {
+        LOG_WARN("Invalid beep curve, using default: %s", text);
+    }
+    activeBeepTable = &DEFAULT_BEEP_TABLE;
+    return false;
+}
+
+// LED control (the HAL handles the board's LED polarity)
+void ledOn() {
+    if (ledEnabled) {
+        halLed(true);
+    }
+}
+
+void ledOff() {
+    if (ledEnabled) {
+        halLed(false);
+    }
+}
+
+// Drive buzzer and LED for a proximity beep edge
+void beepOutput(bool on) {
+    if (buzzerEnabled) {
+        uint32_t frequency = 0;
+        if (on && !proximityToneSet) {
+            frequency = proximityFrequency;
+            proximityToneSet = true;
+        }
+        halBuzzer(frequency, on ? BUZZER_DUTY : 0);
+    }
+    if (on) {
+        ledOn();
+    } else {
+        ledOff();
+    }
+}
+
+// Arm the one-shot timer for the scheduler's next edge (beep lock held)
+void armBeepTimer(uint64_t now) {
+    halBeepTimerStop();
+    uint64_t next = beepScheduler.nextEdge();
+    if (next) {
+        halBeepTimerArm(next > now ? next - now : 1);
+    }
+}
+
+void trackerBeepEdge() {
+    halBeepLock();
+    uint64_t now = halMicros();
+    uint64_t next = beepScheduler.nextEdge();
+    if (next != 0 && now < next) {
+        // Edge was moved by a retarget while this callback was pending
+        armBeepTimer(now);
+    } else if (next != 0) {
+        beepScheduler.edge(now);
+        beepOutput(beepScheduler.outputOn());
+        armBeepTimer(now);
+    }
+    halBeepUnlock();
+}
+
+// Retarget the proximity beep (BEEP_SILENT, BEEP_SOLID or an interval in us)
+void setBeepInterval(uint32_t intervalUs) {
+    if (intervalUs == beepScheduler.currentInterval()) return; // Only the UX task retargets
+
+    halBeepLock();
+    uint64_t now = halMicros();
+    bool wasOn = beepScheduler.outputOn();
+    uint64_t oldNext = beepScheduler.nextEdge();
+    beepScheduler.retarget(intervalUs, now);
+    if (beepScheduler.outputOn() != wasOn) {
+        beepOutput(beepScheduler.outputOn());
+    }
+    if (beepScheduler.nextEdge() != oldNext) {
+        armBeepTimer(now);
+    }
+    halBeepUnlock();
+
+    if (intervalUs == BEEP_SOLID) {
+        LOG_DEBUG("Solid beep mode");
+    }
+}
+
+void printBeepJitter() {
+    halBeepLock();
+    uint32_t counts[BEEP_JITTER_BUCKETS];
+    for (int i = 0; i < BEEP_JITTER_BUCKETS; i++) {
+        counts[i] = beepScheduler.jitterCount(i);
+    }
+    uint32_t worst = beepScheduler.maxJitter();
+    halBeepUnlock();
+
+    LOG_INFO("Beep edge jitter (us): <%u:%u <%u:%u <%u:%u <%u:%u <%u:%u <%u:%u <%u:%u >=%u:%u max:%u",
+           (unsigned)BEEP_JITTER_LIMITS[0], (unsigned)counts[0],
+           (unsigned)BEEP_JITTER_LIMITS[1], (unsigned)counts[1],
+           (unsigned)BEEP_JITTER_LIMITS[2], (unsigned)counts[2],
+           (unsigned)BEEP_JITTER_LIMITS[3], (unsigned)counts[3],
+           (unsigned)BEEP_JITTER_LIMITS[4], (unsigned)counts[4],
+           (unsigned)BEEP_JITTER_LIMITS[5], (unsigned)counts[5],
+           (unsigned)BEEP_JITTER_LIMITS[6], (unsigned)counts[6],
+           (unsigned)BEEP_JITTER_LIMITS[6], (unsigned)counts[7],
+           (unsigned)worst);
+}
+
+void printScanSummary() {
+    LOG_INFO("Scan: %s (%s), %u adverts/s, target %u adverts/s, est. %.1f mA now, %.1f mA average",
+           scanLevelName(scanScheduler.level()), scanScheduler.policy().active ? "active" : "passive",
+           (unsigned)scanScheduler.advertsPerSecond(),
+           (unsigned)scanScheduler.targetAdvertsPerSecond(),
+           scanScheduler.estimatedCurrent(scanScheduler.level()), scanScheduler.averageCurrent());
+}
+
+// Restart the scan with the scheduler's current policy
+void applyScanPolicy() {
+    ScanPolicy policy = scanScheduler.policy();
+    HalScanParams params;
+    params.intervalMs = policy.intervalMs;
+    params.windowMs = policy.windowMs;
+    params.active = policy.active;
+    halScanStart(params, trackerOnAdvert);
+}
+
+// Change the proximity beep pitch; a beep already sounding changes at once
+void setProximityFrequency(uint32_t frequency) {
+    halBeepLock();
+    proximityFrequency = frequency;
+    if (buzzerEnabled && beepScheduler.outputOn() && !toneSequencer.active()) {
+        halBuzzer(frequency, BUZZER_DUTY);
+        proximityToneSet = true;
+    } else {
+        proximityToneSet = false;
+    }
+    halBeepUnlock();
+}
+
+uint8_t trackerTrend() {
+    return appliedTrend;
+}
+
+// Audio/LED patterns
+// Startup test beep at the 1kHz frequency set up by halInit()
+const ToneStep STARTUP_STEPS[] = {
+    { 0,    BUZZER_DUTY, true,  100 },
+    { 0,    0,           false, 0 },
+};
+
+// Ready signal - 2 fast ascending beeps with close melodic notes, then reset
+// to the 1kHz proximity frequency and hold off to avoid interfering with proximity beeps
+const ToneStep READY_STEPS[] = {
+    { 1900, BUZZER_DUTY, true,  150 },
+    { 0,    0,           false, 50 },
+    { 2200, BUZZER_DUTY, true,  150 },
+    { 1000, 0,           false, 500 },
+};
+
+// Target acquired - three beeps at the same 1kHz tone as proximity beeps
+const ToneStep ACQUIRED_STEPS[] = {
+    { 1000, BUZZER_DUTY, true,  100 },
+    { 0,    0,           false, 50 },
+    { 0,    BUZZER_DUTY, true,  100 },
+    { 0,    0,           false, 50 },
+    { 0,    BUZZER_DUTY, true,  100 },
+    { 0,    0,           false, 550 },
+};
+
+// Sweep started - quick rising chirp, start turning the antenna
+const ToneStep SWEEP_START_STEPS[] = {
+    { 1500, BUZZER_DUTY, true,  60 },
+    { 0,    0,           false, 40 },
+    { 2000, BUZZER_DUTY, true,  60 },
+    { 0,    0,           false, 40 },
+    { 2500, BUZZER_DUTY, true,  60 },
+    { 1000, 0,           false, 300 },
+};
+
+// Sweep gave no bearing (or could not start) - one long low buzz
+const ToneStep NO_BEARING_STEPS[] = {
+    { 400,  BUZZER_DUTY, true,  600 },
+    { 1000, 0,           false, 300 },
+};
+
+const TonePattern STARTUP_PATTERN = TONE_PATTERN(STARTUP_STEPS);
+const TonePattern READY_PATTERN = TONE_PATTERN(READY_STEPS);
+const TonePattern ACQUIRED_PATTERN = TONE_PATTERN(ACQUIRED_STEPS);
+const TonePattern SWEEP_START_PATTERN = TONE_PATTERN(SWEEP_START_STEPS);
+const TonePattern NO_BEARING_PATTERN = TONE_PATTERN(NO_BEARING_STEPS);
+
+// Bearing as a clock position: a high two-note preamble, then one beep per
+// hour (12 = straight ahead of where the sweep started, 3 = 90 degrees right).
+// Built per sweep; the UX task is the only writer.
+#define BEARING_MAX_STEPS (4 + 2 * 12)
+ToneStep bearingSteps[BEARING_MAX_STEPS];
+
+void applyToneStep(const ToneStep& step) {
+    if (buzzerEnabled) {
+        halBuzzer(step.frequency, step.duty);
+    }
+    if (step.led) {
+        ledOn();
+    } else {
+        ledOff();
+    }
+}
+
+// Apply any pattern steps that are due - called on every trackerServiceUx()
+void serviceToneSequencer() {
+    const ToneStep* step;
+    while ((step = toneSequencer.poll(halMillis())) != nullptr) {
+        applyToneStep(*step);
+    }
+}
+
+// Start a pattern without blocking; proximity beeping pauses until it finishes
+void playPattern(const TonePattern& pattern) {
+    setBeepInterval(BEEP_SILENT);
+    proximityToneSet = false; // Patterns may change the buzzer frequency
+    toneSequencer.start(pattern, halMillis());
+    serviceToneSequencer();
+}
+
+// Play a sweep result as BEARING_PATTERN, or NO_BEARING_PATTERN without a fix
+void playBearing(const SweepResult& result) {
+    if (result.bearing == SWEEP_NO_BEARING) {
+        playPattern(NO_BEARING_PATTERN);
+        return;
+    }
+    unsigned hour = (result.bearing + 15) / 30 % 12;
+    if (hour == 0) hour = 12;
+
+    uint8_t count = 0;
+    bearingSteps[count++] = { 2400, BUZZER_DUTY, true,  80 };
+    bearingSteps[count++] = { 0,    0,           false, 40 };
+    bearingSteps[count++] = { 3000, BUZZER_DUTY, true,  80 };
+    bearingSteps[count++] = { 1500, 0,           false, 400 };
+    for (unsigned i = 0; i < hour; i++) {
+        bearingSteps[count++] = { 0, BUZZER_DUTY, true,  120 };
+        bearingSteps[count++] = { 0, 0,           false, 250 };
+    }
+    bearingSteps[count - 1].duration = 600;
+    playPattern(TonePattern{ bearingSteps, count });
+}
+
+// Play a pattern to completion - only for setup(), before loop() is running
+void playPatternBlocking(const TonePattern& pattern) {
+    playPattern(pattern);
+    while (toneSequencer.active()) {
+        halDelay(1);
+        serviceToneSequencer();
+    }
+}
+
+void trackerInit() {
+    size_t bytes = TargetTable::storageSize(MAX_TARGETS);
+    void* storage = halAllocLarge(bytes);
+    if (!storage) {
+        LOG_ERROR("Unable to allocate target table");
+    }
+    targets.begin(storage, MAX_TARGETS);
+
+    storage = halAllocLarge(SignatureMatcher::storageSize(SIGNATURE_MAX));
+    if (!storage) {
+        LOG_ERROR("Unable to allocate signature rules");
+    }
+    signatures.begin(storage, storage ? SIGNATURE_MAX : 0);
+}
+
+size_t trackerSetTargets(const char* text, size_t length) {
+    targets.clear();
+    irkResolver.clear();
+    signatures.clear();
+
+    size_t lineStart = 0;
+    for (size_t i = 0; i <= length; i++) {
+        if (i < length && text[i] != '\n' && text[i] != ',') continue;
+
+        size_t lineLength = i - lineStart;
+        const char* line = text + lineStart;
+        lineStart = i + 1;
+
+        // Skip blank lines
+        bool blank = true;
+        for (size_t j = 0; j < lineLength; j++) {
+            if (line[j] != ' ' && line[j] != '\t' && line[j] != '\r') {
+                blank = false;
+                break;
+            }
+        }
+        if (blank) continue;
+
+        uint8_t irk[16];
+        if (parseIRK(line, lineLength, irk)) {
+            if (irkResolver.count() >= IRK_MAX) {
+                LOG_WARN("Ignoring IRK target, max %u", (unsigned)IRK_MAX);
+                continue;
+            }
+            TargetEntry* entry = targets.insertIndexed(true);
+            if (!entry) {
+                LOG_WARN("Target table full, max %u targets", (unsigned)MAX_TARGETS);
+                break;
+            }
+            irkResolver.add(irk, (uint16_t)targets.indexOf(entry));
+            continue;
+        }
+
+        SignatureRule rule;
+        if (parseSignature(line, lineLength, rule)) {
+            if (signatures.count() >= SIGNATURE_MAX) {
+                LOG_WARN("Ignoring signature target, max %u", (unsigned)SIGNATURE_MAX);
+                continue;
+            }
+            TargetEntry* entry = targets.insertIndexed(false);
+            if (!entry) {
+                LOG_WARN("Target table full, max %u targets", (unsigned)MAX_TARGETS);
+                break;
+            }
+            signatures.add(rule, (uint16_t)targets.indexOf(entry));
+            continue;
+        }
+
+        uint64_t key, mask;
+        if (!parseMACRule(line, lineLength, key, mask)) {
+            LOG_WARN("Ignoring invalid target MAC: %.*s", (int)lineLength, line);
+            continue;
+        }
+        if (!targets.ruleMaskAvailable(mask)) {
+            LOG_WARN("Ignoring rule %.*s, max %u distinct masks", (int)lineLength, line, (unsigned)MAX_RULE_MASKS);
+            continue;
+        }
+        if (!targets.insert(key, mask)) {
+            LOG_WARN("Target table full, max %u targets", (unsigned)MAX_TARGETS);
+            break;
+        }
+    }
+    targets.compile();
+    signatures.compile();
+    // Name rules only see names sent in scan responses if we ask for them
+    scanScheduler.requireScanResponses(signatures.needsScanResponse());
+    return targets.count();
+}
+
+// Start a session event of the given type (fields not set are zero)
+SessionEvent sessionEvent(uint8_t type, uint32_t timestamp, uint16_t target = 0) {
+    SessionEvent event = {};
+    event.type = type;
+    event.timestamp = timestamp;
+    event.target = target;
+    return event;
+}
+
+// Queue an event for the recorder (detection task, or before it starts).
+// Never waits on flash: a full ring drops the event and the recorder logs the loss.
+void recordSession(const SessionEvent& event) {
+    if (sessionRecording) sessionRing.push(event);
+}
+
+// Hand a short list of exact addresses to the controller filter so other
+// adverts never reach the host. OUI/wildcard rules, IRK and signature
+// targets need every advert, so they fall back to matching on the host.
+void configureAcceptList() {
+    uint64_t addresses[ACCEPT_LIST_MAX];
+    size_t count = 0;
+    bool usable = acceptListEnabled && targets.count() > 0 && targets.count() <= ACCEPT_LIST_MAX;
+    for (size_t i = 0; usable && i < targets.count(); i++) {
+        usable = targets[i].mask == MAC_MASK_FULL;
+    }
+    if (usable) {
+        for (size_t i = 0; i < targets.count(); i++) addresses[count++] = targets[i].key;
+    }
+
+    acceptListSize = 0;
+    if (halScanSetAcceptList(addresses, count)) {
+        acceptListSize = (uint8_t)count;
+    } else {
+        LOG_WARN("Controller filter full, matching on host");
+    }
+    if (acceptListSize) {
+        LOG_INFO("Controller filter: %u targets", (unsigned)acceptListSize);
+    } else {
+        LOG_INFO("Controller filter: off, matching on host");
+    }
+}
+
+void trackerStart() {
+    // Reset session detection flag for new hunting session
+    sessionFirstDetection = true;
+    for (size_t i = 0; i < targets.count(); i++) {
+        targets[i].detected = false;
+        targets[i].filter.reset();
+    }
+
+    // Runs on the UX task before the detection task starts; drop stale commands
+    UxCommand command;
+    while (uxRing.pop(command)) {}
+    queuedInterval = BEEP_SILENT;
+    pendingInterval = BEEP_SILENT;
+    pendingDetectionUs = 0;
+    sweepRequested = false;
+    sweepActive = false;
+    trend.reset();
+    trendTarget = 0xFFFF;
+    queuedTrend = TREND_STEADY;
+    appliedTrend = TREND_STEADY;
+    setProximityFrequency(PROXIMITY_FREQ);
+
+    // The hunt takes the scanner over from a survey
+    trackerSurveyStop();
+    configureAcceptList();
+
+    // Scan duty starts at SEARCHING and adapts from there
+    scanScheduler.setResponseMode(scanResponseMode);
+    scanScheduler.begin(halMillis());
+    applyScanPolicy();
+    if (bootFirstScanMs == 0) bootFirstScanMs = halMillis();
+
+    LOG_INFO("FOXHUNT REALTIME tracking started!");
+
+    // Play startup ready signal
+    playPattern(READY_PATTERN);
+}
+
+void trackerOnAdvert(const HalAdvert& advert) {
+    METRIC_TIMER(start);
+    METRIC_COUNT(metricAdverts);
+    scanScheduler.countAdvert();
+
+    // Hash/prefix lookup on the packed address - no allocation per advert
+    TargetEntry* target = targets.match(advert.address);
+
+    // Rotating random addresses are tried against the IRK targets (cached)
+    if (!target && irkResolver.count() && advert.addressType == HAL_ADDR_RANDOM && isResolvablePrivate(advert.address)) {
+        uint16_t index = irkResolver.resolve(advert.address);
+        if (index != RPA_NO_TARGET) target = &targets[index];
+    }
+
+    // Fixed payload fields, one pass over the AD structures
+    if (!target && signatures.count()) {
+        uint16_t index = signatures.match(advert.payload, advert.payloadLength);
+        if (index != SIGNATURE_NONE) target = &targets[index];
+    }
+
+    // Hand the sample to the detection task - target state is only touched there
+    if (target) {
+        METRIC_COUNT(metricTargetHits);
+        DetectionRecord record;
+        record.address = advert.address;
+        record.timestamp = halMillis();
+        record.receivedUs = (uint32_t)halMicros();
+        record.target = (uint16_t)targets.indexOf(target);
+        record.rssi = advert.rssi;
+        record.channel = DETECTION_CHANNEL_UNKNOWN; // Not reported by NimBLE scan results
+        detectionRing.push(record);
+        if (detectionWake) detectionWake();
+    }
+    METRIC_OBSERVE(metricAdvertUs, start);
+    METRIC_BUSY(metricBleBusyUs, start);
+}
+
+// Queue a command for the UX task (detection task only). A full ring drops
+// the command; beep intervals are re-sent by the next trackerUpdate().
+bool queueUx(uint8_t type, uint32_t value, const DetectionRecord* detection, int filteredRssi = 0,
+             const SweepResult* sweep = nullptr) {
+    UxCommand command = {};
+    command.type = type;
+    command.value = value;
+    command.filteredRssi = (int8_t)filteredRssi;
+    if (detection) command.detection = *detection;
+    if (sweep) command.sweep = *sweep;
+    if (!uxRing.push(command)) return false;
+    if (uxWake) uxWake();
+    return true;
+}
+
+// Apply one detection from the ring to its target (detection task only)
+void applyDetection(const DetectionRecord& record) {
+    if (record.target >= targets.count()) return;
+    TargetEntry& target = targets[record.target];
+
+    // A sweep takes raw RSSI from the device it started on: the filter's lag
+    // would move the peak along with the antenna
+    if (sweepActive && record.target == sweepTarget && (target.oneDevice || record.address == sweepAddress)) {
+        sweepEstimator.add(record.timestamp, record.rssi);
+    }
+
+    // OUI/wildcard and signature rules follow the strongest matching device in range;
+    // an IRK target is one device whichever address it is using
+    bool sameDevice = target.address == record.address || target.oneDevice;
+    if (!sameDevice && target.detected && record.rssi < target.rssi &&
+        record.timestamp - target.lastSeen < RULE_FOLLOW_TIMEOUT) {
+        return;
+    }
+
+    // Restart filtering when following a different device or after a loss
+    if (!sameDevice || !target.detected) {
+        target.filter.reset();
+    }
+    if (sessionRecording && (target.address != record.address || !target.detected)) {
+        SessionEvent event = sessionEvent(SESSION_ADDRESS_HIGH, record.timestamp, record.target);
+        event.address = record.address;
+        recordSession(event);
+    }
+    target.address = record.address;
+    target.rssi = record.rssi;
+    target.filteredRssi = target.filter.update(rssiFilterType, record.rssi);
+    target.lastSeen = record.timestamp;
+    scanScheduler.countDetection();
+
+    if (sessionRecording) {
+        SessionEvent event = sessionEvent(SESSION_HIT, record.timestamp, record.target);
+        event.rssi = record.rssi;
+        event.filtered = (int8_t)target.filteredRssi;
+        event.address = record.address;
+        recordSession(event);
+    }
+
+    if (record.target == trendTarget && record.address == trendAddress) {
+        trend.update(record.timestamp, target.filteredRssi, trendThreshold / 10.0f);
+    }
+
+    if (detectionHook) {
+        queueUx(UX_SAMPLE, 0, &record, target.filteredRssi);
+    }
+
+    LOG_DEBUG("Target detected, RSSI: %d, filtered: %d", target.rssi, target.filteredRssi);
+
+    if (!target.detected) {
+        target.detected = true;
+        recordSession(sessionEvent(SESSION_ACQUIRED, record.timestamp, record.target));
+        char mac[18];
+        formatMACKey(target.address, mac);
+
+        // Only play three same-tone beeps on FIRST detection of hunting session
+        if (sessionFirstDetection) {
+            queueUx(UX_ACQUIRED, 0, &record);
+            sessionFirstDetection = false;
+            if (bootFirstAcquiredMs == 0) bootFirstAcquiredMs = halMillis();
+            LOG_INFO("TARGET ACQUIRED! %s", mac);
+        } else {
+            // Silent acquisition of further targets or reacquisition after loss
+            LOG_INFO("TARGET REACQUIRED! %s", mac);
+        }
+    }
+}
+
+void trackerSweepToggle() {
+    sweepRequested = true;
+}
+
+bool trackerSweeping() {
+    return sweepActive;
+}
+
+// End the sweep in progress and hand the bearing to the UX task (detection task only)
+void finishSweep(uint32_t now, bool abandoned) {
+    sweepActive = false;
+    SweepResult result = {};
+    result.bearing = SWEEP_NO_BEARING;
+    result.durationMs = now - sweepStartTime;
+    if (abandoned) {
+        LOG_WARN("Sweep: abandoned after %u s", (unsigned)(result.durationMs / 1000));
+    } else if (result.durationMs < SWEEP_MIN_MS) {
+        LOG_WARN("Sweep: too short (%u ms)", (unsigned)result.durationMs);
+    } else {
+        result = sweepEstimator.finish(now);
+        if (result.bearing != SWEEP_NO_BEARING) {
+            LOG_INFO("Sweep: bearing %u deg (lobe %u deg, contrast %d dB, %u samples, %.1f s)",
+                     (unsigned)result.bearing, (unsigned)result.lobeWidth, result.contrast,
+                     (unsigned)result.samples, result.durationMs / 1000.0f);
+        } else {
+            LOG_INFO("Sweep: no clear peak (contrast %d dB, %u samples, %.1f s)", result.contrast,
+                     (unsigned)result.samples, result.durationMs / 1000.0f);
+        }
+    }
+
+    DetectionRecord record = {};
+    record.address = sweepAddress;
+    record.timestamp = now;
+    record.target = sweepTarget;
+    queueUx(UX_BEARING, 0, &record, 0, &result);
+
+    SessionEvent event = sessionEvent(SESSION_BEARING, now, sweepTarget);
+    event.bearing = result.bearing;
+    event.filtered = result.contrast;
+    recordSession(event);
+}
+
+// Start or stop a requested sweep, abandon one that runs too long (detection task only)
+void serviceSweep(uint32_t now, const TargetEntry* nearest) {
+    bool toggle = sweepRequested.exchange(false);
+    if (sweepActive) {
+        if (toggle || now - sweepStartTime >= SWEEP_MAX_MS) finishSweep(now, !toggle);
+        return;
+    }
+    if (!toggle) return;
+
+    if (!nearest) {
+        LOG_WARN("Sweep: no target in range");
+        queueUx(UX_SWEEP_FAILED, 0, nullptr);
+        return;
+    }
+    sweepTarget = (uint16_t)targets.indexOf(nearest);
+    sweepAddress = nearest->address;
+    sweepStartTime = now;
+    sweepEstimator.begin(now);
+    sweepActive = true;
+    char mac[18];
+    formatMACKey(sweepAddress, mac);
+    LOG_INFO("Sweep: started on %s, turn one full circle clockwise", mac);
+    SessionEvent event = sessionEvent(SESSION_MODE, now, sweepTarget);
+    event.arg = SESSION_MODE_SWEEP;
+    recordSession(event);
+
+    DetectionRecord record = {};
+    record.address = sweepAddress;
+    record.timestamp = now;
+    record.target = sweepTarget;
+    queueUx(UX_SWEEP_STARTED, 0, &record);
+}
+
+// Follow the nearest target's trend and hand changes to the UX task (detection task only)
+void updateTrend(const TargetEntry* nearest, const DetectionRecord* detection) {
+    uint8_t current = TREND_STEADY;
+    if (trendCue && nearest) {
+        uint16_t index = (uint16_t)targets.indexOf(nearest);
+        if (index != trendTarget || nearest->address != trendAddress) {
+            // New nearest device: its trend starts from scratch
+            trend.reset();
+            trendTarget = index;
+            trendAddress = nearest->address;
+        }
+        current = trend.trend();
+    } else {
+        trendTarget = 0xFFFF;
+    }
+
+    if (current != queuedTrend && queueUx(UX_TREND, current, detection)) {
+        queuedTrend = current;
+        SessionEvent event = sessionEvent(SESSION_TREND, halMillis(), trendTarget == 0xFFFF ? 0 : trendTarget);
+        event.arg = current;
+        recordSession(event);
+        LOG_DEBUG("Trend: %s (%.1f dB/s)", trendName(current), trend.slope());
+    }
+}
+
+// Hand a new proximity beep interval to the UX task (detection task only)
+void requestBeepInterval(uint32_t intervalUs, const DetectionRecord* detection) {
+    if (intervalUs == queuedInterval) return;
+    if (queueUx(UX_BEEP_INTERVAL, intervalUs, detection)) {
+        queuedInterval = intervalUs;
+        SessionEvent event = sessionEvent(SESSION_BEEP, halMillis());
+        event.value = intervalUs;
+        recordSession(event);
+    }
+}
+
+void trackerUpdate() {
+    METRIC_TIMER(start);
+
+    // Drain detections from the BLE task in batches
+    DetectionRecord record;
+    DetectionRecord newest = {};
+    for (int i = 0; i < DETECTION_BATCH && detectionRing.pop(record); i++) {
+        applyDetection(record);
+        newest = record;
+    }
+
+    uint32_t currentTime = halMillis();
+    TargetEntry* nearest = nullptr;
+
+    for (size_t i = 0; i < targets.count(); i++) {
+        TargetEntry& target = targets[i];
+
+        if (!target.detected) continue;
+
+        if (currentTime - target.lastSeen >= TARGET_TIMEOUT) {
+            // Target not seen within last 5 seconds
+            target.detected = false;
+            recordSession(sessionEvent(SESSION_LOST, currentTime, (uint16_t)i));
+            char mac[18];
+            formatMACKey(target.address, mac);
+            LOG_INFO("TARGET LOST - Searching... %s", mac);
+            continue;
+        }
+
+        // Proximity feedback follows the strongest target in range
+        if (!nearest || target.filteredRssi > nearest->filteredRssi) {
+            nearest = &target;
+        }
+    }
+
+    serviceSweep(currentTime, nearest);
+    updateTrend(nearest, &newest);
+
+    // Full scan duty while a target is in range, less while searching
+    uint8_t scanLevel = scanScheduler.level();
+    if (scanScheduler.update(currentTime, nearest != nullptr, nearest ? nearest->filteredRssi : -127)) {
+        applyScanPolicy();
+    }
+    if (scanScheduler.level() != scanLevel) {
+        LOG_INFO("Scan level: %s", scanLevelName(scanScheduler.level()));
+        SessionEvent event = sessionEvent(SESSION_SCAN, currentTime);
+        event.arg = scanScheduler.level();
+        recordSession(event);
+    }
+
+    // Handle proximity beeping - the UX task holds it back while a pattern owns the buzzer
+    if (nearest) {
+        int rssi = nearest->filteredRssi;
+
+        // Ultra close - solid beep (continuous), otherwise timer-driven beeps.
+        // Without the proximity cadence the beep keeps a steady pace for the trend cue.
+        if (!proximityCue) {
+            requestBeepInterval(FIXED_BEEP_INTERVAL * 1000, &newest);
+        } else {
+            requestBeepInterval(rssi >= SOLID_BEEP_RSSI ? BEEP_SOLID : (uint32_t)calculateBeepInterval(rssi) * 1000,
+                                &newest);
+        }
+
+        // Print RSSI for visual fox hunting feedback (reduced frequency for real-time performance)
+        static uint32_t lastRSSIPrint = 0;
+        uint32_t printInterval = 2000; // Fixed 2-second intervals - less serial spam
+
+        if (currentTime - lastRSSIPrint >= printInterval) {
+            LOG_INFO("RSSI: %d dBm", rssi);
+            lastRSSIPrint = currentTime;
+        }
+    } else {
+        // All targets lost - INSTANT LED OFF for maximum reactivity
+        requestBeepInterval(BEEP_SILENT, nullptr);
+    }
+
+    // Periodic beep timing report
+    static uint32_t lastJitterPrint = 0;
+    if (currentTime - lastJitterPrint >= 30000) {
+        printBeepJitter();
+        printScanSummary();
+        lastJitterPrint = currentTime;
+    }
+
+    // Report samples dropped because the detection task fell behind the BLE task
+    if (detectionRing.overflows() != reportedRingOverflows) {
+        reportedRingOverflows = detectionRing.overflows();
+        LOG_WARN("Detection ring overflow, dropped %u samples (high water %u/%u)",
+               (unsigned)reportedRingOverflows, (unsigned)detectionRing.highWater(),
+               (unsigned)detectionRing.capacity());
+    }
+    if (uxRing.overflows() != reportedUxOverflows) {
+        reportedUxOverflows = uxRing.overflows();
+        LOG_WARN("UX ring overflow, dropped %u commands (high water %u/%u)",
+               (unsigned)reportedUxOverflows, (unsigned)uxRing.highWater(), (unsigned)uxRing.capacity());
+    }
+    METRIC_BUSY(metricDetectBusyUs, start);
+}
+
+// Time from advert reception to the buzzer/LED reacting to it
+void observeBeepLatency(uint32_t receivedUs) {
+    if (receivedUs) {
+        METRIC_OBSERVE_US(metricDetectToBeepUs, (uint32_t)halMicros() - receivedUs);
+    }
+}
+
+void trackerServiceUx() {
+    METRIC_TIMER(start);
+
+    UxCommand command;
+    while (uxRing.pop(command)) {
+        switch (command.type) {
+            case UX_BEEP_INTERVAL:
+                pendingInterval = command.value;
+                pendingDetectionUs = command.detection.receivedUs;
+                break;
+            case UX_ACQUIRED:
+                playPattern(ACQUIRED_PATTERN);
+                observeBeepLatency(command.detection.receivedUs);
+                break;
+            case UX_SAMPLE:
+                if (detectionHook) detectionHook(command.detection, command.filteredRssi);
+                break;
+            case UX_SWEEP_STARTED:
+                playPattern(SWEEP_START_PATTERN);
+                break;
+            case UX_SWEEP_FAILED:
+                playPattern(NO_BEARING_PATTERN);
+                break;
+            case UX_BEARING:
+                playBearing(command.sweep);
+                if (sweepHook) sweepHook(command.detection.target, command.sweep);
+                break;
+            case UX_TREND:
+                appliedTrend = (uint8_t)command.value;
+                setProximityFrequency(appliedTrend == TREND_WARMER ? WARMER_FREQ :
+                                      appliedTrend == TREND_COLDER ? COLDER_FREQ : PROXIMITY_FREQ);
+                break;
+        }
+    }
+
+    // Advance any audio/LED pattern in progress, then resume proximity beeping.
+    // A pattern holds the interval change back; its detection stays pending so
+    // the latency is recorded when the beep finally reacts.
+    serviceToneSequencer();
+    if (!toneSequencer.active()) {
+        if (pendingInterval != beepScheduler.currentInterval()) {
+            setBeepInterval(pendingInterval);
+            observeBeepLatency(pendingDetectionUs);
+        }
+        pendingDetectionUs = 0;
+    }
+    METRIC_BUSY(metricUxBusyUs, start);
+}
+
+void trackerSurveyOnAdvert(const HalAdvert& advert) {
+    METRIC_COUNT(metricAdverts);
+    SurveySample sample;
+    sample.address = advert.address;
+    sample.timestamp = halMillis();
+    sample.rssi = advert.rssi;
+    sample.addressType = advert.addressType;
+    surveyRing.push(sample);
+}
+
+void trackerSurveyStart() {
+    SurveySample sample;
+    while (surveyRing.pop(sample)) {}
+    surveyDevices.reset();
+    surveyStrongest.reset();
+    surveyVendors.reset();
+    surveyActive = true;
+
+    // Every device in range: no controller filter, passive, half duty
+    halScanSetAcceptList(nullptr, 0);
+    HalScanParams params;
+    params.intervalMs = SURVEY_SCAN_INTERVAL_MS;
+    params.windowMs = SURVEY_SCAN_WINDOW_MS;
+    params.active = false;
+    halScanStart(params, trackerSurveyOnAdvert);
+    LOG_INFO("Survey started");
+}
+
+void trackerSurveyStop() {
+    if (!surveyActive) return;
+    surveyActive = false;
+    halScanStop();
+    LOG_INFO("Survey stopped: %u adverts, %u devices kept", (unsigned)surveyDevices.adverts(),
+             (unsigned)surveyDevices.count());
+}
+
+bool trackerSurveying() {
+    return surveyActive;
+}
+
+size_t trackerSurveyUpdate() {
+    SurveySample sample;
+    size_t count = 0;
+    while (surveyRing.pop(sample)) {
+        surveyDevices.offer(sample.address, sample.rssi, sample.addressType, sample.timestamp);
+        surveyStrongest.offer(sample.address, sample.rssi, sample.addressType, sample.timestamp);
+        // Only public addresses carry a vendor OUI; random ones are made up
+        if (sample.addressType == HAL_ADDR_PUBLIC) {
+            surveyVendors.offer(sample.address >> 24, sample.rssi, sample.addressType, sample.timestamp);
+        }
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "hal.h"
+#include "target_table.h"
+#include "detection_ring.h"
+#include "rssi_filter.h"
+#include "tone_sequencer.h"
+#include "beep_scheduler.h"
+#include "beep_curve.h"
+#include "scan_scheduler.h"
+#include "irk_resolver.h"
+#include "signature_match.h"
+#include "sweep_estimator.h"
+#include "rssi_trend.h"
+#include "session_log.h"
+#include "survey.h"
+
+// Foxhunt tracking core: target matching, RSSI filtering, proximity beeping
+// and audio/LED patterns. Talks to hardware only through hal.h, so the same
+// code runs on the device and in the native simulator.
+//
+// Work is split across three contexts connected by SPSC rings:
+//   BLE host task   trackerOnAdvert()  -> detectionRing
+//   detection task  trackerUpdate()    -> uxRing (beep interval, patterns, samples)
+//   UX task         trackerServiceUx() drives the buzzer/LED and detectionHook
+// With sessionRecording set, the detection task also queues SessionEvents on
+// sessionRing for the recorder, which writes them to flash from its own task.
+// On the device the detection task is pinned next to the NimBLE host and the
+// UX side is loop(); the simulator calls both from one thread.
+// Outside a hunt, the survey scans every device in range: the BLE host task
+// queues adverts on surveyRing and trackerSurveyUpdate() counts them.
+
+// Tracking configuration
+#define TARGET_TIMEOUT 5000           // Target lost after 5 seconds without adverts
+#define RULE_FOLLOW_TIMEOUT 1000      // OUI/wildcard rules stick to one device this long
+#define DETECTION_RING_SIZE 256       // Adverts buffered between the BLE task and the detection task
+#define DETECTION_BATCH 64            // Max detections applied per trackerUpdate()
+#define UX_RING_SIZE 128              // Commands buffered between the detection and UX tasks
+#define SESSION_RING_SIZE 256         // Events buffered for the session recorder
+#define SOLID_BEEP_RSSI -25           // Continuous tone at or above this filtered RSSI
+#define ACCEPT_LIST_MAX 6             // Full-address targets for the controller filter (2 entries each)
+#define SWEEP_MAX_MS 60000            // A sweep not stopped by then is abandoned
+#define SWEEP_MIN_MS 2000             // Shorter sweeps give no bearing
+#define SURVEY_RING_SIZE 256          // Adverts buffered between the BLE task and trackerSurveyUpdate()
+#define SURVEY_DEVICES 128            // Busiest addresses kept by the survey (surveybench)
+#define SURVEY_STRONGEST 16           // Strongest addresses kept by the survey
+#define SURVEY_VENDORS 32             // Busiest OUIs (public addresses) kept by the survey
+#define SURVEY_SCAN_INTERVAL_MS 100   // Half duty: the radio is shared with the config AP
+#define SURVEY_SCAN_WINDOW_MS 50
+
+// Buzzer configuration
+#define BUZZER_DUTY 127
+#define PROXIMITY_FREQ 1000
+#define WARMER_FREQ 1400              // Proximity beep pitch while closing in (trend cue)
+#define COLDER_FREQ 700               // ... and while moving away
+#define TREND_DEFAULT_THRESHOLD 10    // Trend cue threshold in 0.1 dB/s (trendbench)
+#define FIXED_BEEP_INTERVAL 400       // Beep interval (ms) with the proximity cadence off
+
+// Detection task -> UX task
+enum UxCommandType {
+    UX_BEEP_INTERVAL,    // Proximity beep interval (us) in value, held back while a pattern plays
+    UX_ACQUIRED,         // First detection of the session: play ACQUIRED_PATTERN
+    UX_SAMPLE,           // Detection for detectionHook
+    UX_SWEEP_STARTED,    // Sweep under way on detection.target: play SWEEP_START_PATTERN
+    UX_SWEEP_FAILED,     // Sweep could not start (no target in range)
+    UX_BEARING,          // Sweep finished on detection.target: play the bearing, call sweepHook
+    UX_TREND             // Trend of the nearest target changed: Trend in value
+};
+
+struct UxCommand {
+    uint8_t type;              // UxCommandType
+    int8_t filteredRssi;       // UX_SAMPLE
+    uint32_t value;            // UX_BEEP_INTERVAL, UX_TREND
+    DetectionRecord detection; // Detection behind the command; receivedUs 0 if none
+    SweepResult sweep;         // UX_BEARING
+};
+
+// Persistent settings, loaded and saved by the application
+extern bool buzzerEnabled;
+extern bool ledEnabled;
+extern uint8_t rssiFilterType;
+extern uint8_t scanResponseMode;      // ScanResponseMode, applied by trackerStart()
+extern bool acceptListEnabled;        // Let the controller filter full-address targets
+extern uint8_t acceptListSize;        // Addresses in the controller filter, 0 = host matching
+extern bool proximityCue;             // Beep cadence follows RSSI, otherwise FIXED_BEEP_INTERVAL
+extern bool trendCue;                 // Beep pitch follows the RSSI trend (warmer/colder)
+extern uint8_t trendThreshold;        // Slope for warmer/colder in 0.1 dB/s
+
+extern TargetTable targets;          // Parsed targets with per-target detection state
+extern SpscRing<DetectionRecord, DETECTION_RING_SIZE> detectionRing; // BLE task -> detection task
+extern SpscRing<UxCommand, UX_RING_SIZE> uxRing;                     // Detection task -> UX task
+extern SpscRing<SessionEvent, SESSION_RING_SIZE> sessionRing;        // Detection task -> recorder
+extern std::atomic<bool> sessionRecording; // Queue session events; set by recorderStart(), after trackerStart()
+extern uint32_t bootFirstScanMs;     // millis() of the first trackerStart(), 0 until then
+extern uint32_t bootFirstAcquiredMs; // millis() of the first target acquired, 0 until then
+extern SpscRing<SurveySample, SURVEY_RING_SIZE> surveyRing;          // BLE task -> survey
+extern SurveySketch<SURVEY_DEVICES, SURVEY_BY_COUNT> surveyDevices;
+extern SurveySketch<SURVEY_STRONGEST, SURVEY_BY_RSSI> surveyStrongest;
+extern SurveySketch<SURVEY_VENDORS, SURVEY_BY_COUNT> surveyVendors;
+extern ToneSequencer toneSequencer;
+extern BeepScheduler beepScheduler;
+extern ScanScheduler scanScheduler;
+extern IrkResolver irkResolver;      // IRK targets, resolved on the BLE task
+extern SignatureMatcher signatures;  // MFG:/UUID:/NAME: payload targets
+
+extern const TonePattern STARTUP_PATTERN;
+extern const TonePattern READY_PATTERN;
+extern const TonePattern ACQUIRED_PATTERN;
+extern const TonePattern SWEEP_START_PATTERN;
+extern const TonePattern NO_BEARING_PATTERN;
+
+// Called on the UX task for every detection applied to a target, e.g. to feed telemetry
+typedef void (*DetectionHook)(const DetectionRecord& record, int filteredRssi);
+extern DetectionHook detectionHook;
+
+// Called on the UX task when a sweep ends, e.g. to send the bearing to /live
+typedef void (*SweepHook)(uint16_t target, const SweepResult& result);
+extern SweepHook sweepHook;
+
+// Wake-ups between the tasks; nullptr when everything runs from one thread
+typedef void (*WakeHook)();
+extern WakeHook detectionWake;       // BLE task queued a detection
+extern WakeHook uxWake;              // Detection task queued a UX command
+
+// Allocate target table storage; call once before trackerSetTargets()
+void trackerInit();
+
+// Parse a target list (one address, rule, "IRK:<hex>" or payload signature per
+// line or comma) into the table.
+// Returns the number of targets.
+size_t trackerSetTargets(const char* text, size_t length);
+
+// Install a custom "rssi:ms,..." beep curve; empty or invalid selects the default.
+// Returns true if the custom curve is active.
+bool trackerSetBeepCurve(const char* text);
+
+// Begin a new hunting session: reset target state, start scanning, play READY
+void trackerStart();
+
+// Advert handler for halScanStart(); runs on the BLE host task
+void trackerOnAdvert(const HalAdvert& advert);
+
+// Drain detections, expire lost targets and pick the proximity beep (detection task)
+void trackerUpdate();
+
+// Apply queued beep/pattern commands and advance patterns (UX task)
+void trackerServiceUx();
+
+// Start a direction-finding sweep on the nearest target, or end the one in
+// progress. Any task may call it; the detection task acts on it. The operator
+// turns a directional antenna one full circle clockwise between the two calls
+// and the bearing of the strongest signal, clockwise from the heading the
+// sweep started at, is played as a clock position (12 = ahead, 3 = right).
+void trackerSweepToggle();
+bool trackerSweeping();
+
+// Environment survey, outside a hunt: scan every device in range into the
+// survey sketches, which start empty. trackerStart() ends a survey.
+void trackerSurveyStart();
+void trackerSurveyStop();
+bool trackerSurveying();
+
+// Count queued survey adverts; returns how many (call often while surveying)
+size_t trackerSurveyUpdate();
+
+// Advert handler for halScanStart() while surveying; runs on the BLE host task
+void trackerSurveyOnAdvert(const HalAdvert& advert);
+
+// Trend cue currently applied to the proximity beep (UX task)
+uint8_t trackerTrend();
+
+// Beep timer callback body
+void trackerBeepEdge();
+
+int calculateBeepInterval(int rssi);
+void setBeepInterval(uint32_t intervalUs);
+void printBeepJitter();
+void printScanSummary();
+
+// Audio/LED patterns
+void serviceToneSequencer();
+void playPattern(const TonePattern& pattern);
+void playPatternBlocking(const TonePattern& pattern);
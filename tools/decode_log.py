@@ -0,0 +1,74 @@
+# Decode a binary-framed serial log (Log format: Binary) back into text.
+# Usage: python3 tools/decode_log.py capture.bin
+#        python3 tools/decode_log.py /dev/ttyACM0     (reads until interrupted)
+# Frame layout is documented in src/log.h. Bytes outside valid frames, such
+# as boot messages or a Serial metrics dump, are skipped and counted.
+import sys
+
+LEVELS = ["ERROR", "WARN", "INFO", "DEBUG"]
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def decode(buffer, out):
+    """Print every complete frame in buffer; returns (unconsumed tail, skipped bytes)."""
+    skipped = 0
+    pos = 0
+    while True:
+        start = buffer.find(b"\xa5\x5a", pos)
+        if start < 0:
+            keep = len(buffer) - 1 if buffer.endswith(b"\xa5") else len(buffer)
+            return buffer[keep:], skipped + keep - pos
+        skipped += start - pos
+        if start + 3 > len(buffer):
+            return buffer[start:], skipped
+        length = buffer[start + 2]
+        end = start + 3 + length + 1
+        if end > len(buffer):
+            return buffer[start:], skipped
+        body = buffer[start + 3:end - 1]
+        if length < 7 or crc8(buffer[start + 2:end - 1]) != buffer[end - 1]:
+            # Not a frame after all; resync one byte on
+            skipped += 1
+            pos = start + 1
+            continue
+        level = body[0]
+        sequence = body[1] | body[2] << 8
+        millis = int.from_bytes(body[3:7], "little")
+        text = body[7:].decode("utf-8", errors="replace")
+        name = LEVELS[level] if level < len(LEVELS) else str(level)
+        out.write("%10.3f %5u %-5s %s\n" % (millis / 1000.0, sequence, name, text))
+        pos = end
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.stderr.write("usage: decode_log.py <capture file or serial device>\n")
+        return 2
+    skipped = 0
+    pending = b""
+    with open(sys.argv[1], "rb", buffering=0) as source:
+        try:
+            while True:
+                chunk = source.read(4096)
+                if not chunk:
+                    break
+                pending, count = decode(pending + chunk, sys.stdout)
+                skipped += count
+                sys.stdout.flush()
+        except KeyboardInterrupt:
+            pass
+    if skipped:
+        sys.stderr.write("skipped %u bytes outside frames\n" % skipped)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,178 @@
+# Decode a recorded hunt (Session Recordings on the config page) into text or CSV.
+# Usage: python3 tools/decode_session.py 00000012.fxs
+#        python3 tools/decode_session.py --csv 00000012.fxs > hunt.csv
+# File layout is documented in src/session_log.h. Each chunk carries its own
+# CRC, so a chunk torn by a power cut is reported and skipped, and decoding
+# resumes at the next chunk sync byte.
+import struct
+import sys
+
+SYNC = 0xF5
+FILE_HEADER_SIZE = 16
+CHUNK_HEADER_SIZE = 8
+RECORD_SIZE = 8
+MAX_RECORDS = 254
+
+MODES = ["tracking", "sweep", "stopped"]
+TRENDS = ["steady", "warmer", "colder"]
+SCAN_LEVELS = ["idle", "searching", "reacquire", "acquired", "follow", "close-in"]
+BEEP_SILENT = 0
+BEEP_SOLID = 0xFFFFFFFF
+
+
+def crc32(data):
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0xEDB88320 if crc & 1 else 0)
+    return crc ^ 0xFFFFFFFF
+
+
+def name(names, index):
+    return names[index] if index < len(names) else str(index)
+
+
+def mac(octets):
+    return ":".join("%02X" % octet for octet in octets)
+
+
+class Decoder:
+    def __init__(self):
+        self.addresses = {}     # target -> first five octets of the device followed
+        self.pending = {}       # target -> ADDRESS_HIGH octets awaiting their ADDRESS_LOW
+
+    def record(self, body):
+        """Return (event, target, fields) for one record, fields as a dict."""
+        kind = body[0]
+        payload = body[3:]
+        target = payload[0] | payload[1] << 8
+        if kind == 1:
+            return "time", "", {"millis": struct.unpack_from("<I", payload)[0]}
+        if kind == 2:
+            return "mode", "", {"mode": name(MODES, payload[0])}
+        if kind == 3:
+            rssi, filtered = struct.unpack_from("<bb", payload, 2)
+            fields = {"rssi": rssi, "filtered": filtered}
+            high = self.addresses.get(target)
+            fields["address"] = mac(high + (payload[4],)) if high else "..:%02X" % payload[4]
+            return "hit", target, fields
+        if kind == 4:
+            self.pending[target] = tuple(payload[2:5])
+            return None
+        if kind == 5:
+            high = self.pending.pop(target, (0, 0, 0))
+            self.addresses[target] = high + tuple(payload[2:4])
+            return "address", target, {"address": mac(high + tuple(payload[2:5]))}
+        if kind == 6:
+            return "acquired", target, {}
+        if kind == 7:
+            return "lost", target, {}
+        if kind == 8:
+            interval = struct.unpack_from("<I", payload)[0]
+            if interval == BEEP_SILENT:
+                text = "silent"
+            elif interval == BEEP_SOLID:
+                text = "solid"
+            else:
+                text = "%.1f" % (interval / 1000.0)
+            return "beep", "", {"interval_ms": text}
+        if kind == 9:
+            return "trend", "", {"trend": name(TRENDS, payload[0])}
+        if kind == 10:
+            return "scan", "", {"level": name(SCAN_LEVELS, payload[0])}
+        if kind == 11:
+            bearing = payload[2] | payload[3] << 8
+            contrast = struct.unpack_from("<b", payload, 4)[0]
+            return "bearing", target, {"bearing": "none" if bearing == 0xFFFF else bearing, "contrast": contrast}
+        if kind == 12:
+            return "dropped", "", {"events": struct.unpack_from("<I", payload)[0]}
+        return "unknown", "", {"type": kind}
+
+    def chunks(self, data, stats):
+        """Yield (time, event, target, fields) from every valid chunk in data."""
+        pos = FILE_HEADER_SIZE
+        tail = None
+        while pos < len(data):
+            if data[pos] != SYNC:
+                pos += 1
+                stats["skipped"] += 1
+                continue
+            count = data[pos + 1] if pos + 1 < len(data) else 0
+            end = pos + CHUNK_HEADER_SIZE + count * RECORD_SIZE + 4
+            if count == 0 or count > MAX_RECORDS or end > len(data):
+                if end > len(data) and count and count <= MAX_RECORDS and tail is None:
+                    tail = pos    # Runs past the end: a torn write, unless a valid chunk follows
+                pos += 1
+                stats["skipped"] += 1
+                continue
+            crc = struct.unpack_from("<I", data, end - 4)[0]
+            if crc32(data[pos:end - 4]) != crc:
+                pos += 1
+                stats["skipped"] += 1
+                continue
+            sequence, time = struct.unpack_from("<HI", data, pos + 2)
+            if stats["sequence"] is not None and sequence != (stats["sequence"] + 1) & 0xFFFF:
+                stats["gaps"] += 1
+            stats["sequence"] = sequence
+            stats["chunks"] += 1
+            tail = None
+            for i in range(count):
+                body = data[pos + CHUNK_HEADER_SIZE + i * RECORD_SIZE:][:RECORD_SIZE]
+                time += body[1] | body[2] << 8
+                if body[0] == 1:
+                    time = struct.unpack_from("<I", body, 3)[0]
+                decoded = self.record(body)
+                if decoded:
+                    yield (time,) + decoded
+            pos = end
+        if tail is not None:
+            # The chunk a power cut interrupted; not counted as corruption
+            stats["torn"] = len(data) - tail
+            stats["skipped"] -= len(data) - tail
+
+
+def main():
+    args = sys.argv[1:]
+    csv = "--csv" in args
+    args = [arg for arg in args if arg != "--csv"]
+    if len(args) != 1:
+        sys.stderr.write("usage: decode_session.py [--csv] <session file>\n")
+        return 2
+    with open(args[0], "rb") as source:
+        data = source.read()
+    if len(data) < FILE_HEADER_SIZE or data[:4] != b"FXSL":
+        sys.stderr.write("not a session recording\n")
+        return 1
+    version, record_size, session, start = struct.unpack_from("<HHII", data, 4)
+    if version != 1 or record_size != RECORD_SIZE:
+        sys.stderr.write("unsupported version %u (record size %u)\n" % (version, record_size))
+        return 1
+
+    stats = {"chunks": 0, "skipped": 0, "gaps": 0, "torn": 0, "sequence": None}
+    if csv:
+        print("millis,event,target,rssi,filtered,address,value")
+    else:
+        print("# session %u, opened at %.3f s" % (session, start / 1000.0))
+    for time, event, target, fields in Decoder().chunks(data, stats):
+        if csv:
+            value = ";".join("%s=%s" % item for item in fields.items() if item[0] not in ("rssi", "filtered", "address"))
+            print("%u,%s,%s,%s,%s,%s,%s" % (time, event, target, fields.get("rssi", ""), fields.get("filtered", ""),
+                                            fields.get("address", ""), value))
+        else:
+            text = " ".join("%s=%s" % item for item in fields.items())
+            print("%10.3f %-8s %4s %s" % (time / 1000.0, event, target, text))
+
+    sys.stderr.write("%u chunks" % stats["chunks"])
+    if stats["gaps"]:
+        sys.stderr.write(", %u sequence gaps" % stats["gaps"])
+    if stats["skipped"]:
+        sys.stderr.write(", %u bytes skipped (corrupt chunks)" % stats["skipped"])
+    if stats["torn"]:
+        sys.stderr.write(", torn tail of %u bytes dropped" % stats["torn"])
+    sys.stderr.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
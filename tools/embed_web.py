@@ -0,0 +1,63 @@
+# Gzip the static web pages in web/ into src/web_assets.h at build time.
+# Runs as a PlatformIO pre-build script, or standalone: python3 tools/embed_web.py
+import gzip
+import hashlib
+import os
+
+ASSETS = [
+    # (source file, C identifier)
+    ("index.html", "INDEX_HTML"),
+    ("live.html", "LIVE_HTML"),
+]
+
+try:
+    Import("env")  # noqa: F821 - provided by PlatformIO
+    PROJECT_DIR = env["PROJECT_DIR"]  # noqa: F821
+except NameError:
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+OUTPUT = os.path.join(PROJECT_DIR, "src", "web_assets.h")
+
+
+def render():
+    lines = [
+        "#pragma once",
+        "",
+        "// Generated by tools/embed_web.py from web/ - do not edit",
+        "",
+        "#include <stdint.h>",
+        "#include <stddef.h>",
+        "",
+    ]
+    for filename, name in ASSETS:
+        with open(os.path.join(WEB_DIR, filename), "rb") as f:
+            raw = f.read()
+        # mtime=0 keeps the output (and ETag) stable across builds
+        packed = gzip.compress(raw, 9, mtime=0)
+        etag = hashlib.sha1(packed).hexdigest()[:16]
+        print("embed_web: %s %d bytes -> %d bytes gzip" % (filename, len(raw), len(packed)))
+
+        lines.append("// %s: %d bytes, %d bytes gzipped" % (filename, len(raw), len(packed)))
+        lines.append('const char %s_ETAG[] = "\\"%s\\"";' % (name, etag))
+        lines.append("const size_t %s_GZ_LEN = %d;" % (name, len(packed)))
+        lines.append("const uint8_t %s_GZ[] PROGMEM = {" % name)
+        for i in range(0, len(packed), 16):
+            lines.append("    " + ", ".join("0x%02x" % b for b in packed[i:i + 16]) + ",")
+        lines.append("};")
+        lines.append("")
+    return "\n".join(lines)
+
+
+def main():
+    content = render()
+    # Only touch the header when it changes to avoid needless rebuilds
+    if os.path.exists(OUTPUT):
+        with open(OUTPUT) as f:
+            if f.read() == content:
+                return
+    with open(OUTPUT, "w") as f:
+        f.write(content)
+
+
+main()